@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+#include "gpio_control.h"
+
+//执行机构通道
+enum class ActuatorChannel { DOOR, BUZZER, COUNT };
+
+//执行机构命令类型
+enum class ActuatorOp {
+    PULSE,  // 激活duration_ms后自动复位；已激活时忽略（单次脉冲，不延长）
+    EXTEND, // 未激活时同PULSE；已激活时把复位时刻推迟到“现在+duration_ms”（开门期间再次确认，门保持打开）
+    CANCEL, // 立即复位并取消定时
+};
+
+/**
+ * @brief 一条执行机构命令（识别线程→执行机构线程）
+ */
+struct ActuatorCommand {
+    ActuatorOp op = ActuatorOp::PULSE;              // 命令类型
+    ActuatorChannel channel = ActuatorChannel::DOOR;// 通道
+    int duration_ms = 0;                            // 激活时长（CANCEL忽略）
+    int debounce_ms = 0;                            // 距该通道上次被触发不足该时长时忽略本命令（0表示不去抖）
+    std::chrono::steady_clock::time_point decided;  // 做出判定的时刻（统计判定→引脚翻转延迟）
+};
+
+/**
+ * @class TimerWheel
+ * @brief 单层哈希时间轮：按刻度把定时器放入槽位，每个刻度只检查一个槽
+ * @details 定时器落在 (到期刻度 % 槽数) 号槽；超过一圈的定时器留在槽中，转到对应的圈时才到期。
+ *          插入O(1)，推进一个刻度O(该槽定时器数)，与定时器总数无关
+ * @note 非线程安全，只在执行机构线程中使用
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    //一个定时器：到期时复位channel，gen与通道当前代数不同表示已被取消/推迟
+    struct Timer {
+        long long tick;  // 到期刻度
+        int channel;     // 通道
+        unsigned gen;    // 通道代数
+    };
+
+    TimerWheel(int tick_ms = ACTUATOR_TICK_MS, int slots = ACTUATOR_WHEEL_SLOTS);
+
+    //添加一个在due时刻（向上取整到刻度）到期的定时器（时间轮为空时先把已处理刻度追到当前时刻）
+    void schedule(Clock::time_point due, int channel, unsigned gen);
+    //推进到now，把到期的定时器追加到due
+    void advance(Clock::time_point now, std::vector<Timer>& due);
+    //下一个刻度的时刻（无定时器时返回Clock::time_point::max()）
+    Clock::time_point nextTick() const;
+    //未到期的定时器数
+    size_t pending() const { return pending_; }
+
+private:
+    long long tickOf(Clock::time_point t) const;// 时刻对应的刻度（向上取整）
+
+    std::chrono::milliseconds tick_;          // 刻度
+    Clock::time_point origin_;                // 刻度0的时刻
+    long long current_ = 0;                   // 已处理到的刻度
+    std::vector<std::vector<Timer>> slots_;   // 槽位（各自容量复用）
+    size_t pending_ = 0;                      // 未到期的定时器数
+};
+
+/**
+ * @class Actuator
+ * @brief 执行机构线程：继电器/蜂鸣器的定时控制，识别线程投递命令后立即返回，不再等待硬件
+ * @details 1. 命令经有界队列（ACTUATOR_QUEUE_SIZE）送入执行机构线程，队列满时丢弃新命令并计数
+ *          2. 激活通道时立即写引脚，复位时刻登记到时间轮；推迟/取消时通道代数+1，旧定时器到期后被忽略
+ *          3. 去抖：距同一通道上次触发不足debounce_ms的命令被忽略（多条未知轨迹同时出现只报警一次）
+ *          4. 统计判定→激活沿的延迟、复位沿相对计划时刻的滞后、丢弃/去抖次数
+ *          5. 停止时全部通道复位到空闲电平后才释放引脚（门不会停在打开状态）
+ * @note submit()可在任意线程调用；继电器高电平有效，蜂鸣器低电平有效
+ */
+class Actuator {
+public:
+    using Clock = std::chrono::steady_clock;
+    //引脚翻转回调（在执行机构线程中调用）：通道、是否激活、判定→翻转延迟（复位沿为相对计划时刻的滞后）
+    using EdgeCallback = std::function<void(ActuatorChannel channel, bool active, double latency_ms)>;
+
+    explicit Actuator(std::unique_ptr<GpioBackend> backend, EdgeCallback on_edge = nullptr);
+    ~Actuator() { stop(); }
+    Actuator(const Actuator&) = delete;
+    Actuator& operator=(const Actuator&) = delete;
+
+    //申请引脚（初始为空闲电平）并启动执行机构线程，引脚申请失败返回false
+    bool start();
+    //复位全部通道，停止线程，释放引脚
+    void stop();
+    //投递一条命令（不阻塞），队列满或未启动返回false
+    bool submit(const ActuatorCommand& cmd);
+    //开门DOOR_OPEN_MS（已开门则从decided起重新计时）
+    bool openDoor(Clock::time_point decided) {
+        return submit({ActuatorOp::EXTEND, ActuatorChannel::DOOR, DOOR_OPEN_MS, 0, decided});
+    }
+    //报警ALARM_BEEP_MS（ALARM_DEBOUNCE_MS内只响一次）
+    bool alarm(Clock::time_point decided) {
+        return submit({ActuatorOp::PULSE, ActuatorChannel::BUZZER, ALARM_BEEP_MS, ALARM_DEBOUNCE_MS, decided});
+    }
+
+    //GPIO后端名称
+    std::string backendName() const { return backend_->name(); }
+    //统计摘要（用于日志）
+    std::string summary() const;
+
+private:
+    struct Channel {
+        int pin = -1;            // BCM引脚
+        int active_level = 1;    // 激活电平
+        bool active = false;     // 当前是否激活
+        unsigned gen = 0;        // 代数（推迟/取消时+1，使旧定时器失效）
+        Clock::time_point release;     // 计划复位时刻
+        Clock::time_point last_trigger;// 上次被触发的时刻（去抖）
+        bool triggered = false;  // 是否触发过
+    };
+
+    void run();
+    void apply(const ActuatorCommand& cmd, Clock::time_point now);// 执行一条命令
+    //写引脚并回调；reference为延迟的起点（激活沿：判定时刻，复位沿：计划复位时刻）
+    void drive(int index, bool active, Clock::time_point reference);
+
+    std::unique_ptr<GpioBackend> backend_; // GPIO后端
+    EdgeCallback on_edge_;                 // 引脚翻转回调
+    std::array<Channel, static_cast<int>(ActuatorChannel::COUNT)> channels_;// 各通道状态（执行机构线程独占）
+    TimerWheel wheel_;                     // 复位定时（执行机构线程独占）
+
+    mutable std::mutex mtx_;               // 保护命令队列、运行标志和统计
+    std::condition_variable cond_;         // 有新命令/停止时唤醒执行机构线程
+    std::vector<ActuatorCommand> queue_;   // 待执行命令（容量预留）
+    bool running_ = false;                 // 是否运行中
+    std::thread thread_;                   // 执行机构线程
+
+    unsigned long long commands_ = 0, dropped_ = 0, debounced_ = 0;// 执行/丢弃/去抖忽略的命令数
+    unsigned long long activations_ = 0;   // 激活沿次数
+    double latency_sum_ = 0.0, latency_max_ = 0.0;// 判定→激活沿延迟累计/最大值（毫秒）
+    double release_lag_max_ = 0.0;         // 复位沿相对计划时刻的最大滞后（毫秒）
+};
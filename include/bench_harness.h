@@ -0,0 +1,64 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 一项微基准的测量结果（单位：纳秒/次操作）
+ */
+struct BenchResult {
+    std::string name;           // 用例名（分组/名称，如 queue/spsc_ring）
+    std::string params;         // 输入说明（尺寸、画廊规模等）
+    long long ops_per_batch = 0;// 每批操作数（自动标定）
+    int batches = 0;            // 计时批数
+    double median_ns = 0;       // 各批每次操作耗时的中位数
+    double p90_ns = 0;          // 90分位
+    double min_ns = 0;          // 最小值
+    double mean_ns = 0;         // 平均值
+};
+
+/**
+ * @brief 微基准运行参数
+ */
+struct BenchOptions {
+    int batches = 9;            // 计时批数（取中位数，抵消偶发的调度/频率波动）
+    double batch_ms = 50.0;     // 每批目标时长（按此标定每批操作数）
+    double warmup_ms = 50.0;    // 预热时长（填充缓存、触发惰性分配）
+    std::string filter;         // 只运行名称包含该子串的用例（空表示全部）
+};
+
+/**
+ * @class BenchSuite
+ * @brief 微基准测试框架：标定批大小、预热、多批计时取中位数，输出文本/JSON/CSV，与基线比较
+ * @details 1. 用例函数fn(n)执行n次操作；框架先倍增n直到一批耗时达到batch_ms，再预热并计时batches批
+ *          2. 结果以中位数为准（对树莓派上的调度噪声不敏感），同时给出p90/最小/平均
+ *          3. JSON由本类写出、用cv::FileStorage读回作为基线；CSV便于表格工具对比
+ *          4. compare()按用例名匹配基线，中位数变慢超过容差即计为回归
+ */
+class BenchSuite {
+public:
+    explicit BenchSuite(const BenchOptions& options) : options_(options) {}
+
+    //运行一个用例（被过滤掉时不运行）；fn(n)须执行n次被测操作
+    void run(const std::string& name, const std::string& params, const std::function<void(long long)>& fn);
+    //用例是否会运行（准备输入代价高的用例先检查，避免无用的准备工作）
+    bool selected(const std::string& name) const;
+
+    const std::vector<BenchResult>& results() const { return results_; }
+
+    //输出：人类可读表格 / JSON（含环境信息meta，键值对）/ CSV
+    void printText(std::ostream& out) const;
+    std::string toJson(const std::map<std::string, std::string>& meta) const;
+    std::string toCsv() const;
+
+    //读取JSON基线（toJson的输出）：用例名 → 中位数，失败返回false并在error中说明
+    static bool loadBaseline(const std::string& path, std::map<std::string, double>& median_ns, std::string& error);
+    //与基线比较并输出对照表，返回回归项数（变慢超过tolerance_pct%）
+    int compare(const std::map<std::string, double>& baseline, double tolerance_pct, std::ostream& out) const;
+
+private:
+    BenchOptions options_;
+    std::vector<BenchResult> results_;
+};
@@ -3,16 +3,165 @@
 //摄像头参数
 constexpr int CAMERA_WIDTH = 640; //宽
 constexpr int CAMERA_HEIGHT = 480;//长
+constexpr int CAMERA_FPS = 25;    //帧率
+constexpr int CAMERA_WARMUP_MS = 2000;//实时摄像头打开前的预热等待（回放源不等待）
+
+//MJPEG灰度解码：采集线程直接取MJPEG原始数据，只解码亮度平面供检测使用，
+//彩色仅在显示循环真正显示某帧时才解码；帧源不支持原始数据时自动退回BGR解码
+constexpr bool MJPEG_GRAY_DECODE = true;
+//灰度解码的DCT域缩放分母（1=原分辨率，2=1/2，4=1/4），缩小后解码/检测更快，但远处的小脸更难检出
+constexpr int MJPEG_SCALE_DENOM = 1;
+constexpr int MJPEG_RESERVE_BYTES = 256 * 1024;//每个帧池槽位预留的MJPEG原始数据容量
+
+//帧源（默认实时摄像头，可用命令行参数替换为录像/图片目录/合成画面）
+constexpr const char* DEFAULT_FRAME_SOURCE = "v4l2:0";
+constexpr double REPLAY_DEFAULT_FPS = 25.0;//录像/图片目录/合成画面的默认回放帧率
 
 //队列长度
-constexpr int FRAME_QUEUE_SIZE = 3;//帧队列长度（用于缓存摄像头采集的图像帧）
-constexpr int FACE_QUEUE_SIZE = 3; //人脸队列长度（用于缓存检测到的人脸数据）
+constexpr int FRAME_CHANNEL_SIZE = 3;//帧广播通道容量（满时覆盖最旧帧，显示/检测各自取最新帧）
+constexpr int FACE_QUEUE_SIZE = 3; //人脸队列长度（单位：批次，每帧检测到的全部人脸为一个批次）
+constexpr int MAX_FACES_PER_FRAME = 4;//每帧最多处理的人脸数（超出部分只取前N个）
+
+//检测工作线程数：每个线程持有独立的级联分类器（CascadeClassifier非线程安全），结果按帧顺序重排后输出
+//树莓派4B建议2~3，给采集/识别/显示留出核心
+constexpr int DETECT_WORKERS = 2;
+constexpr int MAX_DETECT_WORKERS = 8;//流水线配置文件中检测线程数的上限
+
+//流水线配置文件（YAML，可选）：各阶段线程数/绑核/优先级、各边容量/满时策略，不存在时使用上面的默认值
+constexpr const char* PIPELINE_CONFIG_PATH = "pipeline.yml";
+
+//帧池（预分配缓冲，流水线中循环复用，稳态下不再分配堆内存）
+//槽位数需覆盖：队列容量 + 采集/各检测线程/显示各自持有的一帧 + 余量
+constexpr int FRAME_POOL_SIZE = FRAME_CHANNEL_SIZE + DETECT_WORKERS + 4;//整帧池槽位数
+constexpr int FACE_POOL_SIZE = (FACE_QUEUE_SIZE + DETECT_WORKERS + 2) * MAX_FACES_PER_FRAME;//人脸区域池槽位数（含重排缓冲中滞留的）
+constexpr int FACE_CROP_MAX = 320;//人脸区域槽位边长上限（超出时等比缩小）
+
+//消费者等待新帧的超时（毫秒），超时后显示循环仍可响应按键、检测线程可检查退出标志
+constexpr int FRAME_WAIT_MS = 30;
 
 //人脸识别阀值（小于该值表示识别成功）
 constexpr double RECOGNIZE_THRESHOLD = 50.0;
 
-// Haar 人脸检测器路径
-constexpr const char* HAAR_PATH = "/usr/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml";
+//LBPH识别引擎
+constexpr bool LBPH_UNIFORM_PATTERNS = false;//统一模式直方图（每格59维，画廊缩小4倍；与OpenCV模型不兼容，需重新训练）
+constexpr int LBPH_ALIGN = 64;              //画廊直方图行对齐字节数（覆盖AVX/NEON加载宽度和缓存行）
+//画廊索引（先粗后精）：身份质心再聚成约√身份数个簇；预测时先比较簇中心，再比较最近几个簇内的身份质心，
+//最后只在最近的TOP_K个身份的样本中精确比较
+constexpr int LBPH_INDEX_MIN_IDENTITIES = 50;//身份数达到该值才启用索引（身份少时全量扫描已足够快，且结果与OpenCV相同）
+constexpr int LBPH_INDEX_TOP_K = 8;          //精排的候选身份数（越大越接近全量扫描的结果）
+constexpr int LBPH_INDEX_PROBE_CLUSTERS = 8; //展开比较的簇数（越大越接近全量扫描的结果）
+
+//人脸检测参数（detectMultiScale）
+constexpr double DETECT_SCALE_FACTOR = 1.1;//图像金字塔缩放步长
+constexpr int DETECT_MIN_NEIGHBORS = 4;    //候选框最少邻域数
+constexpr int FACE_MIN_SIZE = 60;          //最小人脸边长（原始分辨率像素）
+
+//先跟踪后检测：每隔N帧（或跟踪丢失后）做一次全图检测，其余帧只在上一帧人脸框附近搜索
+constexpr int TRACK_FULL_SCAN_INTERVAL = 10;//全图检测间隔（帧），1表示每帧全图检测（关闭跟踪）
+constexpr double TRACK_ROI_EXPAND = 0.5;    //搜索区域相对人脸框的外扩比例（每边外扩宽/高的50%）
+
+//轨迹身份缓存：同一个人跨帧保持同一轨迹ID，多帧投票判定，确认后跳过识别、定期复核
+constexpr double TRACK_ID_IOU = 0.3;       //相邻检测帧人脸框IoU≥该值视为同一轨迹
+constexpr int TRACK_ID_MAX_MISSES = 5;     //轨迹连续多少个检测帧未匹配到人脸即结束
+constexpr int VOTE_WINDOW = 5;             //投票窗口（每条轨迹最近N次识别结果）
+constexpr int VOTE_CONFIRM = 3;            //窗口内同一用户ID识别成功达到该次数即确认（开门）
+constexpr int VOTE_REJECT = 3;             //窗口内识别失败达到该次数即判定为未知人脸（报警，每条轨迹一次）
+constexpr int TRACK_REVERIFY_MS = 2000;    //已确认轨迹每隔该时长复核一次，其余帧跳过识别
+constexpr int TRACK_CACHE_TTL_MS = 3000;   //轨迹超过该时长未出现即从缓存移除
+
+//人脸质量门限：检测与识别之间的廉价评分，不合格的人脸不送识别（统计各原因的拒绝次数）
+//清晰度/曝光/对称性在统一缩放到QUALITY_SAMPLE_SIZE的未均衡化亮度图上计算，阈值与人脸远近无关
+constexpr bool QUALITY_GATE = true;           //是否启用质量门限（false时全部人脸送识别）
+constexpr int QUALITY_SAMPLE_SIZE = 64;       //评分采样边长（像素）
+constexpr int QUALITY_MIN_FACE = 72;          //最小人脸边长（原始分辨率像素，小脸的直方图噪声大）
+constexpr double QUALITY_MIN_SHARPNESS = 50.0;//拉普拉斯方差下限（模糊/运动拖影）
+constexpr double QUALITY_MIN_MEAN = 40.0;     //平均亮度下限（欠曝）
+constexpr double QUALITY_MAX_MEAN = 220.0;    //平均亮度上限（过曝）
+constexpr double QUALITY_MIN_CONTRAST = 18.0; //亮度标准差下限（对比度不足）
+constexpr double QUALITY_MAX_ASYMMETRY = 0.3; //左右镜像差异上限（相对平均亮度，侧脸时变大）
+constexpr int FACE_CANONICAL_SIZE = 100;      //送识别的人脸统一缩放到的边长（0表示保持原尺寸）
+
+//执行机构（继电器/蜂鸣器）：识别线程只投递命令，由执行机构线程按时间轮定时翻转引脚
+//GPIO后端："gpiod[:<芯片设备>]" | "sim"（模拟芯片，无/dev/gpiochip0的机器上测试延迟；可用 --gpio=<后端> 覆盖）
+constexpr const char* GPIO_BACKEND = "gpiod:/dev/gpiochip0";
+constexpr int DOOR_PIN_BCM = 18;          //继电器引脚（BCM编号，高电平开门）
+constexpr int BUZZER_PIN_BCM = 17;        //蜂鸣器引脚（BCM编号，低电平响）
+constexpr int DOOR_OPEN_MS = 2000;        //开门时长（开门期间再次确认则从确认时刻重新计时）
+constexpr int ALARM_BEEP_MS = 500;        //报警时长
+constexpr int ALARM_DEBOUNCE_MS = 1500;   //两次报警的最小间隔（多条未知轨迹同时出现时只响一次）
+constexpr int ACTUATOR_TICK_MS = 10;      //时间轮刻度（引脚复位的定时精度）
+constexpr int ACTUATOR_WHEEL_SLOTS = 256; //时间轮槽数（一圈 = 刻度×槽数，更长的定时按圈数计）
+constexpr int ACTUATOR_QUEUE_SIZE = 16;   //执行机构命令队列容量（满时丢弃新命令，识别线程不等待）
+
+//空闲降频：长时间无人脸时进入空闲状态，静止画面跳过检测；画面出现变化立即恢复全速
+constexpr int IDLE_TIMEOUT_MS = 10000;   //连续无人脸超过该时间进入空闲状态
+constexpr int IDLE_FRAME_SKIP = 5;       //空闲状态下每N帧只处理1帧（其余帧只出队不解码）
+constexpr int MOTION_GRID_WIDTH = 80;    //运动检测降采样宽度
+constexpr int MOTION_GRID_HEIGHT = 60;   //运动检测降采样高度
+constexpr int MOTION_PIXEL_DIFF = 20;    //降采样后像素灰度差超过该值视为变化
+constexpr double MOTION_AREA_RATIO = 0.01;//变化像素占比超过该值视为有运动
+
+//人脸检测后端："haar" | "lbp" | "dnn"（可用命令行 --detector=<后端>[:<模型路径>] 覆盖）
+constexpr const char* DETECTOR_BACKEND = "haar";
+//模型文件名不带目录时，依次在以下目录中查找（""表示当前目录）
+constexpr const char* MODEL_SEARCH_DIRS[] = {
+    "",
+    "/usr/share/opencv4/haarcascades/",
+    "/usr/local/share/opencv4/haarcascades/",
+    "/usr/share/opencv4/lbpcascades/",
+    "/usr/local/share/opencv4/lbpcascades/",
+    "models/",
+};
+// Haar 人脸检测器模型
+constexpr const char* HAAR_PATH = "haarcascade_frontalface_alt.xml";
+// LBP 人脸检测器模型（比Haar快数倍，适合树莓派）
+constexpr const char* LBP_PATH = "lbpcascade_frontalface_improved.xml";
+// cv::dnn 人脸检测模型（OpenCV face_detector示例中的res10 SSD，需自行下载到models/）
+constexpr const char* DNN_MODEL_PATH = "res10_300x300_ssd_iter_140000_fp16.caffemodel";
+constexpr const char* DNN_CONFIG_PATH = "deploy.prototxt";
+constexpr int DNN_INPUT_SIZE = 300;        //网络输入边长
+constexpr double DNN_CONFIDENCE = 0.5;     //置信度阈值
+
+// 模型路径（二进制格式，只读映射后原地使用；由face_train生成）
+constexpr const char* MODEL_PATH = "lbph_model.bin";
+// 旧版YAML模型路径（MODEL_PATH不存在时退回加载，可用face_model_convert转换）
+constexpr const char* MODEL_YML_PATH = "lbph_model.yml";
+// 模型热更新：模型文件写入完成后等待该时长无新变更再加载（训练工具可能连续写入多次）
+constexpr int MODEL_RELOAD_DEBOUNCE_MS = 300;
+// 模型训练：样本解码/归一化和直方图计算分摊到线程池；预处理结果缓存在样本目录下的打包文件中，
+// 重新训练时只解码新增或变化的样本（按大小+修改时间判断，时间变了内容没变的按内容哈希复用）
+constexpr int TRAIN_WORKERS = 0;           //训练线程数（0表示使用全部CPU核）
+constexpr int TRAIN_SAMPLE_SIZE = FACE_CANONICAL_SIZE > 0 ? FACE_CANONICAL_SIZE : 100;//样本统一缩放到的边长（与识别时送入的人脸一致）
+constexpr const char* TRAIN_DATASET_FILE = ".dataset.pack";//预处理缓存文件名（位于样本根目录下）
+// 按身份分片的模型存储：每人一个直方图分片，录入/删除一人只重算该人，合并全部分片生成MODEL_PATH
+constexpr const char* MODEL_SHARD_DIR = "lbph_shards";
+//日志：业务线程只把定长二进制记录写入无锁环形缓冲，格式化和文件输出都在日志线程中批量完成
+constexpr int LOG_RING_SIZE = 4096;            //环形缓冲记录数（2的幂，满时丢弃新记录并计数）
+constexpr int LOG_TEXT_SLOTS = 512;            //文本日志槽数（每槽LOG_TEXT_BYTES字节，用完时丢弃新文本并计数）
+constexpr const char* LOG_FILE_PATH = "face_door.log";//日志文件（按大小轮转为 .1 .2 ...）
+constexpr long LOG_FILE_MAX_BYTES = 4L << 20;  //单个日志文件上限（字节）
+constexpr int LOG_FILE_KEEP = 3;               //保留的历史日志文件数
+constexpr bool LOG_TO_CONSOLE = true;          //是否同时输出到终端
+constexpr int LOG_FLUSH_MS = 200;              //批量写出间隔（毫秒），积压超过LOG_BATCH_BYTES时立即写出
+constexpr int LOG_BATCH_BYTES = 64 * 1024;     //一批格式化文本的上限（字节）
+constexpr int LOG_POLL_MS = 5;                 //环形缓冲为空时日志线程的轮询间隔（毫秒）
+
+//出入记录日志（journal）：每次开门/报警判定追加一条记录（可带人脸缩略图），按段轮转，总大小有上限
+constexpr const char* JOURNAL_DIR = "journal";   //记录目录（每段：.idx定长索引、.dat缩略图、封段后的.lbl用户ID索引）
+constexpr long JOURNAL_SEGMENT_BYTES = 8L << 20; //单段上限（索引+缩略图，字节），超出时新开一段
+constexpr long JOURNAL_MAX_BYTES = 256L << 20;   //全部段的总大小上限（超出时删除最旧的段）
+constexpr int JOURNAL_THUMB_SIZE = 48;           //缩略图边长（0表示不保存缩略图）
+constexpr int JOURNAL_THUMB_QUALITY = 80;        //缩略图JPEG质量
+constexpr int JOURNAL_QUEUE_SIZE = 64;           //写入队列容量（满时丢弃并计数，识别线程不等待磁盘）
+constexpr int JOURNAL_CLOCK_STEP_MS = 1000;      //墙上时钟回拨超过该值时新开一段，小幅回退则沿用段内上一条的时间
+
+//运行指标：各阶段延迟直方图、队列深度/丢弃数、各线程CPU时间
+constexpr const char* METRICS_ENDPOINT = "tcp:127.0.0.1:9464";//指标端点：tcp:<地址>:<端口> | unix:<套接字路径> | off
+constexpr int METRICS_LOG_INTERVAL_S = 60;     //周期摘要日志间隔（秒，0表示不输出）
+constexpr int METRICS_REQUEST_TIMEOUT_MS = 200;//读取请求头的超时（毫秒）
 
-// 模型路径
-constexpr const char* MODEL_PATH = "lbph_model.yml";
\ No newline at end of file
+//预览画面：显示循环按PREVIEW_FPS限速取帧，只在画面或识别结果变化时绘制；无头模式（off）不取帧、不绘制
+constexpr const char* PREVIEW_SINK = "window";//预览输出：window | mjpeg:<文件> | tcp:<地址>:<端口> | unix:<套接字路径> | off
+constexpr int PREVIEW_FPS = 10;               //预览帧率上限
+constexpr int PREVIEW_JPEG_QUALITY = 70;      //套接字预览流的JPEG质量
+constexpr int PREVIEW_MAX_CLIENTS = 4;        //套接字预览流的最大观看者数
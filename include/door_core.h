@@ -1,43 +1,125 @@
 #pragma once
 #include <atomic>            // 原子变量，用于线程安全的运行状态控制
 #include <thread>            // 多线程支持，创建各业务线程
+#include <memory>            // unique_ptr，持有帧源
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>// OpenCV核心库，处理图像/人脸检测/识别
 #include "safe_queue.h"
+#include "frame_channel.h"
+#include "frame_source.h"
+#include "frame_pool.h"
+#include "idle_control.h"
+#include "face_tracker.h"
+#include "reorder_buffer.h"
+#include "face_batch.h"
+#include "face_quality.h"
+#include "model_watcher.h"
+#include "actuator.h"
+#include "journal.h"
+#include "metrics.h"
+#include "pipeline_graph.h"
+#include "preview_sink.h"
 #include "config.h"
 
 /**
  * @class DoorCore
  * @brief 人脸识别门禁系统核心业务类
  * @details 采用多线程架构，将门禁系统拆分为4个独立线程：
- *          1. 采集线程：摄像头实时采帧，存入帧队列
- *          2. 检测线程：从帧队列取帧，检测人脸并存入人脸队列
- *          3. 识别线程：从人脸队列取人脸，进行身份识别并控制硬件
+ *          1. 采集线程：从帧源（摄像头/录像/图片目录/合成画面）采帧，广播到帧通道
+ *          2. 检测线程池：若干个线程（默认DETECT_WORKERS）并行从帧通道取最新帧检测人脸，每帧的全部人脸作为一个批次，
+ *             按帧顺序存入人脸队列
+ *          3. 识别线程：从人脸队列取人脸批次，按轨迹多帧投票判定，把开门/报警命令投递给执行机构
+ *             （已确认的轨迹跳过识别）
  *          4. 日志线程：处理系统日志，异步输出/保存
- * @note 所有线程通过线程安全队列通信，原子变量控制全局运行状态
+ *          5. 模型监视线程：模型文件被重新训练/转换或收到SIGHUP时在后台加载新模型，
+ *             用shared_ptr原子替换发布给识别线程（正在进行的预测用旧模型完成，识别不中断）
+ *          6. 执行机构线程：按时间轮定时翻转继电器/蜂鸣器引脚，识别线程不再等待硬件
+ * @note 采集→显示/检测通过广播通道（每个消费者都能拿到最新帧），其余线程通过线程安全队列通信，
+ *       原子变量控制全局运行状态；各阶段线程数/绑核/优先级、各边容量/满时策略由PipelineGraph给出
  */
 class DoorCore {
 public:
     //构造函数,初始化成员变量，设置线程安全队列容量，原子变量初始化为false
-    DoorCore();
+    //source为空时使用默认实时摄像头（DEFAULT_FRAME_SOURCE）
+    //detector_spec为人脸检测后端描述（同createFaceDetector，每个检测线程各创建一个实例）
+    //gpio_spec为GPIO后端描述（同createGpioBackend，真实芯片打开失败时退回模拟芯片）
+    //metrics_spec为指标端点描述（同MetricsServer）
+    //graph为流水线参数（默认即config.h中的取值）
+    //preview_spec为预览输出描述（同createPreviewSink，off为无头模式）
+    explicit DoorCore(std::unique_ptr<FrameSource> source = nullptr,
+                      const std::string& detector_spec = DETECTOR_BACKEND,
+                      const std::string& gpio_spec = GPIO_BACKEND,
+                      const std::string& metrics_spec = METRICS_ENDPOINT,
+                      const PipelineGraph& graph = PipelineGraph::defaults(),
+                      const std::string& preview_spec = PREVIEW_SINK);
     //析构函数,停止所有运行中的线程，释放资源，避免内存泄漏/线程残留
     ~DoorCore();
     //启动门禁系统（核心入口函数）
     void startSystem();
 
 private:
+    /**
+     * @brief 一帧的检测结果（检测工作线程→重排序缓冲）
+     * @note 各检测线程循环复用同一个对象：提交时与重排序缓冲槽位中的旧结果交换，vector容量随之保留
+     */
+    struct DetectResult {
+        bool detected = false;       // 是否执行了检测（false=空闲且画面静止，已跳过）
+        int scale = 1;               // 灰度图相对原始分辨率的缩小倍数
+        TrackPlan plan;              // 本帧的检测计划（按序提交给跟踪器）
+        std::vector<cv::Rect> faces; // 检测到的人脸（灰度图坐标）
+        FaceBatch batch;             // 本帧人脸批次（帧序号、时间戳、各人脸的紧凑拷贝）
+    };
+
     void captureThread();  //摄像头采集线程函数
-    void detectThread();   //人脸检测线程函数
+    void detectThread(int worker_id);//人脸检测工作线程函数
+    void publishDetectResult(DetectResult& result);//按帧顺序输出检测结果（重排序缓冲回调）
     void recognizeThread();//人脸识别线程函数
     void logThread();      //日志处理线程函数
+    void previewLoop();    //预览循环（主线程，限速绘制；无头模式下只等待退出）
+    void registerMetrics();//登记导出时读取的指标（队列深度、丢弃数等）
+    void applyStage(const std::string& stage);//按流水线配置设置调用线程的绑核/优先级，失败时记录日志
+    //后台加载新模型并原子替换（模型监视线程回调）
+    void reloadModel(const std::string& reason, std::chrono::steady_clock::time_point detected);
 
     // ====================== 成员变量 ======================
     std::atomic<bool> is_running_{false};//系统运行状态标志（原子变量）
+    std::unique_ptr<FrameSource> source_;//帧源（采集线程独占使用）
+    std::string detector_spec_;          //人脸检测后端描述
+    std::string metrics_spec_;           //指标端点描述
+    std::string preview_spec_;           //预览输出描述
+    std::atomic<long long> preview_frames_{0};//已输出的预览帧数
+    PipelineGraph graph_;                //流水线参数（须先于按它确定容量的池/队列/出入记录构造）
+    MetricsRegistry metrics_;            //运行指标（各阶段延迟直方图等；须先于使用它的执行机构构造）
+    std::atomic<long long> door_capture_ns_{0};//最近一次开门判定所依据帧的采集时刻（steady_clock纳秒，统计采集→开门）
+    IdleController idle_;                //空闲状态机（检测线程驱动，采集线程据此降频）
+    MotionGate motion_gate_;             //降采样帧差（空闲状态下判断画面是否静止）
+    std::mutex idle_mtx_;                //保护idle_/motion_gate_（多个检测线程共用）
+    FaceTracker tracker_;                //先跟踪后检测（内部加锁，结果按帧顺序提交）
+    TrackIdAssigner track_ids_;          //人脸轨迹ID分配（按帧顺序在publishDetectResult中调用）
+    QualityCounters quality_;            //人脸质量门限的分原因计数（各检测线程累加）
+
+    std::mutex detect_mtx_;              //检测线程池取帧锁（取帧与领票号原子完成）
+    int detect_consumer_ = -1;           //检测线程池在帧通道中的共享游标
+    unsigned long long detect_ticket_ = 0;//下一个检测票号
+    std::atomic<long long> detected_frames_{0};//已输出检测结果的帧数
 
     std::thread cap_thread_;   //摄像头采集线程对象
-    std::thread detect_thread_;//人脸检测线程对象
+    std::vector<std::thread> detect_threads_;//人脸检测工作线程对象
     std::thread rec_thread_;   //人脸识别线程对象
     std::thread log_thread_;   //日志处理线程对象
+    std::unique_ptr<ModelWatcher> model_watcher_;//模型文件监视（热更新）
+    std::unique_ptr<Actuator> actuator_;//执行机构线程（继电器/蜂鸣器定时控制，识别线程只投递命令）
+    JournalWriter journal_{JOURNAL_DIR, static_cast<size_t>(graph_.edge("journal").capacity)};//出入记录（识别线程入队，后台线程写盘）
+    std::unique_ptr<MetricsServer> metrics_server_;//指标端点与周期摘要日志
  
-    SafeQueue<cv::Mat> frame_queue_{FRAME_QUEUE_SIZE};//帧队列（采集线程→检测线程）存储摄像头采集的原始帧，容量为FRAME_QUEUE_SIZE（3）避免帧堆积，满时采集线程丢弃新帧
-    SafeQueue<cv::Mat> face_queue_{FACE_QUEUE_SIZE}; //人脸队列（检测线程→识别线程）存储检测到的人脸区域图像，容量为FACE_QUEUE_SIZE（3） 
+    //帧池必须声明在队列和重排序缓冲之前：成员逆序析构，保证其中的FrameRef先于帧池释放
+    std::unique_ptr<FramePool> frame_pool_;//整帧池（采集线程打开帧源后按解码模式创建：BGR整帧或灰度+MJPEG原始数据）
+    FramePool face_pool_{"face", graph_.facePoolSize(), FACE_CROP_MAX, FACE_CROP_MAX, CV_8UC1};  //人脸区域池（检测线程写入紧凑拷贝）
+
+    FrameChannel<FrameRef> frame_channel_{static_cast<size_t>(graph_.edge("frames").capacity)};//帧通道（采集线程→显示循环/检测线程）广播帧池槽位引用，满时覆盖最旧帧
+    SpscRing<FaceBatch, QueueFullPolicy::OVERWRITE_OLDEST> face_queue_{static_cast<size_t>(graph_.edge("faces").capacity)}; //人脸队列（检测线程→识别线程）每帧一个批次，存储人脸区域池槽位引用，默认容量FACE_QUEUE_SIZE（3）；入队只在重排序缓冲锁内进行，单生产者无锁环形缓冲即可；满时按faces边的策略丢弃新批次、覆盖最旧批次或等待（push(batch, policy)）
+    ReorderBuffer<DetectResult> detect_order_{MAX_DETECT_WORKERS};//检测结果重排序缓冲（每个检测线程至多一个在途票号）
 };
\ No newline at end of file
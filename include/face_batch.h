@@ -0,0 +1,105 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include "config.h"
+#include "frame_pool.h"
+
+/**
+ * @brief 一帧中检测到的全部人脸（检测线程→识别线程，每帧一个批次）
+ * @details 定长数组存放，入队/出队不分配堆内存；frame_id为帧序号，识别结果据此对应回所属帧
+ */
+struct FaceBatch {
+    long long frame_id = 0;                              // 帧序号
+    std::chrono::steady_clock::time_point capture_ts;    // 采集时间戳
+    std::chrono::steady_clock::time_point queued_ts;     // 送入人脸队列的时刻（统计排队时长）
+    int count = 0;                                       // 人脸数（≤MAX_FACES_PER_FRAME）
+    std::array<cv::Rect, MAX_FACES_PER_FRAME> boxes;     // 人脸框（原始分辨率坐标）
+    std::array<FrameRef, MAX_FACES_PER_FRAME> crops;     // 人脸区域（人脸池槽位，池耗尽时为空引用）
+    std::array<int, MAX_FACES_PER_FRAME> track_ids{};    // 轨迹ID（同一个人跨帧不变）
+};
+
+//单张人脸的识别状态（显示颜色）
+enum class FaceState { PENDING, ACCEPTED, REJECTED };
+
+/**
+ * @brief 显示叠加层的一次快照：最近一帧的人脸框及各自的识别结果
+ */
+struct FaceOverlay {
+    long long frame_id = 0;                              // 人脸框所属帧序号
+    long long result_frame_id = 0;                       // 最近一次识别结果所属帧序号
+    int count = 0;                                       // 人脸数
+    std::array<cv::Rect, MAX_FACES_PER_FRAME> boxes;     // 人脸框（原始分辨率坐标）
+    std::array<int, MAX_FACES_PER_FRAME> labels{};       // 识别出的用户ID（-1表示未知）
+    std::array<FaceState, MAX_FACES_PER_FRAME> states{}; // 识别状态
+};
+
+/**
+ * @class FaceOverlayBoard
+ * @brief 检测线程写人脸框、识别线程写识别结果、显示循环读快照的共享叠加层
+ * @details 1. setBoxes：新一帧的人脸框；与上一帧重叠（IoU≥0.3）的框沿用原识别结果，
+ *             新出现的人脸标记为识别中，避免每帧闪烁
+ *          2. setResults：识别结果（各人脸所属轨迹的当前状态）带所属帧序号；该帧的人脸框已被
+ *             更新的帧替换时，按IoU找到同一个人的框再写入
+ */
+class FaceOverlayBoard {
+public:
+    void setBoxes(long long frame_id, const cv::Rect* boxes, int count) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        FaceOverlay next;
+        next.frame_id = frame_id;
+        next.count = std::min(count, MAX_FACES_PER_FRAME);
+        for (int i = 0; i < next.count; i++) {
+            next.boxes[i] = boxes[i];
+            next.labels[i] = -1;
+            next.states[i] = FaceState::PENDING;
+            int j = match(overlay_, boxes[i]);
+            if (j >= 0) {
+                next.labels[i] = overlay_.labels[j];
+                next.states[i] = overlay_.states[j];
+            }
+        }
+        next.result_frame_id = overlay_.result_frame_id;
+        overlay_ = next;
+    }
+
+    void setResults(long long frame_id, const cv::Rect* boxes, const int* labels,
+                    const FaceState* states, int count) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        overlay_.result_frame_id = frame_id;
+        for (int i = 0; i < count; i++) {
+            // 同一帧的框完全相同（IoU=1），更新的帧中按重叠找到同一个人
+            int j = match(overlay_, boxes[i]);
+            if (j < 0) continue;// 这个人已经离开画面
+            overlay_.labels[j] = labels[i];
+            overlay_.states[j] = states[i];
+        }
+    }
+
+    FaceOverlay snapshot() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return overlay_;
+    }
+
+private:
+    //在overlay中找与box重叠最大（IoU≥0.3）的人脸框，找不到返回-1
+    static int match(const FaceOverlay& overlay, const cv::Rect& box) {
+        int best = -1;
+        double best_iou = 0.3;
+        for (int i = 0; i < overlay.count; i++) {
+            double inter = (overlay.boxes[i] & box).area();
+            double uni = overlay.boxes[i].area() + box.area() - inter;
+            double iou = uni > 0 ? inter / uni : 0.0;
+            if (iou >= best_iou) {
+                best_iou = iou;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    mutable std::mutex mtx_;// 保护overlay_
+    FaceOverlay overlay_;   // 当前叠加层
+};
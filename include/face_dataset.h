@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "config.h"
+
+/**
+ * @brief 一次样本同步的统计
+ */
+struct DatasetStats {
+    int samples = 0;      // 同步后的样本数
+    int reused = 0;       // 大小与修改时间未变，直接复用缓存
+    int rehashed = 0;     // 修改时间变了但内容哈希相同，复用缓存
+    int decoded = 0;      // 新增或内容变化，重新解码
+    int failed = 0;       // 无法读取/解码（不计入样本）
+    int removed = 0;      // 缓存中有、目录中已删除
+    double scan_ms = 0;   // 遍历目录、读取文件属性
+    double decode_ms = 0; // 读取文件、哈希、解码和缩放（线程池）
+};
+
+/**
+ * @class FaceDataset
+ * @brief 训练样本集：定长灰度人脸（TRAIN_SAMPLE_SIZE边长）+ 标签数组 + 源文件清单，可打包保存到单个文件
+ * @details 1. sync()遍历 <样本根目录>/<用户ID>/ 下的图片，与清单比较：大小和修改时间都未变的直接复用；
+ *             其余的在线程池中读取文件并计算内容哈希，哈希与清单一致（只是被touch/复制过）时复用，
+ *             否则解码为灰度图并缩放到统一尺寸；目录中已删除的样本从样本集中去掉
+ *          2. 打包文件布局：文件头 | 标签int32[样本数] | 清单记录[样本数] | 相对路径字符串 | 样本像素（样本数×边长²字节）；
+ *             各段按LBPH_ALIGN对齐，先写临时文件再改名，中途中断不会留下半个文件
+ *          3. 打包文件与样本尺寸/格式版本不符或损坏时load()返回false，调用方从空样本集重新同步即可
+ * @note sync()/load()/save()非线程安全，由训练工具单线程调用
+ */
+class FaceDataset {
+public:
+    //读取打包文件，失败返回false（样本集保持为空）
+    bool load(const std::string& path);
+    //保存为打包文件，失败返回false
+    bool save(const std::string& path) const;
+    //与样本目录同步（只解码新增或变化的样本），workers≤0时使用全部CPU核；目录无法遍历时返回false
+    //only_label≥0时只遍历该用户的目录，同步后样本集只包含该用户（单人录入用）
+    bool sync(const std::string& data_dir, int workers, DatasetStats& stats, int only_label = -1);
+
+    int size() const { return static_cast<int>(labels_.size()); }
+    int sampleSize() const { return TRAIN_SAMPLE_SIZE; }
+    //第i个样本（指向内部缓冲的灰度图视图，样本集变化前有效）
+    cv::Mat sample(int i) const;
+    int label(int i) const { return labels_[i]; }
+    const std::vector<int>& labels() const { return labels_; }
+    //第i个样本相对样本根目录的路径（如"3/face_12.jpg"）
+    const std::string& path(int i) const { return records_[i].path; }
+
+private:
+    struct Record {
+        std::string path; // 相对样本根目录的路径
+        uint64_t bytes;   // 文件大小
+        int64_t mtime_ns; // 修改时间（纳秒）
+        uint64_t hash;    // 文件内容的64位FNV-1a
+    };
+    std::vector<int> labels_;           // 用户ID
+    std::vector<Record> records_;       // 源文件清单（与labels_一一对应）
+    std::vector<unsigned char> pixels_; // 样本像素（连续存放，每个TRAIN_SAMPLE_SIZE²字节）
+};
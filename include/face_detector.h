@@ -0,0 +1,88 @@
+#pragma once
+#include <opencv2/opencv.hpp>// 级联分类器
+#include <opencv2/dnn.hpp>   // cv::dnn CPU推理
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class FaceDetector
+ * @brief 人脸检测后端接口：门禁主程序、人脸采集工具、性能测试工具共用
+ * @details 实现类：
+ *          CascadeFaceDetector  Haar/LBP级联分类器（LBP比默认Haar快数倍，误检略多）
+ *          DnnFaceDetector      cv::dnn CPU推理（SSD人脸模型，从本地文件加载）
+ * @note 检测器内部有可变状态，不是线程安全的，每个线程应持有自己的实例
+ */
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+    //加载模型文件，失败返回false
+    virtual bool load() = 0;
+    /**
+     * @brief 检测人脸
+     * @param gray 灰度图（可以是ROI视图）
+     * @param faces 输出：gray坐标系下的人脸框
+     * @param min_size 最小人脸尺寸
+     * @param max_size 最大人脸尺寸（空表示不限）
+     */
+    virtual void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces,
+                        cv::Size min_size, cv::Size max_size = cv::Size()) = 0;
+    //后端描述（用于日志）
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @class CascadeFaceDetector
+ * @brief Haar/LBP级联分类器后端（两者共用detectMultiScale，只是模型文件不同）
+ */
+class CascadeFaceDetector : public FaceDetector {
+public:
+    //kind为"haar"或"lbp"（仅用于日志），path为模型文件名或路径
+    CascadeFaceDetector(const std::string& kind, const std::string& path) : kind_(kind), path_(path) {}
+    bool load() override;
+    void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces,
+                cv::Size min_size, cv::Size max_size = cv::Size()) override;
+    std::string name() const override { return kind_ + ":" + path_; }
+
+private:
+    std::string kind_;              // 后端类型
+    std::string path_;              // 模型路径（load成功后为实际加载的路径）
+    cv::CascadeClassifier cascade_; // 级联分类器
+};
+
+/**
+ * @class DnnFaceDetector
+ * @brief cv::dnn CPU后端：输出格式为[1,1,N,7]的SSD人脸模型（如res10_300x300_ssd）
+ * @details 输入灰度图复制为3通道后缩放到DNN_INPUT_SIZE推理，置信度≥DNN_CONFIDENCE的框
+ *          换算回输入坐标并按min_size/max_size过滤
+ */
+class DnnFaceDetector : public FaceDetector {
+public:
+    DnnFaceDetector(const std::string& model, const std::string& config) : model_(model), config_(config) {}
+    bool load() override;
+    void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces,
+                cv::Size min_size, cv::Size max_size = cv::Size()) override;
+    std::string name() const override { return "dnn:" + model_; }
+
+private:
+    std::string model_;  // 权重文件路径
+    std::string config_; // 网络结构文件路径（可为空，由权重格式决定）
+    cv::dnn::Net net_;   // 推理网络
+    cv::Mat bgr_;        // 3通道输入缓冲（复用）
+    cv::Mat blob_;       // 网络输入缓冲（复用）
+};
+
+/**
+ * @brief 在当前目录和OpenCV安装目录中查找模型文件
+ * @param file 文件名或路径（绝对路径/含目录的路径原样返回）
+ * @return 找到的路径，找不到时返回空字符串
+ */
+std::string findModelFile(const std::string& file);
+
+/**
+ * @brief 根据描述字符串创建人脸检测器（未加载，调用方需调用load()）
+ * @param spec 后端描述："haar" | "lbp" | "dnn"，可附带模型路径，如 "lbp:my_cascade.xml"
+ *             （dnn为 "dnn:<权重>[,<网络结构>]"）；不带路径时使用config.h中的默认模型
+ * @return 检测器对象，描述无法识别时返回nullptr
+ */
+std::unique_ptr<FaceDetector> createFaceDetector(const std::string& spec);
@@ -0,0 +1,72 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <atomic>
+#include <string>
+#include "config.h"
+
+//人脸质量评估结果（OK表示可送识别，其余为拒绝原因，按检查顺序排列）
+enum class QualityReason {
+    OK,          // 合格
+    SMALL,       // 人脸过小
+    DARK,        // 欠曝
+    BRIGHT,      // 过曝
+    LOW_CONTRAST,// 对比度不足
+    BLUR,        // 模糊
+    ASYMMETRIC,  // 左右不对称（侧脸/半张脸）
+    COUNT        // 原因数（用于计数数组）
+};
+
+/**
+ * @brief 一张人脸的质量评分
+ */
+struct FaceQuality {
+    QualityReason reason = QualityReason::OK;// 评估结果
+    double score = 0.0;     // 综合得分（0~1，越大越适合识别；不合格时为0）
+    double sharpness = 0.0; // 拉普拉斯方差
+    double mean = 0.0;      // 平均亮度
+    double contrast = 0.0;  // 亮度标准差
+    double asymmetry = 0.0; // 左右镜像平均差异 / 平均亮度
+};
+
+/**
+ * @class FaceQualityGate
+ * @brief 检测与识别之间的廉价质量评分：尺寸、清晰度、曝光、正脸程度
+ * @details 1. 人脸区域先缩放到QUALITY_SAMPLE_SIZE见方的采样图，之后各项开销固定，阈值与人脸远近无关
+ *          2. 按开销从低到高检查：尺寸 → 平均亮度/标准差 → 拉普拉斯方差 → 左半与镜像右半的差异，
+ *             任一项不合格立即返回
+ *          3. 合格人脸的得分为各项相对阈值的余量之积，同一帧的人脸按得分排序，优先送识别
+ * @note 输入为未均衡化的亮度图（均衡化会抹掉曝光信息）；内部缓冲复用，非线程安全，每个检测线程一份
+ */
+class FaceQualityGate {
+public:
+    /**
+     * @brief 评估一张人脸
+     * @param luma 人脸区域（未均衡化亮度图的ROI视图）
+     * @param scale luma相对原始分辨率的缩小倍数（尺寸检查按原始分辨率）
+     */
+    FaceQuality evaluate(const cv::Mat& luma, int scale = 1);
+
+    //拒绝原因的名称（用于日志）
+    static const char* reasonName(QualityReason reason);
+
+private:
+    cv::Mat sample_, lap_, mirror_, diff_;// 采样图、拉普拉斯响应、右半镜像、左右差异（复用）
+};
+
+/**
+ * @class QualityCounters
+ * @brief 质量门限的分原因计数（各检测线程并发累加）
+ */
+class QualityCounters {
+public:
+    //记录一次评估结果
+    void record(QualityReason reason) { counts_[static_cast<int>(reason)]++; }
+    //某一原因的次数
+    unsigned long long count(QualityReason reason) const { return counts_[static_cast<int>(reason)]; }
+    //统计摘要：评估总数、通过数、各原因拒绝数及占比（拒绝数即省去的识别次数）
+    std::string summary() const;
+
+private:
+    std::array<std::atomic<unsigned long long>, static_cast<int>(QualityReason::COUNT)> counts_{};
+};
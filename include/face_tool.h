@@ -2,19 +2,48 @@
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
+#include "config.h"
 
 /**
  * @brief 人脸采集核心函数
  * @param user_id 用户ID
  * @param save_dir 保存目录
+ * @param source_spec 帧源描述（同createFrameSource，默认实时摄像头）
+ * @param detector_spec 人脸检测后端描述（同createFaceDetector，与门禁主程序一致）
  * @return 采集成功返回true
  */
-bool collectFace(int user_id, const std::string& save_dir);
+bool collectFace(int user_id, const std::string& save_dir,
+                 const std::string& source_spec = "v4l2:0",
+                 const std::string& detector_spec = DETECTOR_BACKEND);
 
 /**
- * @brief LBPH模型训练核心函数
- * @param data_dir 人脸数据目录
+ * @brief LBPH模型训练核心函数（全量重建：全部用户的分片和模型）
+ * @param data_dir 人脸数据目录（预处理缓存TRAIN_DATASET_FILE也保存在此目录下）
  * @param model_path 模型保存路径
+ * @param workers 解码/直方图计算线程数（≤0表示使用全部CPU核）
+ * @param shard_dir 按身份分片的直方图目录
  * @return 训练成功返回true
  */
-bool trainLBPHModel(const std::string& data_dir, const std::string& model_path);
\ No newline at end of file
+bool trainLBPHModel(const std::string& data_dir, const std::string& model_path, int workers = TRAIN_WORKERS,
+                    const std::string& shard_dir = MODEL_SHARD_DIR);
+
+/**
+ * @brief 录入/重新录入一个用户（只计算该用户的直方图分片，再合并全部分片生成模型）
+ * @param user_id 用户ID
+ * @param data_dir 人脸数据目录（该用户的样本在 data_dir/<用户ID>/ 下）
+ * @param model_path 模型保存路径
+ * @param workers 解码/直方图计算线程数（≤0表示使用全部CPU核）
+ * @param shard_dir 按身份分片的直方图目录
+ * @return 成功返回true
+ */
+bool enrollIdentity(int user_id, const std::string& data_dir, const std::string& model_path,
+                    int workers = TRAIN_WORKERS, const std::string& shard_dir = MODEL_SHARD_DIR);
+
+/**
+ * @brief 删除一个用户（先合并其余分片生成模型，保存成功后再删除其分片；删除最后一个用户时生成空画廊模型）
+ * @param user_id 用户ID
+ * @param model_path 模型保存路径
+ * @param shard_dir 按身份分片的直方图目录
+ * @return 成功返回true
+ */
+bool removeIdentity(int user_id, const std::string& model_path, const std::string& shard_dir = MODEL_SHARD_DIR);
\ No newline at end of file
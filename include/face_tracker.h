@@ -0,0 +1,93 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "config.h"
+#include "face_detector.h"// 检测后端
+
+/**
+ * @brief 一帧的检测计划：全图检测，或只在若干搜索区域内检测
+ */
+struct TrackPlan {
+    bool full_scan = true;          // true=全图检测
+    std::vector<cv::Rect> rois;     // 局部搜索区域（与last_boxes一一对应）
+    std::vector<cv::Rect> last_boxes;// 上一次的人脸框（用于限定局部搜索的尺度范围）
+};
+
+/**
+ * @class FaceTracker
+ * @brief 先跟踪后检测：全图检测只每隔N帧或跟踪丢失后执行一次，
+ *        其余帧只在上一帧人脸框外扩后的区域内、以相近尺度搜索
+ * @details 站在门前的人帧间位移很小，局部搜索的面积和尺度范围都远小于全图，
+ *          检测耗时随之大幅下降；任一人脸在局部搜索中丢失时，下一帧立即回到全图检测
+ * @note plan()/commit()分离且内部加锁，检测本身（run）可以在锁外并行执行
+ */
+class FaceTracker {
+public:
+    explicit FaceTracker(int full_scan_interval = TRACK_FULL_SCAN_INTERVAL,
+                         double roi_expand = TRACK_ROI_EXPAND)
+        : full_scan_interval_(full_scan_interval), roi_expand_(roi_expand) {}
+
+    //根据当前跟踪状态生成本帧的检测计划（写入p，复用其vector容量）
+    void plan(cv::Size frame_size, TrackPlan& p);
+    //按计划执行检测（不访问跟踪状态，可在锁外调用），结果为gray坐标系下的人脸框
+    static void run(FaceDetector& detector, const cv::Mat& gray, const TrackPlan& plan,
+                    std::vector<cv::Rect>& faces, cv::Size min_size);
+    //用本帧检测结果更新跟踪状态
+    void commit(const TrackPlan& plan, const std::vector<cv::Rect>& faces);
+
+    //单线程便捷接口：plan→run→commit
+    void detect(FaceDetector& detector, const cv::Mat& gray,
+                std::vector<cv::Rect>& faces, cv::Size min_size);
+
+    //统计：全图检测次数、局部搜索次数、跟踪丢失次数
+    unsigned long long fullScans() const { return full_scans_; }
+    unsigned long long roiScans() const { return roi_scans_; }
+    unsigned long long lostCount() const { return lost_; }
+
+private:
+    int full_scan_interval_;        // 全图检测间隔（帧）
+    double roi_expand_;             // 搜索区域外扩比例
+    std::vector<cv::Rect> tracks_;  // 当前跟踪的人脸框
+    int frames_since_full_ = 0;     // 距上次全图检测的帧数
+    bool force_full_ = true;        // 跟踪丢失后强制全图检测
+    std::mutex mtx_;                // 保护以上跟踪状态
+    TrackPlan detect_plan_;         // detect()的检测计划（复用）
+    std::atomic<unsigned long long> full_scans_{0}, roi_scans_{0}, lost_{0};// 统计计数
+};
+
+/**
+ * @class TrackIdAssigner
+ * @brief 为每帧的人脸框分配跨帧稳定的轨迹ID
+ * @details 与上一检测帧的人脸框按IoU从大到小贪心匹配（IoU≥TRACK_ID_IOU），匹配上的沿用原ID，
+ *          其余分配新ID；连续TRACK_ID_MAX_MISSES个检测帧未匹配的轨迹结束，ID不再复用
+ * @note 非线程安全，必须按帧顺序调用（在检测结果重排序之后）
+ */
+class TrackIdAssigner {
+public:
+    explicit TrackIdAssigner(double min_iou = TRACK_ID_IOU, int max_misses = TRACK_ID_MAX_MISSES)
+        : min_iou_(min_iou), max_misses_(max_misses) {}
+
+    //为本帧的count个人脸框分配轨迹ID，写入ids
+    void assign(const cv::Rect* boxes, int count, int* ids);
+    //累计创建的轨迹数
+    int created() const { return next_id_ - 1; }
+
+private:
+    struct Track {
+        int id;        // 轨迹ID
+        cv::Rect box;  // 最近一次的人脸框
+        int misses;    // 连续未匹配的检测帧数
+    };
+    struct Pair {
+        double iou;     // 轨迹与人脸框的IoU
+        int track, box; // 轨迹下标、人脸框下标
+    };
+    double min_iou_;            // 匹配所需的最小IoU
+    int max_misses_;            // 轨迹结束前允许连续未匹配的帧数
+    std::vector<Track> tracks_; // 当前轨迹
+    std::vector<Pair> pairs_;   // IoU达标的（轨迹, 人脸框）对（每帧复用）
+    std::vector<char> track_used_;// 各轨迹本帧是否已匹配（每帧复用）
+    int next_id_ = 1;           // 下一个轨迹ID
+};
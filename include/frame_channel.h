@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+*  广播通道：一个生产者（采集线程），多个消费者（显示循环、检测线程）
+*  与SafeQueue的区别：
+*  1. 每个消费者有独立游标，同一帧可以被所有消费者看到，消费者之间不再互相“抢帧”
+*  2. 环形缓冲满时覆盖最旧的帧（SafeQueue满时丢弃的是最新帧），消费者总能拿到最新画面
+*  3. 每个消费者单独统计收到的帧数和被跳过（覆盖/追新）的帧数
+*/
+
+template <typename T>
+class FrameChannel {
+public:
+    //指定环形缓冲容量（至少为1）
+    explicit FrameChannel(size_t capacity = 3) : ring_(capacity > 0 ? capacity : 1) {}
+
+    //注册消费者，返回消费者编号；游标从当前最新位置开始（不回放注册前的帧）
+    int subscribe(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        consumers_.push_back(Consumer{name, write_seq_, 0, 0});
+        return static_cast<int>(consumers_.size()) - 1;
+    }
+
+    //发布一帧，非阻塞；缓冲满时覆盖最旧的帧
+    void publish(const T& item) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ring_[write_seq_ % ring_.size()] = item;// 覆盖最旧槽位（旧元素在此析构/释放）
+        write_seq_++;
+        cond_.notify_all();// 唤醒所有等待的消费者
+    }
+
+    //取最新一帧（跳过该消费者尚未读取的旧帧，计入丢帧）
+    //超时或通道停止返回false
+    bool popLatest(int consumer, T& item, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        Consumer& c = consumers_[consumer];
+        if (!waitFor(lock, c, timeout)) return false;
+        unsigned long long newest = write_seq_ - 1;
+        c.drops += newest - c.cursor;// 中间未读取的帧全部跳过
+        item = ring_[newest % ring_.size()];
+        c.cursor = write_seq_;
+        c.received++;
+        return true;
+    }
+
+    //按顺序取下一帧；游标落后超过缓冲容量时，被覆盖的帧计入丢帧
+    //超时或通道停止返回false
+    bool pop(int consumer, T& item, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        Consumer& c = consumers_[consumer];
+        if (!waitFor(lock, c, timeout)) return false;
+        unsigned long long oldest = write_seq_ > ring_.size() ? write_seq_ - ring_.size() : 0;
+        if (c.cursor < oldest) {
+            c.drops += oldest - c.cursor;// 已被覆盖的帧
+            c.cursor = oldest;
+        }
+        item = ring_[c.cursor % ring_.size()];
+        c.cursor++;
+        c.received++;
+        return true;
+    }
+
+    //主动停止，唤醒所有等待的消费者
+    void stop() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_flag_ = true;
+        cond_.notify_all();
+    }
+
+    //第consumer个消费者的积压帧数（已发布未读，含将被覆盖的）与累计丢帧数
+    void consumerStats(int consumer, unsigned long long& backlog, unsigned long long& drops) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const Consumer& c = consumers_[consumer];
+        backlog = std::min<unsigned long long>(write_seq_ - c.cursor, ring_.size());
+        drops = c.drops;
+    }
+
+    //统计摘要（用于日志）：每个消费者的收帧数和丢帧数
+    std::string summary() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::string s = "[通道] 发布=" + std::to_string(write_seq_);
+        for (const Consumer& c : consumers_) {
+            s += " | " + c.name + ": 收到=" + std::to_string(c.received) +
+                 " 丢弃=" + std::to_string(c.drops);
+        }
+        return s;
+    }
+
+private:
+    struct Consumer {
+        std::string name;            // 消费者名称（日志用）
+        unsigned long long cursor;   // 下一个待读取的发布序号
+        unsigned long long received; // 已收到帧数
+        unsigned long long drops;    // 被跳过的帧数
+    };
+
+    //等待该消费者有未读帧；超时或停止返回false
+    bool waitFor(std::unique_lock<std::mutex>& lock, const Consumer& c,
+                 std::chrono::milliseconds timeout) {
+        return cond_.wait_for(lock, timeout, [&]() {
+                   return c.cursor < write_seq_ || stop_flag_;
+               }) && !stop_flag_;
+    }
+
+    std::vector<T> ring_;                 // 环形缓冲
+    std::deque<Consumer> consumers_;      // 消费者游标（deque：注册新消费者时已有元素地址不变）
+    unsigned long long write_seq_ = 0;    // 已发布帧总数（下一个写入序号）
+    mutable std::mutex mtx_;              // 保护以上所有成员
+    std::condition_variable cond_;        // 有新帧/停止时唤醒消费者
+    bool stop_flag_ = false;              // 停止标志
+};
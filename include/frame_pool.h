@@ -0,0 +1,122 @@
+#pragma once
+#include <opencv2/opencv.hpp>// cv::Mat 预分配缓冲
+#include <atomic>            // 引用计数/统计计数
+#include <chrono>            // 采集时间戳
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class FramePool;
+
+/**
+ * @brief 帧池中的一个槽位：预分配的图像缓冲 + 帧元数据
+ * @note 槽位由FramePool统一创建和回收，业务代码只通过FrameRef访问
+ */
+struct FrameSlot {
+    cv::Mat storage;   // 预分配的整块缓冲（生命周期内不变）
+    cv::Mat image;     // 当前有效图像（storage本身或其左上角ROI）
+    std::vector<unsigned char> jpeg;// MJPEG原始数据（仅灰度解码模式使用，供显示按需解码彩色）
+    size_t jpeg_capacity = 0;       // 取槽时jpeg的容量（commit时据此判断是否扩容）
+    int scale = 1;     // image相对原始分辨率的缩小倍数（DCT域缩放解码时>1）
+    long long seq = 0; // 帧序号（采集线程递增）
+    std::chrono::steady_clock::time_point capture_ts;// 采集时间戳
+    std::atomic<int> refs{0};// 引用计数，归零时回到空闲链表
+    FramePool* owner = nullptr;// 所属帧池
+    int index = 0;             // 在帧池中的下标
+};
+
+/**
+ * @class FrameRef
+ * @brief 帧槽位的引用计数句柄（可拷贝，拷贝时计数+1，析构时计数-1）
+ * @details 通过队列传递FrameRef只拷贝一个指针，不拷贝图像；
+ *          最后一个引用释放时槽位自动回到所属帧池，整个过程不分配堆内存
+ */
+class FrameRef {
+public:
+    FrameRef() = default;
+    FrameRef(const FrameRef& other);
+    FrameRef(FrameRef&& other) noexcept : slot_(other.slot_) { other.slot_ = nullptr; }
+    FrameRef& operator=(const FrameRef& other);
+    FrameRef& operator=(FrameRef&& other) noexcept;
+    ~FrameRef() { reset(); }
+
+    //释放引用（计数归零时槽位回收）
+    void reset();
+    //是否为空引用
+    bool empty() const { return slot_ == nullptr; }
+    //当前有效图像
+    cv::Mat& mat() const { return slot_->image; }
+    //帧序号
+    long long seq() const { return slot_->seq; }
+    //采集时间戳
+    std::chrono::steady_clock::time_point captureTime() const { return slot_->capture_ts; }
+    //MJPEG原始数据（为空表示非灰度解码模式）
+    std::vector<unsigned char>& jpeg() const { return slot_->jpeg; }
+    //image相对原始分辨率的缩小倍数
+    int scale() const { return slot_->scale; }
+    void setScale(int scale) const { slot_->scale = scale; }
+    //设置帧元数据（由生产者在写入图像后调用）
+    void setMeta(long long seq, std::chrono::steady_clock::time_point ts) const {
+        slot_->seq = seq;
+        slot_->capture_ts = ts;
+    }
+
+private:
+    explicit FrameRef(FrameSlot* slot) : slot_(slot) {}
+    FrameSlot* slot_ = nullptr;
+    friend class FramePool;
+};
+
+/**
+ * @class FramePool
+ * @brief 固定容量、引用计数的帧缓冲池
+ * @details 1. 构造时一次性分配全部槽位缓冲，运行期间循环复用
+ *          2. acquire()取空闲槽位，无空闲时返回空引用并计入exhausted（调用方丢帧）
+ *          3. 生产者写入后调用commit()核对缓冲地址/容量，若发生了重新分配则计入heap_allocs，
+ *             稳态下heap_allocs应保持为0
+ *          4. copyFrom()把任意尺寸的小图（如人脸区域）拷贝进槽位，超出槽位容量时等比缩小
+ *             （也可直接缩放到指定尺寸），不保留对原大图的引用
+ * @note FrameRef不得比所属FramePool活得更久
+ */
+class FramePool {
+public:
+    /**
+     * @param name 帧池名称（用于日志）
+     * @param slots 槽位数量
+     * @param rows 每个槽位的最大行数
+     * @param cols 每个槽位的最大列数
+     * @param type 像素类型（如CV_8UC3、CV_8UC1）
+     * @param jpeg_reserve 每个槽位预留的MJPEG原始数据容量（字节，0表示不使用）
+     */
+    FramePool(const std::string& name, size_t slots, int rows, int cols, int type,
+              size_t jpeg_reserve = 0);
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    //取一个空闲槽位（图像为整块缓冲），无空闲时返回空引用
+    FrameRef acquire();
+    //生产者写入图像后调用：核对图像是否仍在槽位缓冲中，否则计为一次堆分配
+    void commit(const FrameRef& ref);
+    //把src拷贝进新槽位（ROI视图→紧凑缓冲），超出容量时等比缩小；无空闲时返回空引用
+    //size非空时缩放到该尺寸（不超过槽位容量）
+    FrameRef copyFrom(const cv::Mat& src, cv::Size size = cv::Size());
+
+    //空闲槽位数
+    size_t freeCount();
+    //统计摘要（用于日志）
+    std::string summary();
+
+private:
+    void release(FrameSlot* slot);// 槽位引用归零时回收
+    friend class FrameRef;
+
+    std::string name_;                              // 帧池名称
+    std::vector<std::unique_ptr<FrameSlot>> slots_; // 全部槽位（地址稳定）
+    std::vector<int> free_;                         // 空闲槽位下标（容量预留，入栈出栈不分配）
+    std::mutex mtx_;                                // 保护free_
+
+    std::atomic<unsigned long long> acquires_{0};   // 成功取槽次数
+    std::atomic<unsigned long long> exhausted_{0};  // 无空闲槽位次数（丢帧）
+    std::atomic<unsigned long long> heap_allocs_{0};// 槽位缓冲被OpenCV重新分配的次数
+};
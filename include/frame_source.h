@@ -0,0 +1,166 @@
+#pragma once
+#include <opencv2/opencv.hpp>// OpenCV视频采集/图像读取
+#include <chrono>            // 回放节拍控制
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 回放节拍模式
+ * @details REALTIME：按源帧率节拍输出，模拟真实摄像头
+ *          FAST：不等待，尽可能快地输出（测量流水线吞吐上限）
+ */
+enum class ReplayMode { REALTIME, FAST };
+
+/**
+ * @class FrameSource
+ * @brief 帧源接口：屏蔽实时摄像头与录像回放的差异
+ * @details 采集线程、人脸采集工具只依赖此接口，因此可在无摄像头的机器上
+ *          用录像、图片目录或合成画面复现整条 采集→检测→识别 流水线
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    //打开帧源，失败返回false
+    virtual bool open() = 0;
+    //读取一帧（BGR），失败或已结束返回false
+    virtual bool read(cv::Mat& frame) = 0;
+    //跳过一帧（只出队不解码，空闲降频时使用），失败或已结束返回false
+    virtual bool skip() { return read(skip_buffer_); }
+    //释放帧源资源
+    virtual void release() {}
+    //帧源是否已播放完毕（实时摄像头永不结束）
+    virtual bool finished() const { return false; }
+    //是否为实时摄像头（实时源需要预热，回放源不需要）
+    virtual bool isLive() const { return false; }
+    //帧源描述（用于日志）
+    virtual std::string name() const = 0;
+    //能否直接提供MJPEG原始数据（open()之后有效）
+    virtual bool supportsJpeg() const { return false; }
+    //读取一帧MJPEG原始数据（不解码），不支持或失败返回false
+    virtual bool readJpeg(std::vector<unsigned char>& /*jpeg*/) { return false; }
+
+protected:
+    cv::Mat skip_buffer_;// 默认skip()实现的解码缓冲
+};
+
+/**
+ * @class V4L2FrameSource
+ * @brief 实时V4L2摄像头（MJPG格式，分辨率/帧率取自config.h）
+ * @details raw_mjpeg为true时关闭CAP_PROP_CONVERT_RGB，由调用方拿到MJPEG原始数据自行解码；
+ *          驱动不支持时自动退回OpenCV解码为BGR
+ */
+class V4L2FrameSource : public FrameSource {
+public:
+    explicit V4L2FrameSource(int device = 0, bool raw_mjpeg = false)
+        : device_(device), raw_mjpeg_(raw_mjpeg) {}
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    bool skip() override { return cap_.grab(); }// 只从驱动取出缓冲，不解码
+    void release() override { cap_.release(); }
+    bool isLive() const override { return true; }
+    std::string name() const override {
+        return "v4l2:" + std::to_string(device_) + (raw_mjpeg_ ? "(raw mjpeg)" : "");
+    }
+    bool supportsJpeg() const override { return raw_mjpeg_; }
+    bool readJpeg(std::vector<unsigned char>& jpeg) override;
+
+private:
+    int device_;          // 摄像头设备号
+    bool raw_mjpeg_;      // 是否输出MJPEG原始数据
+    cv::VideoCapture cap_;// OpenCV采集对象
+    cv::Mat raw_;         // 原始数据接收缓冲
+    std::vector<unsigned char> jpeg_;// read()在原始模式下的中转缓冲
+};
+
+/**
+ * @class ReplayFrameSource
+ * @brief 回放类帧源基类：统一实现实时节拍/极速两种回放模式
+ */
+class ReplayFrameSource : public FrameSource {
+public:
+    ReplayFrameSource(double fps, ReplayMode mode) : fps_(fps), mode_(mode) {}
+    bool finished() const override { return finished_; }
+
+protected:
+    //REALTIME模式下等待到第index帧的理论输出时刻，FAST模式直接返回
+    void pace();
+
+    double fps_;               // 回放帧率
+    ReplayMode mode_;          // 回放模式
+    bool finished_ = false;    // 是否已播放完毕
+    long long index_ = 0;      // 已输出帧数
+    std::chrono::steady_clock::time_point start_;// 第一帧输出时刻
+};
+
+/**
+ * @class VideoFileFrameSource
+ * @brief 录像文件回放（帧率取自文件，读取失败时使用REPLAY_DEFAULT_FPS）
+ */
+class VideoFileFrameSource : public ReplayFrameSource {
+public:
+    VideoFileFrameSource(const std::string& path, ReplayMode mode);
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    bool skip() override;
+    void release() override { cap_.release(); }
+    std::string name() const override { return "file:" + path_; }
+
+private:
+    std::string path_;    // 录像文件路径
+    cv::VideoCapture cap_;// OpenCV解码对象
+};
+
+/**
+ * @class ImageDirFrameSource
+ * @brief 图片目录回放（按文件名排序逐张输出，支持jpg/png/bmp）
+ */
+class ImageDirFrameSource : public ReplayFrameSource {
+public:
+    ImageDirFrameSource(const std::string& dir, ReplayMode mode);
+    bool open() override;
+    bool read(cv::Mat& frame) override;
+    bool skip() override;
+    std::string name() const override { return "dir:" + dir_; }
+    //目录中全部为JPEG图片时可直接提供原始数据（模拟MJPEG摄像头）
+    bool supportsJpeg() const override { return all_jpeg_; }
+    bool readJpeg(std::vector<unsigned char>& jpeg) override;
+
+private:
+    std::string dir_;               // 图片目录
+    std::vector<std::string> files_;// 排序后的图片路径列表
+    size_t next_ = 0;               // 下一张图片下标
+    bool all_jpeg_ = false;         // 是否全部为JPEG图片
+};
+
+/**
+ * @class SyntheticFrameSource
+ * @brief 合成画面生成器：渐变背景上移动的椭圆“人脸”，内容由帧号决定，可完全复现
+ * @note total_frames为0表示无限生成
+ */
+class SyntheticFrameSource : public ReplayFrameSource {
+public:
+    SyntheticFrameSource(long long total_frames, ReplayMode mode);
+    bool open() override { return true; }
+    bool read(cv::Mat& frame) override;
+    bool skip() override;
+    std::string name() const override { return "synthetic:" + std::to_string(total_frames_); }
+
+private:
+    long long total_frames_;// 总帧数（0=无限）
+    cv::Mat background_;    // 预先生成的渐变背景
+};
+
+/**
+ * @brief 根据描述字符串创建帧源
+ * @param spec 帧源描述：
+ *             "v4l2:<设备号>"      实时摄像头（默认 v4l2:0）
+ *             "file:<录像路径>"    录像回放
+ *             "dir:<图片目录>"     图片目录回放
+ *             "synthetic[:<帧数>]" 合成画面
+ *             不带前缀时按路径自动识别（目录→dir，文件→file）
+ * @param mode 回放模式（对实时摄像头无效）
+ * @return 帧源对象，描述无法识别时返回nullptr
+ */
+std::unique_ptr<FrameSource> createFrameSource(const std::string& spec,
+                                               ReplayMode mode = ReplayMode::REALTIME);
@@ -1,19 +1,64 @@
 #ifndef GPIO_CONTROL_H
 #define GPIO_CONTROL_H
 
-//初始化GPIO芯片和门禁/蜂鸣器引脚
-bool gpioInit();
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
-//设置指定BCM引脚的输出电平
-bool gpioSetValue(int pin_bcm, int value);
+/**
+ * @class GpioBackend
+ * @brief GPIO输出后端接口：libgpiod真实芯片，或无硬件时的模拟芯片
+ * @note 只由执行机构线程调用，实现不要求线程安全
+ */
+class GpioBackend {
+public:
+    virtual ~GpioBackend() = default;
+    //申请输出引脚（BCM编号）并设置初始电平
+    virtual bool init(const std::vector<int>& pins, const std::vector<int>& initial) = 0;
+    //设置指定BCM引脚的输出电平
+    virtual bool setValue(int pin_bcm, int value) = 0;
+    //释放全部引脚
+    virtual void cleanup() = 0;
+    //后端名称（用于日志）
+    virtual std::string name() const = 0;
+};
 
-//门禁开门逻辑：控制继电器通电2秒后断电
-void openDoorDelay();
+//模拟芯片记录的一次电平翻转
+struct GpioEdge {
+    int pin;    // BCM引脚
+    int value;  // 新电平
+    std::chrono::steady_clock::time_point ts;// 翻转时刻
+};
 
-//报警逻辑：控制蜂鸣器响0.5秒后停止
-void alarmBeep();
+/**
+ * @class SimGpioBackend
+ * @brief 模拟GPIO芯片：不访问硬件，记录每次电平翻转及时刻
+ * @details 用于没有/dev/gpiochip0的机器：门禁主程序照常运行，性能测试据此测量判定→引脚翻转的延迟、
+ *          脉冲宽度误差；电平未变化的写入不计为翻转
+ * @note edges()可在其他线程调用（内部加锁）
+ */
+class SimGpioBackend : public GpioBackend {
+public:
+    bool init(const std::vector<int>& pins, const std::vector<int>& initial) override;
+    bool setValue(int pin_bcm, int value) override;
+    void cleanup() override;
+    std::string name() const override { return "sim"; }
 
-//清理GPIO资源
-void gpioCleanup();
+    //取出并清空已记录的翻转
+    std::vector<GpioEdge> takeEdges();
+    //引脚当前电平（未申请的引脚为-1）
+    int value(int pin_bcm);
 
-#endif // GPIO_CONTROL_H
\ No newline at end of file
+private:
+    std::mutex mtx_;                          // 保护以下成员
+    std::vector<std::pair<int, int>> levels_; // 引脚 → 当前电平
+    std::vector<GpioEdge> edges_;             // 已记录的翻转
+};
+
+//根据描述字符串创建GPIO后端："gpiod[:<芯片设备>]" | "sim"，无法识别时返回nullptr
+//（libgpiod后端只在gpio_control.cpp中定义，只用模拟芯片的程序不必链接gpiod）
+std::unique_ptr<GpioBackend> createGpioBackend(const std::string& spec);
+
+#endif // GPIO_CONTROL_H
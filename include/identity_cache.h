@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include "config.h"
+#include "face_batch.h"// FaceState
+
+//一次识别结果在轨迹上产生的判定
+enum class TrackVerdict {
+    NONE,      // 尚无结论（继续投票）或复核通过
+    CONFIRMED, // 本轨迹确认为已登记用户（开门）
+    REJECTED,  // 本轨迹判定为未知人脸（报警，每条轨迹只产生一次）
+    REVOKED,   // 已确认的轨迹复核未通过，撤销确认并重新投票
+};
+
+/**
+ * @class IdentityCache
+ * @brief 按轨迹缓存身份：多帧投票判定，确认后跳过识别，只定期复核
+ * @details 1. 每条轨迹保留最近VOTE_WINDOW次识别结果；同一用户ID成功VOTE_CONFIRM次即确认，
+ *             失败VOTE_REJECT次即判定为未知人脸。单帧误识别/模糊帧不再直接触发开门或报警
+ *          2. 已确认的轨迹在TRACK_REVERIFY_MS内跳过识别，直接沿用确认结果；到期后识别一次复核，
+ *             结果不一致则撤销确认（防止确认后换人仍沿用旧身份）
+ *          3. 开门/报警每条轨迹各只触发一次，人站在门前不再反复开门
+ *          4. 统计实际预测次数与缓存跳过次数，用于评估节省的识别开销
+ * @note 非线程安全，只在识别线程中使用
+ */
+class IdentityCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //该轨迹的人脸是否需要识别；已确认且未到复核时间时返回false，label输出确认的用户ID
+    bool needsPredict(int track_id, Clock::time_point now, int& label);
+    //记录一次识别结果（label为-1或accepted为false表示识别失败），返回本次产生的判定
+    TrackVerdict addResult(int track_id, int label, bool accepted, Clock::time_point now);
+    //轨迹当前状态：已确认→ACCEPTED，已判定未知→REJECTED，其余→PENDING
+    FaceState state(int track_id) const;
+    //已确认轨迹的用户ID（未确认为-1）
+    int label(int track_id) const;
+    //轨迹的投票进度（窗口内与最近结果相同的票数）
+    int votes(int track_id) const;
+    //移除超过TRACK_CACHE_TTL_MS未出现的轨迹
+    void expire(Clock::time_point now);
+
+    //实际识别次数
+    unsigned long long predicts() const { return predicts_; }
+    //缓存跳过的识别次数
+    unsigned long long skipped() const { return skipped_; }
+    //统计摘要（seconds为统计时长，用于计算每秒节省的识别次数）
+    std::string summary(double seconds) const;
+
+private:
+    struct Entry {
+        std::array<int, VOTE_WINDOW> window{};// 最近的识别结果（用户ID，-1为失败），循环写入
+        int filled = 0;           // 窗口中有效结果数
+        int next = 0;             // 下一个写入位置
+        bool confirmed = false;   // 是否已确认
+        bool alarmed = false;     // 是否已判定为未知人脸
+        int label = -1;           // 确认的用户ID
+        Clock::time_point last_seen;    // 最近一次出现
+        Clock::time_point last_verified;// 最近一次确认/复核通过
+    };
+    //窗口中等于label的票数
+    static int count(const Entry& e, int label);
+
+    std::unordered_map<int, Entry> entries_;// 轨迹ID → 缓存项
+    unsigned long long predicts_ = 0, skipped_ = 0;// 实际识别/跳过次数
+    unsigned long long confirms_ = 0, alarms_ = 0; // 确认/报警的轨迹数
+    unsigned long long reverifies_ = 0, revokes_ = 0;// 复核次数/撤销次数
+};
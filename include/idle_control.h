@@ -0,0 +1,55 @@
+#pragma once
+#include <opencv2/opencv.hpp>// 降采样/帧差
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "config.h"
+
+/**
+ * @class MotionGate
+ * @brief 低成本运动检测：把亮度图降采样到MOTION_GRID尺寸后与上一帧做帧差
+ * @details 80x60的帧差开销远小于一次Haar检测，用于在空闲状态下判断画面是否静止
+ * @note 非线程安全，只在检测线程中使用；内部缓冲复用，稳态下不分配内存
+ */
+class MotionGate {
+public:
+    //输入亮度图（未均衡化的灰度图），返回与上一帧相比是否有运动；第一帧视为有运动
+    bool update(const cv::Mat& luma);
+
+private:
+    cv::Mat small_, prev_, diff_;// 降采样图、上一帧降采样图、帧差图
+};
+
+/**
+ * @class IdleController
+ * @brief 空闲状态机：活跃(ACTIVE) ⇄ 空闲(IDLE)
+ * @details 1. 活跃：每帧都做人脸检测；连续IDLE_TIMEOUT_MS没有检出人脸时进入空闲
+ *          2. 空闲：采集线程每IDLE_FRAME_SKIP帧只处理1帧，检测线程只做帧差，静止画面跳过检测
+ *          3. 空闲状态下出现运动：当帧立即恢复活跃并执行检测，采集线程下一帧恢复全速
+ *          4. 统计两种状态各自的累计时长
+ * @note isIdle()可被采集线程并发读取，其余接口只在检测线程中调用
+ */
+class IdleController {
+public:
+    explicit IdleController(int timeout_ms = IDLE_TIMEOUT_MS);
+
+    //当前是否处于空闲状态（采集线程据此降低处理帧率）
+    bool isIdle() const { return idle_.load(std::memory_order_relaxed); }
+    //检测线程每取到一帧调用：motion为本帧是否有运动，返回本帧是否需要执行人脸检测
+    bool onFrame(bool motion);
+    //检测线程完成一帧人脸检测后调用
+    void onDetectResult(bool has_face);
+    //统计摘要（各状态累计时长、切换次数、跳过检测帧数）
+    std::string summary();
+
+private:
+    void switchTo(bool idle);// 切换状态并累计上一状态时长
+
+    std::chrono::milliseconds timeout_;                   // 进入空闲的无人脸时长
+    std::atomic<bool> idle_{false};                       // 当前是否空闲
+    std::chrono::steady_clock::time_point last_face_;     // 最近一次检出人脸（或被运动唤醒）的时刻
+    std::chrono::steady_clock::time_point state_since_;   // 当前状态的开始时刻
+    double active_sec_ = 0.0, idle_sec_ = 0.0;            // 各状态累计时长（秒）
+    unsigned long long transitions_ = 0;                  // 状态切换次数
+    unsigned long long skipped_ = 0;                      // 因画面静止跳过检测的帧数
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+#include "safe_queue.h"
+
+//出入记录的判定类型
+enum class JournalVerdict : uint8_t {
+    CONFIRMED = 1,// 确认为已登记用户（开门）
+    REJECTED = 2, // 判定为未知人脸（报警）
+    REVOKED = 3,  // 已确认的轨迹复核未通过
+};
+
+/**
+ * @brief 索引文件中的一条记录（定长32字节，按追加顺序即时间顺序存放）
+ */
+struct JournalEntry {
+    int64_t ts_ms;        // 判定时刻（墙上时间，毫秒，自1970年）
+    int32_t label;        // 用户ID（未知为-1）
+    int32_t track_id;     // 轨迹ID
+    float confidence;     // 置信度（LBPH距离，越小越相似）
+    uint8_t verdict;      // JournalVerdict
+    uint8_t reserved[3];  // 保留（写0）
+    uint32_t thumb_offset;// 缩略图在.dat中的偏移
+    uint32_t thumb_size;  // 缩略图字节数（0表示无缩略图）
+};
+static_assert(sizeof(JournalEntry) == 32, "JournalEntry应为32字节");
+
+/**
+ * @brief 用户ID索引（.lbl）中的一条记录：按(用户ID, 段内序号)排序，封段时写出
+ */
+struct JournalLabelRef {
+    int32_t label;  // 用户ID
+    uint32_t index; // 段内序号
+};
+static_assert(sizeof(JournalLabelRef) == 8, "JournalLabelRef应为8字节");
+
+/**
+ * @class JournalWriter
+ * @brief 出入记录的异步追加写入：识别线程只入队，后台线程编码缩略图并写盘
+ * @details 1. 每段由两个文件组成：seg_<首条毫秒时间戳>.idx（文件头 + 定长JournalEntry）和
+ *             seg_<同上>.dat（缩略图JPEG依次拼接）；先写缩略图再写索引，索引中出现的记录其缩略图一定完整；
+ *             段文件只新建不覆盖，同名段已存在时段名加后缀 seg_<时间戳>_<n>；
+ *             封段（轮转或停止）时另写 seg_<同上>.lbl 用户ID索引，按用户查询时不必逐条扫描
+ *          2. 单段超过JOURNAL_SEGMENT_BYTES时新开一段；全部段超过JOURNAL_MAX_BYTES时删除最旧的段（正在写的段除外）
+ *          3. 段内时间戳单调不减（查询按时间二分）：墙上时钟小幅回退时沿用段内上一条的时间，
+ *             回拨超过JOURNAL_CLOCK_STEP_MS时新开一段
+ *          4. 队列满时丢弃并计数，识别线程永不等待磁盘
+ * @note append()可在任意线程调用
+ */
+class JournalWriter {
+public:
+    //queue_size为写入队列容量（队列满时丢弃）
+    explicit JournalWriter(const std::string& dir = JOURNAL_DIR, size_t queue_size = JOURNAL_QUEUE_SIZE);
+    ~JournalWriter() { stop(); }
+
+    //创建目录并启动写入线程，失败返回false
+    bool start();
+    //写完队列中剩余的记录后停止
+    void stop();
+    //追加一条记录（face为人脸灰度图，可为空；缩放为缩略图后入队），队列满返回false
+    bool append(JournalVerdict verdict, int label, double confidence, int track_id, const cv::Mat& face);
+    //统计摘要（用于日志）
+    std::string summary() const;
+    //已写入/丢弃的记录数
+    unsigned long long written() const { return written_.load(); }
+    unsigned long long dropped() const { return dropped_.load(); }
+
+private:
+    struct Pending {
+        JournalEntry entry;  // 记录（偏移由写入线程填写）
+        cv::Mat thumb;       // 缩略图（未编码）
+    };
+    void run();
+    bool openSegment(int64_t first_ts);// 新开一段
+    void closeSegment(bool sync);      // 封段：关闭当前段并写出用户ID索引（sync为true时先落盘）
+    void enforceBudget();              // 删除最旧的段直到总大小不超过上限
+
+    std::string dir_;                  // 记录目录
+    SafeQueue<Pending> queue_;         // 写入队列
+    std::thread thread_;               // 写入线程
+    std::atomic<bool> started_{false}; // 是否已启动
+    int idx_fd_ = -1, dat_fd_ = -1;    // 当前段的文件
+    long segment_bytes_ = 0;           // 当前段大小（索引+缩略图）
+    long idx_bytes_ = 0;               // 当前段索引文件大小（文件头+完整记录）
+    uint32_t dat_bytes_ = 0;           // 当前段缩略图文件大小（下一张缩略图的偏移）
+    int64_t last_ts_ = INT64_MIN;      // 当前段最后一条记录的时间戳
+    std::string segment_;              // 当前段名（删除旧段时跳过）
+    std::vector<JournalLabelRef> label_refs_;// 当前段的用户ID索引（封段时排序写出）
+    std::vector<unsigned char> jpeg_;  // 缩略图编码缓冲（复用）
+    std::atomic<unsigned long long> written_{0}, dropped_{0}, segments_{0}, evicted_{0};// 写入/丢弃/新开段/删除段
+};
+
+/**
+ * @class JournalReader
+ * @brief 出入记录查询：只读映射各段索引，按时间二分查找，再按用户ID/判定类型过滤
+ * @details 段按首条时间排序；查询先跳过时间范围不相交的段，段内用二分找到起点，
+ *          扫描到终点为止，只访问落在范围内的索引页；
+ *          按用户ID查询时，已封段的段先在用户ID索引中取该用户的记录序号再按时间二分，
+ *          正在写入（未封段）的段退回逐条过滤
+ */
+class JournalReader {
+public:
+    //查询结果中的一条记录
+    struct Hit {
+        std::string segment;// 段名（seg_<时间戳>）
+        uint32_t index;     // 段内序号
+        JournalEntry entry; // 记录
+    };
+    //查询条件（label=INT32_MIN表示不限用户，verdict=0表示不限类型）
+    struct Query {
+        int64_t from_ms = INT64_MIN;
+        int64_t to_ms = INT64_MAX;   // 不含
+        int32_t label = INT32_MIN;
+        uint8_t verdict = 0;
+    };
+
+    //打开记录目录并映射全部段索引，目录不存在返回false
+    bool open(const std::string& dir = JOURNAL_DIR);
+    //按条件依次回调命中的记录（回调返回false时停止），返回命中数
+    size_t query(const Query& q, const std::function<bool(const Hit&)>& on_hit) const;
+    //读取一条记录的缩略图（JPEG字节），无缩略图或读取失败返回false
+    bool thumbnail(const std::string& segment, uint32_t index, std::vector<unsigned char>& jpeg) const;
+    //段数 / 记录总数 / 磁盘占用（字节）
+    size_t segments() const { return segments_.size(); }
+    size_t entries() const;
+    long long bytes() const { return bytes_; }
+
+private:
+    struct Segment {
+        std::string name;                  // 段名
+        std::shared_ptr<const void> map;   // 索引文件映射（释放时munmap）
+        const JournalEntry* entries = nullptr;// 记录数组（跳过文件头）
+        size_t count = 0;                  // 完整记录数（末尾写了一半的记录忽略）
+        std::shared_ptr<const void> label_map;      // 用户ID索引映射（未封段时为空）
+        const JournalLabelRef* label_refs = nullptr;// 按用户ID排序的count条索引（跳过文件头）
+    };
+    static void mapLabels(const std::string& path, Segment& s);// 映射段的用户ID索引（缺失或不一致时跳过）
+    std::string dir_;                  // 记录目录
+    std::vector<Segment> segments_;        // 按首条时间排序
+    long long bytes_ = 0;                  // 全部段文件大小
+};
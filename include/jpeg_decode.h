@@ -0,0 +1,22 @@
+#pragma once
+#include <opencv2/opencv.hpp>// cv::Mat 输出缓冲
+#include <cstddef>
+
+/**
+ * @brief MJPEG帧直接解码为灰度图（只解码亮度平面）
+ * @details 基于libjpeg：输出色彩空间设为灰度时，解码器跳过色度分量的反DCT与颜色转换；
+ *          scale_denom>1时在DCT域直接缩小（1/2、1/4、1/8），解码计算量随之按面积下降
+ * @param data JPEG数据
+ * @param size JPEG数据长度（字节）
+ * @param gray 输出灰度图（尺寸/类型一致时复用其缓冲，不重新分配）
+ * @param scale_denom 缩放分母（1/2/4/8）
+ * @return 解码成功返回true，数据损坏返回false
+ */
+bool decodeJpegGray(const unsigned char* data, size_t size, cv::Mat& gray, int scale_denom = 1);
+
+/**
+ * @brief 计算按scale_denom缩放后的输出尺寸（与libjpeg的向上取整规则一致）
+ */
+inline cv::Size jpegScaledSize(int width, int height, int scale_denom) {
+    return cv::Size((width + scale_denom - 1) / scale_denom, (height + scale_denom - 1) / scale_denom);
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cfloat>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "config.h"
+
+/**
+ * @class LbphEngine
+ * @brief 自研LBPH人脸识别引擎，替代cv::face::LBPHFaceRecognizer
+ * @details 1. 模型文件与OpenCV的lbph_model.yml互相兼容（读写同一格式，顶层节点opencv_lbphfaces）
+ *          2. LBP编码按(半径,邻域数)编译期特化（常用的(1,8)/(2,8)），邻域循环完全展开、
+ *             一次遍历算出全部位；其他参数走通用实现。编码规则与OpenCV elbp逐位一致
+ *          3. 可选统一模式（LBPH_UNIFORM_PATTERNS）：编码经constexpr查找表映射为N*(N-1)+3个
+ *             统一模式，直方图缩小4倍，但与OpenCV模型不兼容，需要重新训练
+ *          4. 全部训练直方图存放在一块LBPH_ALIGN字节对齐的连续矩阵中，行长补齐到对齐宽度（补0）
+ *          5. 卡方距离（HISTCMP_CHISQR_ALT）按编译目标向量化：AVX/SSE（x86）、NEON（ARM），
+ *             其余平台为标量实现；分块单精度累加、块间双精度累加，与OpenCV的差异在1e-5量级
+ *          6. predictBatch对画廊只扫描一遍，批次内全部人脸共享
+ *          7. 画廊索引（先粗后精）：身份数达到LBPH_INDEX_MIN_IDENTITIES时启用。每个身份取样本均值作为质心，
+ *             质心再用k-means聚成约√身份数个簇；预测依次比较 簇中心 → 最近LBPH_INDEX_PROBE_CLUSTERS个簇内
+ *             的身份质心 → 最近LBPH_INDEX_TOP_K个身份的全部样本，比较次数约为O(√身份数)
+ *          8. 卡方距离的每一项非负，部分和达到当前第k近的距离即提前放弃（全量扫描同样使用，结果不变）
+ *          9. 二进制模型格式（readBinary/writeBinary）：带版本号和校验和，直方图按LBPH_ALIGN对齐存放，
+ *             画廊索引（质心、簇）一并保存；加载时只读映射（mmap）后原地使用，不解析文本、不复制直方图、
+ *             不重建索引
+ * @note 内部有计算缓冲，不是线程安全的，只在识别线程中使用
+ */
+class LbphEngine {
+public:
+    //画廊搜索方式
+    enum class SearchMode {
+        AUTO,       // 身份数≥LBPH_INDEX_MIN_IDENTITIES时用索引，否则全量扫描
+        EXHAUSTIVE, // 全量扫描（结果与OpenCV相同）
+        INDEXED,    // 先粗后精（质心初筛+候选身份精排）
+    };
+
+    //参数含义与LBPHFaceRecognizer::create相同；uniform为true时使用统一模式直方图
+    explicit LbphEngine(int radius = 1, int neighbors = 8, int grid_x = 8, int grid_y = 8,
+                        double threshold = DBL_MAX, bool uniform = LBPH_UNIFORM_PATTERNS);
+
+    //按文件内容自动识别格式加载（二进制→readBinary，否则→read），失败返回false（原有内容不变）
+    bool load(const std::string& path);
+    //按扩展名选择格式保存（.yml/.yaml/.xml→write，否则→writeBinary）
+    bool save(const std::string& path) const;
+    //读取lbph_model.yml格式的模型，失败返回false（原有内容不变）
+    bool read(const std::string& path);
+    //保存为lbph_model.yml格式（OpenCV可直接读取，统一模式除外）
+    bool write(const std::string& path) const;
+    //只读映射二进制模型并原地使用，格式/版本/校验和不符返回false（原有内容不变）
+    bool readBinary(const std::string& path);
+    //保存为二进制模型（先写临时文件再rename，替换过程中读者不会看到半个文件）
+    bool writeBinary(const std::string& path) const;
+    //文件是否为二进制模型（只检查文件头标识）
+    static bool isBinaryModel(const std::string& path);
+    //用人脸灰度图及其用户ID训练（替换原有画廊），样本为空或参数不支持返回false
+    //workers>1时直方图由workers个线程分段计算（每个线程使用独立的LBP编码缓冲），结果与单线程相同
+    bool train(const std::vector<cv::Mat>& images, const std::vector<int>& labels, int workers = 1);
+    //直接设置画廊：count个直方图（每个histSize()个浮点数，相邻两个相隔hist_stride个），替换原有画廊
+    //count为0时为空画廊（保存后门禁程序加载为"无登记用户"，所有人脸判定为未知）
+    bool assign(const float* hists, size_t hist_stride, const int* labels, int count);
+    //是否尚无训练样本
+    bool empty() const { return samples_ == 0; }
+
+    //计算一张人脸的空间直方图，写入hist（长度histSize()，超出部分不改动）
+    void computeHistogram(const cv::Mat& face, float* hist);
+    /**
+     * @brief 批量预测
+     * @param faces 人脸灰度图数组
+     * @param count 人脸数
+     * @param labels 输出：每张人脸的用户ID（距离均不小于阈值时为-1）
+     * @param confs 输出：每张人脸的最小距离（越小越相似）
+     */
+    void predictBatch(const cv::Mat* faces, int count, int* labels, double* confs);
+    //单张预测（等价于count=1的predictBatch）
+    void predict(const cv::Mat& face, int& label, double& conf) { predictBatch(&face, 1, &label, &conf); }
+    //按已计算好的直方图批量预测（probes为count行、行长stride()的对齐缓冲，count≤MAX_FACES_PER_FRAME）
+    void predictHistograms(const float* probes, int count, int* labels, double* confs);
+
+    //设置画廊搜索方式（默认AUTO）
+    void setSearchMode(SearchMode mode) { mode_ = mode; }
+    //设置索引展开比较的簇数（默认LBPH_INDEX_PROBE_CLUSTERS，越大越准、越慢）
+    void setProbeClusters(int clusters);
+    //当前是否使用索引
+    bool indexed() const;
+    //不同的用户ID数
+    int identities() const { return identities_; }
+
+    //训练样本数
+    int samples() const { return samples_; }
+    //直方图有效长度（网格数×每格模式数）
+    int histSize() const { return hist_size_; }
+    //画廊行长（浮点数个数，≥histSize()，补齐到对齐宽度）
+    size_t stride() const { return stride_; }
+    //第i个训练直方图
+    const float* histogram(int i) const { return gallery_ + i * stride_; }
+    //第i个训练样本的用户ID
+    int label(int i) const { return labels_[i]; }
+    int radius() const { return radius_; }
+    int neighbors() const { return neighbors_; }
+    int gridX() const { return grid_x_; }
+    int gridY() const { return grid_y_; }
+    double threshold() const { return threshold_; }
+    bool uniform() const { return uniform_; }
+    //画廊是否直接映射自二进制模型文件
+    bool mapped() const { return mapping_ != nullptr; }
+    //卡方距离使用的指令集（用于日志/测试报告）
+    static const char* simdName();
+
+private:
+    struct AlignedFree {
+        void operator()(float* p) const { std::free(p); }
+    };
+    using AlignedFloats = std::unique_ptr<float, AlignedFree>;
+    //分配count行对齐缓冲（补齐部分清零）
+    AlignedFloats allocRows(int count) const;
+    //根据当前参数重新计算hist_size_/stride_，参数不支持返回false
+    bool configure();
+    //按用户ID分组样本，计算每个身份的质心直方图并聚类
+    void buildIndex();
+    //对身份质心做k-means聚类（簇中心写入clusters_，成员写入cluster_ids_）
+    void clusterIdentities();
+    //采用二进制模型中保存的索引（base为映射首地址，header为文件头），索引不完整或不一致返回false
+    bool adoptIndex(const unsigned char* base, const void* header);
+    //全量扫描（画廊在外层，批次共享）
+    void scanExhaustive(const float* probes, int count, int* labels, double* confs);
+    //先粗后精
+    void scanIndexed(const float* probes, int count, int* labels, double* confs);
+
+    int radius_;              // LBP半径
+    int neighbors_;           // LBP邻域数
+    int grid_x_;              // 水平网格数
+    int grid_y_;              // 垂直网格数
+    double threshold_;        // 距离阈值（OpenCV默认DBL_MAX）
+    bool uniform_;            // 是否统一模式
+    int hist_size_ = 0;       // 直方图有效长度
+    size_t stride_ = 0;       // 画廊行长（浮点数个数）
+    int samples_ = 0;         // 训练样本数
+    AlignedFloats storage_;   // 画廊存储（本引擎分配时持有）
+    std::shared_ptr<const void> mapping_;// 二进制模型的只读映射（从映射加载时持有，释放时munmap）
+    const float* gallery_ = nullptr;// 画廊首地址（samples_×stride_，指向storage_或mapping_）
+    std::vector<int> labels_; // 每个训练样本的用户ID
+    cv::Mat lbp_;             // LBP编码图缓冲（复用）
+    AlignedFloats probes_;    // 批次人脸直方图缓冲（MAX_FACES_PER_FRAME行）
+
+    SearchMode mode_ = SearchMode::AUTO;// 画廊搜索方式
+    int identities_ = 0;          // 身份数
+    AlignedFloats centroid_storage_;// 质心存储（本引擎计算索引时持有）
+    const float* centroids_ = nullptr;// 每个身份的质心直方图（identities_×stride_，指向centroid_storage_或mapping_）
+    std::vector<int> id_begin_;   // 第i个身份的样本在order_中的范围[id_begin_[i], id_begin_[i+1])
+    std::vector<int> order_;      // 按身份分组的样本下标
+    int probe_clusters_ = LBPH_INDEX_PROBE_CLUSTERS;// 展开比较的簇数
+    int clusters_count_ = 0;      // 簇数
+    AlignedFloats cluster_storage_;// 簇中心存储（本引擎计算索引时持有）
+    const float* clusters_ = nullptr;// 簇中心直方图（clusters_count_×stride_，指向cluster_storage_或mapping_）
+    std::vector<int> cluster_begin_;// 第c个簇的身份在cluster_ids_中的范围
+    std::vector<int> cluster_ids_;// 按簇分组的身份下标
+    std::vector<std::pair<double, int>> near_clusters_;// 每张人脸最近的簇（probe_clusters_个：距离、簇）
+    std::vector<std::pair<double, int>> candidates_;// 每张人脸最近的身份（LBPH_INDEX_TOP_K个：距离、身份）
+};
+
+//卡方距离（HISTCMP_CHISQR_ALT）：2 * Σ (a-b)² / (a+b)，a+b为0的项跳过（SIMD实现）
+//部分和达到bound时提前返回（返回值≥bound，调用方据此判定“不优于当前最优”）
+double chiSquareAlt(const float* a, const float* b, size_t n, double bound = DBL_MAX);
+//同上，标量实现（双精度逐项累加，与OpenCV compareHist相同，用于校验）
+double chiSquareAltScalar(const float* a, const float* b, size_t n);
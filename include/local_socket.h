@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+/**
+ * @brief 按端点描述创建本机监听套接字（指标端点、预览流共用）
+ * @param spec tcp:<回环地址>:<端口> | unix:<套接字路径>
+ * @param unix_path 输出：Unix套接字路径（退出时由调用方unlink；TCP时为空）
+ * @return 已listen的套接字，描述无效、TCP地址不是回环地址（127.0.0.0/8）、路径已被非套接字文件占用
+ *         或创建/绑定失败返回-1
+ * @note Unix套接字绑定前先删除上次异常退出残留的同名套接字（只删除套接字类型的文件）
+ */
+int openLocalListener(const std::string& spec, std::string& unix_path);
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "safe_queue.h"
+
+//一条日志记录最多携带的参数个数
+constexpr int LOG_MAX_ARGS = 6;
+//一个文本槽最多存放的文本字节数（更长的文本由调用方拆成多条）
+constexpr size_t LOG_TEXT_BYTES = 254;
+
+/**
+ * @brief 定长二进制日志记录（64字节）：时间戳、事件ID、参数，格式化推迟到日志线程
+ * @details 参数统一存为8字节，types的第i位为1表示第i个参数是double，否则为整数；
+ *          文本事件不带参数，文本存放在LogRing的定长文本槽中，text为槽号+1
+ */
+struct LogRecord {
+    int64_t ts_ns = 0;    // 墙上时间（纳秒，自1970年）
+    uint16_t event = 0;   // 事件ID（LogEvent）
+    uint8_t argc = 0;     // 参数个数
+    uint8_t types = 0;    // 各参数类型位
+    uint32_t text = 0;    // 文本槽号+1（0表示不带文本）
+    union Arg {
+        int64_t i;
+        double d;
+    } args[LOG_MAX_ARGS];
+};
+static_assert(sizeof(LogRecord) == 64, "LogRecord应为64字节");
+
+/**
+ * @class LogRing
+ * @brief 有界多生产者/多消费者无锁环形缓冲（每个槽位带序号，Vyukov算法）
+ * @details 1. 生产者用一次CAS占位，写入记录后发布序号；没有锁，也不唤醒消费者
+ *          2. 缓冲满时push立即返回false并计入丢弃数，生产者永不等待
+ *          3. 消费者（日志线程）轮询pop，空时自行休眠
+ *          4. 文本记录的文本拷贝到预先分配的定长文本槽（空闲槽号放在无锁队列中），pop时取出文本并归还槽；
+ *             槽用完时同缓冲满一样丢弃，运行中不分配内存，没有日志线程时也不会泄漏
+ * @note 容量必须是2的幂
+ */
+class LogRing {
+public:
+    explicit LogRing(size_t capacity, size_t text_slots = 0)
+        : cells_(capacity), mask_(capacity - 1), texts_(text_slots), free_texts_(text_slots) {
+        for (size_t i = 0; i < capacity; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+        for (size_t i = 0; i < text_slots; i++) free_texts_.push(static_cast<uint32_t>(i));
+    }
+
+    //写入一条记录，缓冲满时返回false
+    bool push(const LogRecord& rec) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);// 缓冲满
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);// 被其他生产者抢先
+            }
+        }
+        cell->rec = rec;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //写入一条带文本的记录（文本拷贝到文本槽，超过LOG_TEXT_BYTES的部分截掉），缓冲满或文本槽用完时返回false
+    bool pushText(LogRecord rec, const char* text, size_t len) {
+        uint32_t slot;
+        if (!free_texts_.try_pop(slot)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        TextSlot& t = texts_[slot];
+        t.size = static_cast<uint16_t>(std::min(len, LOG_TEXT_BYTES));
+        memcpy(t.data, text, t.size);
+        rec.text = slot + 1;
+        if (push(rec)) return true;
+        free_texts_.push(slot);
+        return false;
+    }
+
+    //取出一条记录，缓冲空时返回false；带文本的记录把文本写入*text（text为空时丢弃文本）并归还文本槽
+    bool pop(LogRecord& rec, std::string* text = nullptr) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;// 缓冲空（或生产者尚未发布）
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        rec = cell->rec;
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        if (rec.text != 0) {
+            const TextSlot& t = texts_[rec.text - 1];
+            if (text) text->assign(t.data, t.size);
+            free_texts_.push(rec.text - 1);
+        }
+        return true;
+    }
+
+    //因缓冲满丢弃的记录数
+    unsigned long long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    //容量
+    size_t capacity() const { return cells_.size(); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;// 槽位序号：=pos可写，=pos+1可读
+        LogRecord rec;
+    };
+    struct TextSlot {
+        uint16_t size;              // 文本字节数
+        char data[LOG_TEXT_BYTES];  // 文本（不含结尾0）
+    };
+    std::vector<Cell> cells_;
+    size_t mask_;
+    std::vector<TextSlot> texts_;       // 文本槽
+    MpmcQueue<uint32_t> free_texts_;    // 空闲文本槽号
+    alignas(64) std::atomic<size_t> tail_{0};  // 生产者位置（独占缓存行，避免与消费者伪共享）
+    alignas(64) std::atomic<size_t> head_{0};  // 消费者位置
+    alignas(64) std::atomic<unsigned long long> dropped_{0};// 丢弃数
+};
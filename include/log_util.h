@@ -1,7 +1,68 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <string>
-#include "safe_queue.h"
+#include <type_traits>
+#include "config.h"
+#include "log_ring.h"
 
-extern SafeQueue<std::string> g_log_queue;// 声明全局的日志队列
+/**
+ * @brief 日志事件ID：每个事件对应日志线程中的一条格式串（{}依次替换为参数）
+ * @note 新增事件时在log_util.cpp的格式表中按相同顺序添加格式串
+ */
+enum class LogEvent : uint16_t {
+    TEXT,             // 任意文本（postLog，冷路径：启动/停止/统计等）
+    RECOG_CONFIRMED,  // 帧号、轨迹、用户ID、置信度、票数、延迟ms
+    RECOG_REJECTED,   // 帧号、轨迹、置信度、票数、延迟ms
+    RECOG_REVOKED,    // 帧号、轨迹、用户ID、置信度
+    DOOR_OPEN,        // 判定→继电器延迟ms
+    DOOR_CLOSED,      // 无参数
+    ALARM_ON,         // 判定→蜂鸣器延迟ms
+    COUNT
+};
 
-void postLog(const std::string& msg);// 声明日志投递函数：供外部调用，将日志消息放入队列
\ No newline at end of file
+extern LogRing g_log_ring;// 全局日志环形缓冲（业务线程写，日志线程读）
+
+//把一个参数写入记录（整数/枚举/布尔存为int64，浮点存为double）
+template <typename T>
+inline void packLogArg(LogRecord& rec, int i, T value) {
+    if constexpr (std::is_floating_point<T>::value) {
+        rec.args[i].d = static_cast<double>(value);
+        rec.types |= static_cast<uint8_t>(1u << i);
+    } else {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "日志参数只支持整数和浮点数");
+        rec.args[i].i = static_cast<int64_t>(value);
+    }
+}
+
+/**
+ * @brief 记录一个二进制日志事件（热路径）：只取时间戳、拷贝参数、无锁入队，不格式化、不分配内存
+ * @return 缓冲满被丢弃时返回false
+ */
+template <typename... Args>
+inline bool logEvent(LogEvent event, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "日志参数过多");
+    LogRecord rec;
+    rec.ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    rec.event = static_cast<uint16_t>(event);
+    rec.argc = static_cast<uint8_t>(sizeof...(Args));
+    int i = 0;
+    (packLogArg(rec, i++, args), ...);
+    return g_log_ring.push(rec);
+}
+
+//投递一条文本日志（冷路径：按行拆分后拷贝到环形缓冲的定长文本槽，不分配内存；超长的行按槽大小切开）
+void postLog(const std::string& msg);
+
+/**
+ * @brief 日志线程主循环：批量取出记录、格式化，按LOG_FLUSH_MS/LOG_BATCH_BYTES批量写入终端和轮转文件
+ * @details stopLog()之后取空缓冲、写出剩余内容并输出日志统计后返回
+ */
+void runLogWriter();
+//通知日志线程在取空缓冲后退出
+void stopLog();
+//因缓冲满丢弃的日志数
+unsigned long long logDropped();
+//格式化一条记录（追加到out，带时间前缀和换行；文本记录的正文为text，即pop取出的文本），供日志线程和测试使用
+void formatLogRecord(const LogRecord& rec, std::string& out, const std::string& text = std::string());
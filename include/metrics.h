@@ -0,0 +1,178 @@
+#pragma once
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+
+/**
+ * @class LatencyHistogram
+ * @brief 无锁延迟直方图（HDR风格对数-线性分桶，单位微秒）
+ * @details 1. 小于8us的值每微秒一个桶；之后每个2的幂区间等分为8个子桶，相对误差不超过12.5%
+ *          2. 覆盖到2^36us（约19小时），更大的值计入最后一个桶
+ *          3. record()只有几次relaxed原子操作，不加锁、不分配内存，可在任意线程调用
+ *          4. 读取（分位数、导出）不停止写入，结果是近似一致的快照
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 3;                        // 每个2的幂区间的子桶数 = 2^SUB_BITS
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_MAGNITUDE = 36;                  // 最大量级（2^36us）
+    static constexpr int BUCKETS = (MAX_MAGNITUDE - SUB_BITS + 2) * SUB_BUCKETS;
+
+    //记录一个值（微秒，负值按0计）
+    void record(int64_t us);
+    //记录从start到现在的时长
+    void recordSince(std::chrono::steady_clock::time_point start) {
+        record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sumUs() const { return sum_.load(std::memory_order_relaxed); }
+    int64_t maxUs() const { return max_.load(std::memory_order_relaxed); }
+    //分位数（p取0~1），返回所在桶的上界（微秒）；无数据时返回0
+    int64_t percentile(double p) const;
+    //第i个桶的计数
+    uint64_t bucketCount(int i) const { return counts_[i].load(std::memory_order_relaxed); }
+
+    //值所在的桶下标
+    static int bucketIndex(int64_t us);
+    //第i个桶的上界（不含，微秒）
+    static int64_t bucketUpper(int i);
+
+private:
+    std::atomic<uint64_t> counts_[BUCKETS] = {};// 各桶计数
+    std::atomic<uint64_t> count_{0};            // 总数
+    std::atomic<uint64_t> sum_{0};              // 总和（微秒）
+    std::atomic<int64_t> max_{0};               // 最大值（微秒）
+};
+
+//流水线各阶段（直方图编号）
+enum class Stage {
+    CAPTURE,       // 采集：读取+解码一帧
+    DETECT_WAIT,   // 采集完成 → 检测线程取到帧（帧通道中等待）
+    DETECT,        // 检测：取到帧 → 提交检测结果（预处理、检测、质量评分、拷贝人脸）
+    RECOGNIZE_WAIT,// 检测结果入队 → 识别线程取出（人脸队列中等待）
+    RECOGNIZE,     // 识别：批量预测
+    DECISION,      // 端到端：采集 → 做出开门/报警判定
+    ACTUATE,       // 判定 → 引脚翻转（执行机构）
+    DOOR,          // 端到端：采集 → 开门继电器吸合
+    COUNT
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief 运行指标汇总：各阶段延迟直方图、回调读取的计数/仪表（队列深度、丢弃数等）、各线程CPU时间
+ * @details 1. 直方图由业务线程直接写入；计数/仪表在导出时才调用回调读取，业务线程没有额外开销
+ *          2. 线程在启动时调用registerThread登记，导出时用pthread_getcpuclockid读取其CPU时间；
+ *             线程退出前调用finishThread记下自己的最终CPU时间，此后不再读取其时钟
+ *             （已join的线程的时钟不可读，线程ID还可能被新线程复用）
+ *          3. renderPrometheus()输出Prometheus文本格式；summary()输出一行摘要用于周期日志
+ */
+class MetricsRegistry {
+public:
+    //指标回调（导出时调用，须线程安全）
+    using Reader = std::function<double()>;
+
+    LatencyHistogram& stage(Stage s) { return stages_[static_cast<int>(s)]; }
+    const LatencyHistogram& stage(Stage s) const { return stages_[static_cast<int>(s)]; }
+
+    //登记计数（单调递增）或仪表（可增可减）；labels为Prometheus标签，如 queue="face"
+    void addCounter(const std::string& name, const std::string& help, const std::string& labels, Reader read);
+    void addGauge(const std::string& name, const std::string& help, const std::string& labels, Reader read);
+    //清除全部回调（回调引用的对象析构前调用）
+    void clearReaders();
+
+    //登记当前线程（在线程函数开头调用）
+    void registerThread(const std::string& name);
+    //记下当前线程的最终CPU时间（在线程函数返回前调用，见ThreadCpuScope）
+    void finishThread();
+
+    //Prometheus文本格式
+    std::string renderPrometheus();
+    //一行摘要：各阶段p50/p99、各线程CPU时间
+    std::string summary();
+
+    //阶段名（导出标签用）
+    static const char* stageName(Stage s);
+
+private:
+    struct Metric {
+        std::string name, help, labels;
+        bool counter;
+        Reader read;
+    };
+    struct ThreadCpu {
+        std::string name;
+        pthread_t thread;
+        clockid_t clock;
+        double last_sec = 0;  // 最后一次读到的CPU时间（线程退出后为最终值）
+        bool finished = false;// 线程已退出（不再读取其时钟）
+    };
+    //读取各线程CPU时间（调用方持有mtx_）
+    void refreshThreads();
+
+    LatencyHistogram stages_[static_cast<int>(Stage::COUNT)];
+    std::mutex mtx_;               // 保护metrics_/threads_
+    std::vector<Metric> metrics_;  // 登记顺序即导出顺序（同名指标相邻登记）
+    std::vector<ThreadCpu> threads_;
+};
+
+/**
+ * @class ThreadCpuScope
+ * @brief 线程CPU时间登记的作用域守卫：构造时registerThread，析构时finishThread（线程函数从任意位置返回都能记下最终值）
+ */
+class ThreadCpuScope {
+public:
+    ThreadCpuScope(MetricsRegistry& registry, const std::string& name) : registry_(registry) {
+        registry_.registerThread(name);
+    }
+    ~ThreadCpuScope() { registry_.finishThread(); }
+    ThreadCpuScope(const ThreadCpuScope&) = delete;
+    ThreadCpuScope& operator=(const ThreadCpuScope&) = delete;
+
+private:
+    MetricsRegistry& registry_;
+};
+
+/**
+ * @class MetricsServer
+ * @brief 本地指标端点：在localhost TCP端口或Unix套接字上应答HTTP请求（返回Prometheus文本），
+ *        并每隔METRICS_LOG_INTERVAL_S秒把摘要写入日志
+ * @details 端点描述：tcp:<地址>:<端口> | unix:<套接字路径> | off（只写周期日志）；
+ *          只监听本机，应答后立即关闭连接，同一时刻只处理一个请求
+ */
+class MetricsServer {
+public:
+    //summary_log为周期摘要的输出函数（通常为postLog）
+    MetricsServer(MetricsRegistry& registry, const std::string& spec,
+                  std::function<void(const std::string&)> summary_log);
+    ~MetricsServer() { stop(); }
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    //创建监听套接字并启动线程，端点描述无效或监听失败返回false（此时不启动）
+    bool start();
+    void stop();
+    //实际监听的地址（用于日志）
+    const std::string& address() const { return address_; }
+
+private:
+    void run();
+    void serve(int client);// 应答一个连接
+
+    MetricsRegistry& registry_;
+    std::string spec_;
+    std::function<void(const std::string&)> summary_log_;
+    std::string address_;
+    std::string unix_path_;       // Unix套接字路径（退出时删除）
+    int listen_fd_ = -1;          // 监听套接字（off时为-1）
+    int wake_fd_ = -1;            // eventfd：stop()唤醒
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
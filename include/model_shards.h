@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "config.h"
+#include "lbph_engine.h"
+
+/**
+ * @class ShardStore
+ * @brief 按身份分片存放的LBPH直方图：每个用户ID一个分片文件，合并后生成运行时画廊
+ * @details 1. 分片文件为 <目录>/<用户ID>.shard：文件头（LBP参数、用户ID、样本数、直方图长度）+
+ *             紧密排列的直方图（样本数×直方图长度个float），先写临时文件再改名
+ *          2. 录入/重新录入/删除一个人只计算并写入该人的分片，耗时与画廊规模无关；
+ *             merge()只读取分片拼接画廊（不重新计算直方图），再由调用方保存为运行时模型
+ *          3. 分片的LBP参数与合并目标引擎不一致时合并失败（参数修改后需全量重建）
+ */
+class ShardStore {
+public:
+    explicit ShardStore(const std::string& dir = MODEL_SHARD_DIR) : dir_(dir) {}
+
+    //写入一个身份的分片（替换原分片）：engine中rows所列样本的直方图，rows为空或目录无法创建时返回false
+    bool write(int label, const LbphEngine& engine, const std::vector<int>& rows) const;
+    //删除一个身份的分片，分片不存在返回false
+    bool remove(int label) const;
+    //已有分片的用户ID（升序）
+    std::vector<int> labels() const;
+    //读取全部分片设为model的画廊（按用户ID升序），没有分片、分片损坏或参数不一致时返回false（model不变）
+    //skip_label≥0时跳过该用户的分片（删除用户时先生成模型再删分片），跳过后没有剩余分片时设为空画廊
+    bool merge(LbphEngine& model, int& shards, int skip_label = -1) const;
+    //分片文件路径
+    std::string path(int label) const;
+    const std::string& dir() const { return dir_; }
+
+private:
+    std::string dir_;// 分片目录
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+
+/**
+ * @class ModelWatcher
+ * @brief 模型文件监视：文件被重新写入（inotify）或进程收到SIGHUP时，在后台线程回调通知重新加载
+ * @details 1. 监视模型文件所在目录（而不是文件本身）：训练工具先写临时文件再rename替换时，
+ *             原文件的inode已被替换，只有目录上的IN_MOVED_TO能看到新文件
+ *          2. 连续的写入事件合并：最后一次事件后MODEL_RELOAD_DEBOUNCE_MS内无新事件才回调
+ *          3. SIGHUP（kill -HUP <pid>）立即回调，inotify不可用（如网络文件系统）时仍可手动触发
+ *          4. 回调在监视线程中执行，可以直接在其中加载模型，不阻塞业务线程
+ * @note SIGHUP处理函数进程内只有一个，同一时刻只应有一个ModelWatcher在运行
+ */
+class ModelWatcher {
+public:
+    //回调参数：触发原因（用于日志），检测到变更的时刻（用于统计热更新延迟）
+    using Callback = std::function<void(const std::string& reason,
+                                        std::chrono::steady_clock::time_point detected)>;
+
+    ModelWatcher(const std::vector<std::string>& paths, Callback on_change,
+                 int debounce_ms = MODEL_RELOAD_DEBOUNCE_MS);
+    ~ModelWatcher() { stop(); }
+    ModelWatcher(const ModelWatcher&) = delete;
+    ModelWatcher& operator=(const ModelWatcher&) = delete;
+
+    //开始监视（安装SIGHUP处理函数、启动监视线程），失败返回false
+    bool start();
+    //停止监视并等待监视线程退出（回调执行中时等待其完成）
+    void stop();
+    //inotify是否可用（不可用时只响应SIGHUP）
+    bool watchingFiles() const { return inotify_fd_ >= 0; }
+
+private:
+    void run();// 监视线程函数
+
+    std::vector<std::string> paths_;  // 被监视的模型文件
+    Callback on_change_;              // 变更回调
+    std::chrono::milliseconds debounce_;// 合并写入事件的等待时长
+    int inotify_fd_ = -1;             // inotify实例
+    int wake_fd_ = -1;                // eventfd：SIGHUP和stop()唤醒监视线程
+    std::map<int, std::set<std::string>> watched_;// 目录watch描述符 → 该目录下被监视的文件名
+    std::atomic<bool> running_{false};// 监视线程运行标志
+    std::thread thread_;              // 监视线程
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "config.h"
+#include "safe_queue.h"
+
+/**
+ * @brief 流水线中一个阶段（一组同类线程）的调度参数
+ */
+struct StageConfig {
+    std::string name;          // 阶段名：capture | detect | recognize | display | log
+    int workers = 1;           // 线程数（只有detect可大于1）
+    std::vector<int> cpus;     // 绑定的CPU核（空表示不限制）
+    std::string priority;      // 调度优先级：空（不改变）| nice:<-20~19> | fifo:<1~99> | rr:<1~99>
+};
+
+/**
+ * @brief 两个阶段之间的一条边（队列/通道）
+ */
+struct EdgeConfig {
+    std::string name;          // 边名：frames | faces | journal
+    std::string from, to;      // 上游/下游阶段（拓扑固定，只用于描述）
+    int capacity = 1;          // 容量
+    QueueFullPolicy policy = QueueFullPolicy::REJECT;// 满时策略
+    std::vector<QueueFullPolicy> allowed;            // 该边支持的策略
+};
+
+/**
+ * @class PipelineGraph
+ * @brief 门禁流水线的阶段-边描述：各阶段的线程数、CPU亲和性、调度优先级，各边的容量和满时策略
+ * @details 1. defaults()即原有拓扑：采集 →(frames，广播通道) 显示/检测线程池 →(faces) 识别 →(journal) 出入记录，
+ *             参数取自config.h，不绑核、不改优先级
+ *          2. load()读取YAML配置文件（cv::FileStorage），只覆盖文件中出现的项；未知的阶段/边/字段、
+ *             超出范围的值、该边不支持的策略都视为错误，整个文件不生效
+ *          3. 拓扑（有哪些阶段和边）由代码决定，配置文件只调整参数
+ * @note 配置文件示例见pipeline.example.yml
+ */
+class PipelineGraph {
+public:
+    //原有拓扑及config.h中的参数
+    static PipelineGraph defaults();
+
+    //读取配置文件覆盖参数，失败返回false并在error中说明（原有内容不变）
+    bool load(const std::string& path, std::string& error);
+    //按名称查找（名称必须存在）
+    const StageConfig& stage(const std::string& name) const;
+    const EdgeConfig& edge(const std::string& name) const;
+    //一行文字描述（启动日志用）
+    std::string describe() const;
+    //帧池/人脸池槽位数（随通道容量、检测线程数、人脸队列容量变化，公式同config.h）
+    size_t framePoolSize() const { return static_cast<size_t>(edge("frames").capacity + stage("detect").workers + 4); }
+    size_t facePoolSize() const {
+        return static_cast<size_t>((edge("faces").capacity + stage("detect").workers + 2) * MAX_FACES_PER_FRAME);
+    }
+
+    std::vector<StageConfig> stages;
+    std::vector<EdgeConfig> edges;
+};
+
+//策略名：reject | overwrite_oldest | block
+const char* policyName(QueueFullPolicy policy);
+
+/**
+ * @brief 把调用线程绑定到阶段的CPU集合并设置调度优先级
+ * @return 失败项的说明（空串表示全部成功；如提高优先级需要CAP_SYS_NICE，权限不足时其余设置仍生效）
+ * @note 须在线程内部调用；之后由该线程创建的线程继承其CPU集合
+ */
+std::string applyThreadPolicy(const StageConfig& stage);
@@ -0,0 +1,99 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "config.h"
+
+/**
+ * @class PreviewSink
+ * @brief 预览画面输出接口（显示循环按PREVIEW_FPS限速，只在画面或识别结果变化时绘制并写入）
+ * @note 只在主线程（显示循环）中调用
+ */
+class PreviewSink {
+public:
+    virtual ~PreviewSink() = default;
+    //打开输出（窗口/文件/监听套接字），失败返回false
+    virtual bool open() = 0;
+    //输出一帧已绘制的画面，失败返回false（调用方停止预览）
+    virtual bool write(const cv::Mat& frame) = 0;
+    //处理界面/连接事件，最多等待wait_ms毫秒；返回true表示用户请求退出（窗口中按ESC）
+    virtual bool poll(int wait_ms);
+    //输出描述（用于日志）
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @class WindowPreviewSink
+ * @brief OpenCV窗口（imshow），未设置DISPLAY时默认使用本机X11显示:0
+ */
+class WindowPreviewSink : public PreviewSink {
+public:
+    ~WindowPreviewSink() override;
+    bool open() override;
+    bool write(const cv::Mat& frame) override;
+    bool poll(int wait_ms) override;
+    std::string name() const override { return "window"; }
+
+private:
+    bool opened_ = false;
+};
+
+/**
+ * @class MjpegFilePreviewSink
+ * @brief MJPEG录像文件（OpenCV内置AVI/MJPEG编码器，不依赖FFmpeg/GStreamer）
+ * @details 第一次写入时按画面尺寸创建文件，帧率标记为PREVIEW_FPS；画面静止时不写入，
+ *          因此回放时长可能短于实际时长
+ */
+class MjpegFilePreviewSink : public PreviewSink {
+public:
+    explicit MjpegFilePreviewSink(const std::string& path) : path_(path) {}
+    bool open() override;
+    bool write(const cv::Mat& frame) override;
+    std::string name() const override { return "mjpeg:" + path_; }
+
+private:
+    std::string path_;
+    cv::VideoWriter writer_;
+};
+
+/**
+ * @class StreamPreviewSink
+ * @brief 本机套接字上的MJPEG流（HTTP multipart/x-mixed-replace，浏览器/curl/ffplay可直接查看）
+ * @details 1. 监听 tcp:<地址>:<端口> 或 unix:<套接字路径>，最多PREVIEW_MAX_CLIENTS个观看者
+ *          2. 没有观看者时不编码JPEG；同一帧只编码一次，发给全部观看者
+ *          3. 套接字非阻塞：观看者来不及接收时跳过新帧（只保留正在发送的一帧），不拖慢显示循环
+ *          4. 新观看者连接后立即收到最近一帧
+ */
+class StreamPreviewSink : public PreviewSink {
+public:
+    explicit StreamPreviewSink(const std::string& spec) : spec_(spec) {}
+    ~StreamPreviewSink() override;
+    bool open() override;
+    bool write(const cv::Mat& frame) override;
+    bool poll(int wait_ms) override;
+    std::string name() const override { return spec_; }
+
+private:
+    struct Client {
+        int fd;
+        std::string pending;// 尚未发出的数据
+        size_t sent = 0;    // pending中已发出的字节数
+    };
+    void acceptClients();
+    //尽量发出pending，连接断开时返回false
+    bool flush(Client& client);
+    //发送part给所有空闲的观看者，断开的连接移除
+    void broadcast(const std::string& part);
+
+    std::string spec_;
+    std::string unix_path_;       // Unix套接字路径（退出时删除）
+    int listen_fd_ = -1;
+    std::vector<Client> clients_;
+    std::vector<unsigned char> jpeg_;// 编码缓冲（复用）
+    std::string last_part_;       // 最近一帧（multipart分段，新观看者连接时先发送）
+};
+
+//根据描述字符串创建预览输出："window" | "mjpeg:<文件>" | "tcp:<地址>:<端口>" | "unix:<套接字路径>"
+//无法识别时返回nullptr；"off"（无头模式）由调用方处理，不创建输出
+std::unique_ptr<PreviewSink> createPreviewSink(const std::string& spec);
@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+*  重排序缓冲：多个工作线程乱序完成，按领取任务时的票号（ticket）顺序输出结果
+*  票号必须从0开始连续领取，且每个票号都必须提交一次（即使没有结果也要提交空结果），
+*  否则后续结果会一直滞留在缓冲中
+*  结果存放在固定数量的槽位中（票号对槽位数取模），提交时与槽位中的旧结果交换而不是拷贝，
+*  调用方换回的旧结果可复用其容量（vector等），稳态下不分配内存
+*/
+
+template <typename T>
+class ReorderBuffer {
+public:
+    //capacity为同时在途（已领票号、尚未输出）的结果数上限，应不小于工作线程数
+    explicit ReorderBuffer(size_t capacity) : slots_(std::max<size_t>(capacity, 1)) {}
+
+    //提交第ticket号结果：item与槽位中已输出过的旧结果交换（提交后item为旧结果，由调用方重置后复用）；
+    //从当前期望票号开始连续的结果按顺序交给emit处理（在锁内调用，emit应尽量轻量）
+    //票号超出在途上限时等待前序结果输出
+    template <typename Fn>
+    void submit(unsigned long long ticket, T& item, Fn&& emit) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [&]() { return ticket < next_ + slots_.size(); });
+        Slot& slot = slots_[ticket % slots_.size()];
+        std::swap(slot.item, item);
+        slot.ready = true;
+        pending_++;
+        max_pending_ = std::max(max_pending_, pending_);
+        bool emitted = false;
+        for (Slot* s = &slots_[next_ % slots_.size()]; s->ready; s = &slots_[next_ % slots_.size()]) {
+            emit(s->item);
+            s->ready = false;
+            pending_--;
+            next_++;
+            emitted = true;
+        }
+        if (emitted) not_full_.notify_all();
+    }
+
+    //缓冲中同时滞留的最大结果数（反映工作线程间的耗时差异）
+    size_t maxPending() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return max_pending_;
+    }
+
+private:
+    struct Slot {
+        T item;            // 结果（输出后保留，供下次提交交换复用）
+        bool ready = false;// 已提交、尚未输出
+    };
+    mutable std::mutex mtx_;             // 保护以下成员
+    std::condition_variable not_full_;   // 票号超出在途上限时等待
+    std::vector<Slot> slots_;            // 已完成但前序票号尚未完成的结果（按票号取模存放）
+    unsigned long long next_ = 0;        // 下一个应输出的票号
+    size_t pending_ = 0;                 // 当前滞留数
+    size_t max_pending_ = 0;             // 最大滞留数
+};
@@ -1,7 +1,14 @@
 #pragma once
-#include <queue>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 /*
 *  通过队列解决多线程竞态条件问题
@@ -10,48 +17,518 @@
 *  人脸检测线程：detectThread()，从采集队列取画面 → 转灰度图 → 用 Haar 检测器找人脸 → 截取人脸区域
 *  人脸识别线程：recognizeThread()，从检测队列取人脸区域 → 用 LBPH 模型识别 → 成功开门 / 失败报警
 *  异步日志线程：logThread()，从日志队列取消息 → 输出到控制台 / 写入文件，不阻塞业务线程
+*
+*  队列家族（接口相同：push/emplace/pop/pop_for/try_pop/drain/stop）：
+*  1. SafeQueue：互斥锁 + 定长环形缓冲，任意多生产者/消费者
+*  2. SpscRing：单生产者/单消费者无锁环形缓冲，用于流水线中固定的一对一环节
+*  3. MpmcQueue：有界多生产者/多消费者无锁队列（每个槽位带序号）
+*  三者都支持全部三种满队列策略；入队只在成功时移走参数（push(T&&)失败后原对象不变）；
+*  stop()后入队一律失败，出队取完剩余元素后返回false
+*  try_push：BLOCK策略下队列满时也不等待（按REJECT处理）
+*  push(item, policy)：运行时指定本次入队的满时策略，供按配置选择策略的调用方使用；
+*  REJECT总是可用，其余策略须与模板参数Policy相同，Policy为OVERWRITE_OLDEST时三种均可用，不可用的按REJECT处理
 */
 
-template <typename T>
+//队列满时的入队策略
+enum class QueueFullPolicy {
+    REJECT,           // 丢弃新元素，push返回false
+    OVERWRITE_OLDEST, // 丢弃最旧的元素，新元素入队
+    BLOCK,            // 等待出现空位（stop()后返回false）
+};
+
+namespace queue_detail {
+
+//不小于n的2的幂
+inline size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+//push(item, policy)实际采用的满时策略：REJECT总是可用，Policy为OVERWRITE_OLDEST时三种均可用，否则只能与Policy相同
+constexpr QueueFullPolicy effectivePolicy(QueueFullPolicy queue_policy, QueueFullPolicy wanted) {
+    return (wanted == queue_policy || queue_policy == QueueFullPolicy::OVERWRITE_OLDEST) ? wanted
+                                                                                          : QueueFullPolicy::REJECT;
+}
+
+/**
+ * @class QueueWaiter
+ * @brief 无锁队列的等待/唤醒：先短暂自旋，仍未就绪再挂到条件变量上
+ * @details 通知方只有在确有等待者时才加锁唤醒，无人等待的快速路径只有一次内存屏障和一次原子读
+ */
+class QueueWaiter {
+public:
+    static constexpr int SPIN_COUNT = 128;// 休眠前的自旋检查次数
+
+    //等待ready()为真，超时返回false；timeout为nanoseconds::max()时无限等待
+    template <typename Pred>
+    bool wait(Pred ready, std::chrono::nanoseconds timeout) {
+        for (int i = 0; i < SPIN_COUNT; i++) {
+            if (ready()) return true;
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);// 与notify()中的屏障配对：要么对方看到等待者，要么本方看到新状态
+        bool ok = true;
+        if (timeout == std::chrono::nanoseconds::max()) cond_.wait(lock, ready);
+        else ok = cond_.wait_for(lock, timeout, ready);
+        waiters_.fetch_sub(1);
+        return ok;
+    }
+    //状态改变后调用：有等待者时唤醒
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) wakeAll();
+    }
+    //无条件唤醒全部等待者（stop时使用）
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        cond_.notify_all();
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::atomic<int> waiters_{0};// 正在休眠的线程数
+};
+
+}  // namespace queue_detail
+
+/**
+ * @class SafeQueue
+ * @brief 互斥锁保护的有界队列（任意多生产者/多消费者）
+ * @details 元素存放在定长环形缓冲中，入队/出队不分配节点；满队列策略由模板参数Policy选择
+ */
+template <typename T, QueueFullPolicy Policy = QueueFullPolicy::REJECT>
 class SafeQueue {
 public:
     //指定队列最大容量（10），避免隐式类型转换
-    explicit SafeQueue(size_t max_size = 10) : max_size_(max_size) {}
-    //入队，非阻塞
-    bool push(const T& item) {
-        std::unique_lock<std::mutex> lock(mtx_);// 互斥锁
-        // 队列满则返回失败
-        if (queue_.size() >= max_size_) return false;
-        queue_.push(item);      // 入队数据
-        cond_.notify_one();     // 唤醒一个等待的出队线程
-        return true;            // 入队成功
+    explicit SafeQueue(size_t max_size = 10) : slots_(std::max<size_t>(max_size, 1)) {}
+
+    //入队（拷贝）
+    bool push(const T& item) { return emplace(item); }
+    //入队（移动，失败时item不变）
+    bool push(T&& item) { return emplace(std::move(item)); }
+    //入队，满时不等待
+    bool try_push(T&& item) { return insert(QueueFullPolicy::REJECT, std::move(item)); }
+    //入队，本次按policy处理队列满（见文件头说明）
+    bool push(T&& item, QueueFullPolicy policy) {
+        return insert(queue_detail::effectivePolicy(Policy, policy), std::move(item));
     }
-    //出队，阻塞
+    //原地构造后入队
+    template <typename... Args>
+    bool emplace(Args&&... args) { return insert(Policy, std::forward<Args>(args)...); }
+
+    //出队，阻塞；停止且队列为空时返回false（线程可退出）
     bool pop(T& item) {
         std::unique_lock<std::mutex> lock(mtx_);// 保证同一时间只有一个线程操作队列
         // 等待条件：队列非空 OR 收到停止信号
-        cond_.wait(lock, [this]() {
-            return !queue_.empty() || stop_flag_;// 条件变量：队列空时休眠，有数据再唤醒
+        not_empty_.wait(lock, [this]() {
+            return count_ > 0 || stop_flag_;// 条件变量：队列空时休眠，有数据再唤醒
         });
-        // 停止且队列为空：返回失败（线程可退出）
-        if (stop_flag_ && queue_.empty()) return false;
-        // 取出队首元素并弹出
-        item = queue_.front();
-        queue_.pop();
-        return true;
+        return take(item, lock);
     }
+    //出队，最多等待timeout；超时或已停止且队列为空时返回false
+    template <typename Rep, typename Period>
+    bool pop_for(T& item, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait_for(lock, timeout, [this]() { return count_ > 0 || stop_flag_; });
+        return take(item, lock);
+    }
+    //出队，不等待
+    bool try_pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return take(item, lock);
+    }
+    //一次加锁取出至多max_items个元素追加到out，不等待，返回取出个数
+    size_t drain(std::vector<T>& out, size_t max_items) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        size_t n = std::min(max_items, count_);
+        for (size_t i = 0; i < n; i++) {
+            out.push_back(std::move(slots_[head_]));
+            head_ = next(head_);
+        }
+        count_ -= n;
+        lock.unlock();
+        if (Policy != QueueFullPolicy::REJECT && n > 0) not_full_.notify_all();
+        return n;
+    }
+
     //主动停止
-    /*主动触发所有阻塞在pop方法的线程退出等待*/
+    /*主动触发所有阻塞在pop/push方法的线程退出等待*/
     void stop() {
         std::lock_guard<std::mutex> lock(mtx_);// 轻量级加锁（lock_guard自动释放）
         stop_flag_ = true;                     // 设置停止标志
-        cond_.notify_all();                    // 唤醒所有等待的出队线程
+        not_empty_.notify_all();               // 唤醒所有等待的出队线程
+        not_full_.notify_all();                // 唤醒所有等待空位的入队线程
+    }
+
+    //当前元素数
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return count_;
+    }
+    //容量
+    size_t capacity() const { return slots_.size(); }
+    //因队列满被丢弃的元素数（REJECT：新元素；OVERWRITE_OLDEST：最旧的元素）
+    unsigned long long dropped() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return dropped_;
+    }
+
+private:
+    //入队，队列满时按mode处理
+    template <typename... Args>
+    bool insert(QueueFullPolicy mode, Args&&... args) {
+        std::unique_lock<std::mutex> lock(mtx_);// 互斥锁
+        if (stop_flag_) return false;
+        if (count_ == slots_.size()) {
+            if (mode == QueueFullPolicy::REJECT) {
+                dropped_++;
+                return false;// 队列满则返回失败
+            }
+            if (mode == QueueFullPolicy::OVERWRITE_OLDEST) {
+                head_ = next(head_);// 最旧的元素随后被新元素覆盖
+                count_--;
+                dropped_++;
+            } else {
+                not_full_.wait(lock, [this]() { return count_ < slots_.size() || stop_flag_; });
+                if (stop_flag_) return false;
+            }
+        }
+        size_t tail = head_ + count_;
+        if (tail >= slots_.size()) tail -= slots_.size();
+        slots_[tail] = T(std::forward<Args>(args)...);
+        count_++;
+        lock.unlock();
+        not_empty_.notify_one();// 唤醒一个等待的出队线程
+        return true;// 入队成功
+    }
+
+    size_t next(size_t i) const { return i + 1 == slots_.size() ? 0 : i + 1; }
+    //在锁内取出队首元素（队列空时返回false）
+    bool take(T& item, std::unique_lock<std::mutex>& lock) {
+        if (count_ == 0) return false;
+        // 取出队首元素并弹出
+        item = std::move(slots_[head_]);
+        head_ = next(head_);
+        count_--;
+        lock.unlock();
+        if (Policy != QueueFullPolicy::REJECT) not_full_.notify_one();
+        return true;
+    }
+
+    std::vector<T> slots_;             // 环形缓冲，存放实际数据
+    size_t head_ = 0;                  // 队首下标
+    size_t count_ = 0;                 // 元素数，限制队列不会无限膨胀
+    unsigned long long dropped_ = 0;   // 丢弃数
+    mutable std::mutex mtx_;           // 互斥锁，保护所有队列操作
+    std::condition_variable not_empty_;// 条件变量，队列空时阻塞出队线程
+    std::condition_variable not_full_; // 条件变量，队列满时阻塞入队线程（BLOCK，Policy为REJECT时不使用）
+    bool stop_flag_ = false;           // 停止标志，用于终止出入队线程的等待
+};
+
+/**
+ * @class SpscRing
+ * @brief 单生产者/单消费者无锁环形缓冲
+ * @details 1. 生产者只写tail_、消费者只写head_，各占一个缓存行；各自缓存对方的位置，
+ *             只有缓存值显示满/空时才重新读取对方的原子变量
+ *          2. 槽位数取2的幂（下标用掩码），容量仍按构造参数限制
+ *          3. 空/满时的等待先自旋再休眠，生产者只有在消费者确实休眠时才加锁唤醒
+ *          4. OVERWRITE_OLDEST：消费者先在reading_登记要读的位置，再用CAS推进head_认领队首；
+ *             队列满时生产者同样用CAS推进head_丢弃最旧的元素，两者只有一方能拿到同一个位置。
+ *             生产者写槽位前若消费者仍在读取同一槽位（已让出位置但尚未移走数据），自旋等其读完
+ * @note 同一时刻只能有一个线程入队、一个线程出队；多个线程轮流入队时必须由锁等保证先后顺序。
+ *       Policy为OVERWRITE_OLDEST时每次出队多一次CAS
+ */
+template <typename T, QueueFullPolicy Policy = QueueFullPolicy::REJECT>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : capacity_(std::max<size_t>(capacity, 1)),
+          slots_(queue_detail::roundUpPow2(capacity_)),
+          mask_(slots_.size() - 1) {}
+
+    bool push(const T& item) { return emplace(item); }
+    bool push(T&& item) { return emplace(std::move(item)); }
+    bool try_push(T&& item) { return insert(QueueFullPolicy::REJECT, std::move(item)); }
+    bool push(T&& item, QueueFullPolicy policy) {
+        return insert(queue_detail::effectivePolicy(Policy, policy), std::move(item));
+    }
+    template <typename... Args>
+    bool emplace(Args&&... args) { return insert(Policy, std::forward<Args>(args)...); }
+
+    bool try_pop(T& item) {
+        size_t head = 0;
+        if (claim(1, head) == 0) return false;
+        item = std::move(slots_[head & mask_]);
+        release(head + 1);
+        return true;
+    }
+    bool pop(T& item) { return pop_for(item, std::chrono::nanoseconds::max()); }
+    template <typename Rep, typename Period>
+    bool pop_for(T& item, std::chrono::duration<Rep, Period> timeout) {
+        if (try_pop(item)) return true;
+        not_empty_.wait([this]() { return readable() || stopped_.load(std::memory_order_acquire); },
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+        return try_pop(item);
+    }
+    //取出至多max_items个元素追加到out（只读写一次对方位置），不等待，返回取出个数
+    size_t drain(std::vector<T>& out, size_t max_items) {
+        size_t head = 0;
+        size_t n = claim(max_items, head);
+        if (n == 0) return 0;
+        for (size_t i = 0; i < n; i++) out.push_back(std::move(slots_[(head + i) & mask_]));
+        release(head + n);
+        return n;
+    }
+
+    void stop() {
+        stopped_.store(true);
+        not_empty_.wakeAll();
+        not_full_.wakeAll();
+    }
+
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;// 覆盖模式下head_可能在读tail_之后被推进
     }
+    size_t capacity() const { return capacity_; }
+    unsigned long long dropped() const { return dropped_.load(std::memory_order_relaxed); }
 
 private:
-    std::queue<T> queue_;          // 底层存储队列，存放实际数据
-    mutable std::mutex mtx_;       // 互斥锁，保护所有队列操作
-    std::condition_variable cond_; // 条件变量，用于阻塞/唤醒出队线程
-    size_t max_size_;              // 队列最大容量，限制队列不会无限膨胀
-    bool stop_flag_ = false;       // 停止标志，用于终止出队线程的等待
-};
\ No newline at end of file
+    static constexpr size_t IDLE = SIZE_MAX;// reading_：消费者未在读取
+
+    //认领队首至多max_items个元素，head输出起始位置，返回认领个数（队列空时为0）
+    size_t claim(size_t max_items, size_t& head) {
+        if (max_items == 0) return 0;
+        if (Policy != QueueFullPolicy::OVERWRITE_OLDEST) {
+            head = head_.load(std::memory_order_relaxed);
+            if (tail_cache_ - head < max_items) tail_cache_ = tail_.load(std::memory_order_acquire);
+            return std::min(max_items, tail_cache_ - head);
+        }
+        head = head_.load(std::memory_order_acquire);
+        for (;;) {
+            if (head >= tail_cache_) tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head >= tail_cache_) break;
+            size_t n = std::min(max_items, tail_cache_ - head);
+            reading_.store(head, std::memory_order_release);// 先登记再认领，生产者看到新head_时必能看到登记
+            if (head_.compare_exchange_weak(head, head + n, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return n;
+            }
+            // 最旧的元素刚被生产者丢弃（或伪失败），head已更新为当前队首
+        }
+        reading_.store(IDLE, std::memory_order_release);
+        return 0;
+    }
+    //已移走认领的元素，new_head为认领区间的末尾
+    void release(size_t new_head) {
+        if (Policy == QueueFullPolicy::OVERWRITE_OLDEST) reading_.store(IDLE, std::memory_order_release);
+        else head_.store(new_head, std::memory_order_release);
+        if (Policy != QueueFullPolicy::REJECT) not_full_.notify();
+    }
+
+    //入队，队列满时按mode处理
+    template <typename... Args>
+    bool insert(QueueFullPolicy mode, Args&&... args) {
+        if (stopped_.load(std::memory_order_relaxed)) return false;
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= capacity_) {
+                if (mode == QueueFullPolicy::REJECT) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (mode == QueueFullPolicy::OVERWRITE_OLDEST) {
+                    // 与消费者争抢队首：成功则丢弃最旧的元素（释放其资源），失败说明消费者刚取走队首，已有空位
+                    size_t head = head_cache_;
+                    if (head_.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire)) {
+                        slots_[head & mask_] = T();// 释放最旧元素持有的资源（如帧池引用）
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        head++;
+                    }
+                    head_cache_ = head;
+                } else {
+                    not_full_.wait([&]() {
+                        return stopped_.load(std::memory_order_acquire) ||
+                               tail - head_.load(std::memory_order_acquire) < capacity_;
+                    }, std::chrono::nanoseconds::max());
+                    if (stopped_.load(std::memory_order_acquire)) return false;
+                    head_cache_ = head_.load(std::memory_order_acquire);
+                }
+            }
+        }
+        if (Policy == QueueFullPolicy::OVERWRITE_OLDEST) {
+            // 消费者认领的区间已让出位置，但可能仍在读取与tail同一槽位的旧数据
+            for (size_t r = reading_.load(std::memory_order_acquire); r != IDLE && tail - r >= slots_.size();
+                 r = reading_.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+        slots_[tail & mask_] = T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+    bool readable() const { return tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed); }
+
+    const size_t capacity_;             // 容量
+    std::vector<T> slots_;              // 槽位（2的幂个）
+    const size_t mask_;                 // 下标掩码
+    alignas(64) std::atomic<size_t> tail_{0};// 生产者位置
+    size_t head_cache_ = 0;             // 生产者缓存的消费者位置
+    alignas(64) std::atomic<size_t> head_{0};// 消费者位置（OVERWRITE_OLDEST时生产者也会推进）
+    size_t tail_cache_ = 0;             // 消费者缓存的生产者位置
+    std::atomic<size_t> reading_{IDLE}; // 消费者正在读取的起始位置（只用于OVERWRITE_OLDEST）
+    alignas(64) std::atomic<bool> stopped_{false};
+    std::atomic<unsigned long long> dropped_{0};
+    queue_detail::QueueWaiter not_empty_, not_full_;// 消费者/生产者（BLOCK）的等待
+};
+
+/**
+ * @class MpmcQueue
+ * @brief 有界多生产者/多消费者无锁队列（每个槽位带序号，Vyukov算法，与LogRing相同）
+ * @details 入队/出队各用一次CAS占位，槽位序号发布数据；空/满时的等待同SpscRing；
+ *          OVERWRITE_OLDEST：队列满时生产者像消费者一样取出队首元素丢弃，再重试入队
+ * @note 容量取不小于构造参数的2的幂
+ */
+template <typename T, QueueFullPolicy Policy = QueueFullPolicy::REJECT>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : cells_(queue_detail::roundUpPow2(std::max<size_t>(capacity, 2))), mask_(cells_.size() - 1) {
+        for (size_t i = 0; i < cells_.size(); i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& item) { return emplace(item); }
+    bool push(T&& item) { return emplace(std::move(item)); }
+    bool try_push(T&& item) { return insert(QueueFullPolicy::REJECT, std::move(item)); }
+    bool push(T&& item, QueueFullPolicy policy) {
+        return insert(queue_detail::effectivePolicy(Policy, policy), std::move(item));
+    }
+    template <typename... Args>
+    bool emplace(Args&&... args) { return insert(Policy, std::forward<Args>(args)...); }
+
+    bool try_pop(T& item) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;// 队列空（或生产者尚未发布）
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->value);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        if (Policy != QueueFullPolicy::REJECT) not_full_.notify();
+        return true;
+    }
+    bool pop(T& item) { return pop_for(item, std::chrono::nanoseconds::max()); }
+    template <typename Rep, typename Period>
+    bool pop_for(T& item, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now();
+        bool forever = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout) == std::chrono::nanoseconds::max();
+        if (!forever) deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        for (;;) {
+            if (try_pop(item)) return true;
+            if (stopped_.load(std::memory_order_acquire)) return try_pop(item);
+            std::chrono::nanoseconds left = std::chrono::nanoseconds::max();
+            if (!forever) {
+                left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+                if (left.count() <= 0) return false;
+            }
+            // 被唤醒后可能已被其他消费者取走，回到循环重试
+            not_empty_.wait([this]() { return readable() || stopped_.load(std::memory_order_acquire); }, left);
+        }
+    }
+    size_t drain(std::vector<T>& out, size_t max_items) {
+        size_t n = 0;
+        T item;
+        while (n < max_items && try_pop(item)) {
+            out.push_back(std::move(item));
+            n++;
+        }
+        return n;
+    }
+
+    void stop() {
+        stopped_.store(true);
+        not_empty_.wakeAll();
+        not_full_.wakeAll();
+    }
+
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire), head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    size_t capacity() const { return cells_.size(); }
+    unsigned long long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    //入队，队列满时按mode处理
+    template <typename... Args>
+    bool insert(QueueFullPolicy mode, Args&&... args) {
+        for (;;) {
+            if (stopped_.load(std::memory_order_relaxed)) return false;
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            Cell* cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (!tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) continue;
+                cell->value = T(std::forward<Args>(args)...);
+                cell->seq.store(pos + 1, std::memory_order_release);
+                not_empty_.notify();
+                return true;
+            }
+            if (diff > 0) continue;// 被其他生产者抢先
+            // 队列满
+            if (mode == QueueFullPolicy::REJECT) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (mode == QueueFullPolicy::OVERWRITE_OLDEST) {
+                // 队尾槽位已被消费者认领、只是尚未读完：等其读完，不多丢元素
+                if (head_.load(std::memory_order_acquire) + cells_.size() > pos) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // 取出最旧的元素丢弃后重试（取不到说明其他线程刚取走）
+                T oldest;
+                if (try_pop(oldest)) dropped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            not_full_.wait([this]() { return writable() || stopped_.load(std::memory_order_acquire); },
+                           std::chrono::nanoseconds::max());
+        }
+    }
+    struct Cell {
+        std::atomic<size_t> seq;// 槽位序号：=pos可写，=pos+1可读
+        T value;
+    };
+    bool readable() const {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+    bool writable() const {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].seq.load(std::memory_order_acquire) == pos;
+    }
+
+    std::vector<Cell> cells_;
+    const size_t mask_;
+    alignas(64) std::atomic<size_t> tail_{0};  // 生产者位置（独占缓存行，避免与消费者伪共享）
+    alignas(64) std::atomic<size_t> head_{0};  // 消费者位置
+    alignas(64) std::atomic<bool> stopped_{false};
+    std::atomic<unsigned long long> dropped_{0};// 丢弃数
+    queue_detail::QueueWaiter not_empty_, not_full_;
+};
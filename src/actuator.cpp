@@ -0,0 +1,210 @@
+/**
+ * @file actuator.cpp
+ * @brief 执行机构线程实现（命令队列、时间轮定时复位、去抖、延迟统计）
+ */
+#include "actuator.h"
+#include <algorithm>
+
+using namespace std;
+
+// ====================== 时间轮 ======================
+
+TimerWheel::TimerWheel(int tick_ms, int slots)
+    : tick_(tick_ms), origin_(Clock::now()), slots_(max(1, slots)) {}
+
+long long TimerWheel::tickOf(Clock::time_point t) const {
+    if (t <= origin_) return 0;
+    long long ms = chrono::duration_cast<chrono::milliseconds>(t - origin_ + tick_ - chrono::milliseconds(1)).count();
+    return ms / tick_.count();
+}
+
+void TimerWheel::schedule(Clock::time_point due, int channel, unsigned gen) {
+    if (pending_ == 0) {
+        // 空闲期间线程不推进current_：先追到当前刻度，否则下次advance要逐个刻度补走整个空闲期
+        Clock::time_point now = Clock::now();
+        current_ = max<long long>(current_, now <= origin_ ? 0 : (now - origin_) / tick_);
+    }
+    long long tick = max(tickOf(due), current_ + 1);// 已过期的定时器在下一个刻度到期
+    slots_[tick % slots_.size()].push_back({tick, channel, gen});
+    pending_++;
+}
+
+void TimerWheel::advance(Clock::time_point now, vector<Timer>& due) {
+    long long target = now <= origin_ ? 0 : (now - origin_) / tick_;
+    if (pending_ == 0) {
+        // 没有定时器时直接跳到当前刻度（空闲期间线程不按刻度唤醒）
+        current_ = max(current_, target);
+        return;
+    }
+    while (current_ < target) {
+        current_++;
+        vector<Timer>& slot = slots_[current_ % slots_.size()];
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i].tick > current_) {
+                i++;// 还要再转若干圈
+                continue;
+            }
+            due.push_back(slot[i]);
+            slot[i] = slot.back();
+            slot.pop_back();
+            pending_--;
+        }
+    }
+}
+
+TimerWheel::Clock::time_point TimerWheel::nextTick() const {
+    if (pending_ == 0) return Clock::time_point::max();
+    return origin_ + tick_ * (current_ + 1);
+}
+
+// ====================== 执行机构 ======================
+
+Actuator::Actuator(unique_ptr<GpioBackend> backend, EdgeCallback on_edge)
+    : backend_(move(backend)), on_edge_(move(on_edge)) {
+    Channel& door = channels_[static_cast<int>(ActuatorChannel::DOOR)];
+    door.pin = DOOR_PIN_BCM;
+    door.active_level = 1;  // 继电器：高电平吸合（开门）
+    Channel& buzzer = channels_[static_cast<int>(ActuatorChannel::BUZZER)];
+    buzzer.pin = BUZZER_PIN_BCM;
+    buzzer.active_level = 0;// 蜂鸣器：低电平响
+    queue_.reserve(ACTUATOR_QUEUE_SIZE);
+}
+
+bool Actuator::start() {
+    if (!backend_) return false;
+    vector<int> pins, idle;
+    for (const Channel& ch : channels_) {
+        pins.push_back(ch.pin);
+        idle.push_back(!ch.active_level);// 初始为空闲电平（门关闭、蜂鸣器静音）
+    }
+    if (!backend_->init(pins, idle)) return false;
+    lock_guard<mutex> lock(mtx_);
+    running_ = true;
+    thread_ = thread(&Actuator::run, this);
+    return true;
+}
+
+void Actuator::stop() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    backend_->cleanup();
+}
+
+bool Actuator::submit(const ActuatorCommand& cmd) {
+    {
+        lock_guard<mutex> lock(mtx_);
+        if (!running_ || queue_.size() >= static_cast<size_t>(ACTUATOR_QUEUE_SIZE)) {
+            dropped_++;
+            return false;
+        }
+        queue_.push_back(cmd);
+    }
+    cond_.notify_one();
+    return true;
+}
+
+/**
+ * @brief 执行机构线程主循环
+ * @details 1. 无命令时等待：有未到期定时器则最多等到下一个刻度，否则一直等到新命令/停止
+ *          2. 整批取出命令，在锁外先执行命令、再推进时间轮（同一时刻到来的推迟命令先生效，门不会闪断）
+ *          3. 到期且代数未变的定时器复位对应通道
+ *          4. 停止时复位全部仍处于激活状态的通道
+ */
+void Actuator::run() {
+    vector<ActuatorCommand> batch;   // 本轮取出的命令（与queue_交换，容量复用）
+    vector<TimerWheel::Timer> due;   // 本轮到期的定时器
+    batch.reserve(ACTUATOR_QUEUE_SIZE);
+    unique_lock<mutex> lock(mtx_);
+    while (true) {
+        if (queue_.empty() && running_) {
+            Clock::time_point next = wheel_.nextTick();
+            if (next == Clock::time_point::max()) cond_.wait(lock);
+            else cond_.wait_until(lock, next);
+        }
+        batch.swap(queue_);
+        bool stopping = !running_;
+        lock.unlock();
+
+        Clock::time_point now = Clock::now();
+        for (const ActuatorCommand& cmd : batch) apply(cmd, now);
+        batch.clear();
+        due.clear();
+        wheel_.advance(Clock::now(), due);
+        for (const TimerWheel::Timer& t : due) {
+            Channel& ch = channels_[t.channel];
+            if (ch.active && t.gen == ch.gen) drive(t.channel, false, ch.release);
+        }
+        if (stopping) break;
+        lock.lock();
+    }
+    for (size_t i = 0; i < channels_.size(); i++) {
+        if (channels_[i].active) drive(static_cast<int>(i), false, Clock::now());
+    }
+}
+
+void Actuator::apply(const ActuatorCommand& cmd, Clock::time_point now) {
+    int index = static_cast<int>(cmd.channel);
+    Channel& ch = channels_[index];
+    {
+        lock_guard<mutex> lock(mtx_);
+        commands_++;
+    }
+    // 1. 取消：旧定时器全部失效，立即复位
+    if (cmd.op == ActuatorOp::CANCEL) {
+        ch.gen++;
+        if (ch.active) drive(index, false, now);
+        return;
+    }
+    // 2. 去抖
+    if (cmd.debounce_ms > 0 && ch.triggered && now - ch.last_trigger < chrono::milliseconds(cmd.debounce_ms)) {
+        lock_guard<mutex> lock(mtx_);
+        debounced_++;
+        return;
+    }
+    ch.triggered = true;
+    ch.last_trigger = now;
+    Clock::time_point release = now + chrono::milliseconds(cmd.duration_ms);
+    // 3. 已激活：脉冲忽略；延长则推迟复位时刻（代数+1，旧定时器到期后被忽略）
+    if (ch.active) {
+        if (cmd.op == ActuatorOp::EXTEND && release > ch.release) {
+            ch.release = release;
+            wheel_.schedule(release, index, ++ch.gen);
+        }
+        return;
+    }
+    // 4. 未激活：立即激活并登记复位
+    ch.release = release;
+    wheel_.schedule(release, index, ++ch.gen);
+    drive(index, true, cmd.decided);
+}
+
+void Actuator::drive(int index, bool active, Clock::time_point reference) {
+    Channel& ch = channels_[index];
+    backend_->setValue(ch.pin, active ? ch.active_level : !ch.active_level);
+    ch.active = active;
+    double latency = max(0.0, chrono::duration<double, milli>(Clock::now() - reference).count());
+    {
+        lock_guard<mutex> lock(mtx_);
+        if (active) {
+            activations_++;
+            latency_sum_ += latency;
+            latency_max_ = max(latency_max_, latency);
+        } else {
+            release_lag_max_ = max(release_lag_max_, latency);
+        }
+    }
+    if (on_edge_) on_edge_(static_cast<ActuatorChannel>(index), active, latency);
+}
+
+string Actuator::summary() const {
+    lock_guard<mutex> lock(mtx_);
+    return "[执行机构] 后端=" + backend_->name() + " 命令 " + to_string(commands_) + " 条(丢弃 " +
+           to_string(dropped_) + ", 去抖忽略 " + to_string(debounced_) + "), 激活 " + to_string(activations_) +
+           " 次, 判定→激活 平均 " + to_string(activations_ > 0 ? latency_sum_ / activations_ : 0.0) +
+           " ms 最大 " + to_string(latency_max_) + " ms, 复位滞后最大 " + to_string(release_lag_max_) + " ms";
+}
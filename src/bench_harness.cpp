@@ -0,0 +1,188 @@
+/**
+ * @file bench_harness.cpp
+ * @brief 微基准测试框架实现（批大小标定、中位数统计、文本/JSON/CSV输出、基线比较）
+ */
+#include "bench_harness.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+using namespace cv;
+using namespace std;
+
+bool BenchSuite::selected(const string& name) const {
+    return options_.filter.empty() || name.find(options_.filter) != string::npos;
+}
+
+void BenchSuite::run(const string& name, const string& params, const function<void(long long)>& fn) {
+    if (!selected(name)) return;
+    using Clock = chrono::steady_clock;
+    auto elapsed_ms = [](Clock::time_point start) {
+        return chrono::duration<double, milli>(Clock::now() - start).count();
+    };
+
+    // 1. 标定：倍增每批操作数，直到一批耗时达到batch_ms（首次调用同时完成惰性初始化）
+    long long n = 1;
+    for (;;) {
+        auto start = Clock::now();
+        fn(n);
+        double ms = elapsed_ms(start);
+        if (ms >= options_.batch_ms || n >= (1LL << 40)) break;
+        // 按已测耗时估算，最多放大10倍，避免一次跳得过远
+        double factor = ms > 0 ? options_.batch_ms / ms * 1.2 : 10.0;
+        n = max(n + 1, static_cast<long long>(n * min(factor, 10.0)));
+    }
+    // 2. 预热
+    auto warm = Clock::now();
+    while (elapsed_ms(warm) < options_.warmup_ms) fn(n);
+    // 3. 计时
+    vector<double> per_op;
+    for (int b = 0; b < max(1, options_.batches); b++) {
+        auto start = Clock::now();
+        fn(n);
+        per_op.push_back(chrono::duration<double, nano>(Clock::now() - start).count() / static_cast<double>(n));
+    }
+    sort(per_op.begin(), per_op.end());
+    BenchResult r;
+    r.name = name;
+    r.params = params;
+    r.ops_per_batch = n;
+    r.batches = static_cast<int>(per_op.size());
+    r.median_ns = per_op[per_op.size() / 2];
+    r.p90_ns = per_op[min(per_op.size() - 1, per_op.size() * 9 / 10)];
+    r.min_ns = per_op.front();
+    double sum = 0;
+    for (double v : per_op) sum += v;
+    r.mean_ns = sum / static_cast<double>(per_op.size());
+    results_.push_back(r);
+}
+
+//耗时的可读形式（自动选择ns/us/ms）
+static string humanTime(double ns) {
+    char buf[32];
+    if (ns < 1e3) snprintf(buf, sizeof(buf), "%.1f ns", ns);
+    else if (ns < 1e6) snprintf(buf, sizeof(buf), "%.2f us", ns / 1e3);
+    else snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+    return buf;
+}
+
+void BenchSuite::printText(ostream& out) const {
+    size_t width = 4;
+    for (const BenchResult& r : results_) width = max(width, r.name.size());
+    out << left << setw(static_cast<int>(width)) << "用例" << "  " << setw(12) << "中位数" << setw(12) << "p90"
+        << setw(12) << "最小" << "输入\n";
+    for (const BenchResult& r : results_) {
+        out << left << setw(static_cast<int>(width)) << r.name << "  " << setw(12) << humanTime(r.median_ns)
+            << setw(12) << humanTime(r.p90_ns) << setw(12) << humanTime(r.min_ns) << r.params << "\n";
+    }
+}
+
+//JSON字符串转义
+static string jsonQuote(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+//浮点数（保留足够精度，不输出科学计数法之外的本地化格式）
+static string number(double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+string BenchSuite::toJson(const map<string, string>& meta) const {
+    string out = "{\n  \"suite\": \"face_door_bench\",\n  \"format\": 1,\n";
+    for (const auto& kv : meta) out += "  " + jsonQuote(kv.first) + ": " + jsonQuote(kv.second) + ",\n";
+    out += "  \"results\": [\n";
+    for (size_t i = 0; i < results_.size(); i++) {
+        const BenchResult& r = results_[i];
+        out += "    { \"name\": " + jsonQuote(r.name) + ", \"params\": " + jsonQuote(r.params) +
+               ", \"ops_per_batch\": " + to_string(r.ops_per_batch) + ", \"batches\": " + to_string(r.batches) +
+               ", \"median_ns\": " + number(r.median_ns) + ", \"p90_ns\": " + number(r.p90_ns) +
+               ", \"min_ns\": " + number(r.min_ns) + ", \"mean_ns\": " + number(r.mean_ns) + " }" +
+               (i + 1 < results_.size() ? "," : "") + "\n";
+    }
+    return out + "  ]\n}\n";
+}
+
+string BenchSuite::toCsv() const {
+    string out = "name,params,ops_per_batch,batches,median_ns,p90_ns,min_ns,mean_ns\n";
+    for (const BenchResult& r : results_) {
+        string params = r.params;
+        replace(params.begin(), params.end(), ',', ';');// 参数说明中的逗号改为分号，避免拆列
+        out += r.name + "," + params + "," + to_string(r.ops_per_batch) + "," + to_string(r.batches) + "," +
+               number(r.median_ns) + "," + number(r.p90_ns) + "," + number(r.min_ns) + "," + number(r.mean_ns) + "\n";
+    }
+    return out;
+}
+
+bool BenchSuite::loadBaseline(const string& path, map<string, double>& median_ns, string& error) {
+    FileStorage fs;
+    try {
+        if (!fs.open(path, FileStorage::READ | FileStorage::FORMAT_JSON)) {
+            error = "无法打开 " + path;
+            return false;
+        }
+    } catch (const cv::Exception& e) {// 语法错误时OpenCV抛出异常
+        error = path + " 格式错误: " + e.what();
+        return false;
+    }
+    FileNode results = fs["results"];
+    if (results.empty() || !results.isSeq()) {
+        error = path + " 中没有results数组";
+        return false;
+    }
+    median_ns.clear();
+    for (const FileNode& node : results) {
+        string name = static_cast<string>(node["name"]);
+        double median = static_cast<double>(node["median_ns"]);
+        if (!name.empty() && median > 0) median_ns[name] = median;
+    }
+    return true;
+}
+
+int BenchSuite::compare(const map<string, double>& baseline, double tolerance_pct, ostream& out) const {
+    int regressions = 0;
+    size_t width = 4;
+    for (const BenchResult& r : results_) width = max(width, r.name.size());
+    out << "与基线比较（中位数，容差 " << tolerance_pct << "%）:\n";
+    for (const BenchResult& r : results_) {
+        out << "  " << left << setw(static_cast<int>(width)) << r.name << "  ";
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            out << "基线中没有该用例\n";
+            continue;
+        }
+        double change = (r.median_ns / it->second - 1.0) * 100.0;
+        out << setw(12) << humanTime(it->second) << "→ " << setw(12) << humanTime(r.median_ns) << showpos << fixed
+            << setprecision(1) << change << "%" << noshowpos << defaultfloat;
+        if (change > tolerance_pct) {
+            out << "  回归";
+            regressions++;
+        } else if (change < -tolerance_pct) {
+            out << "  改进";
+        }
+        out << "\n";
+    }
+    for (const auto& kv : baseline) {
+        bool found = any_of(results_.begin(), results_.end(), [&](const BenchResult& r) { return r.name == kv.first; });
+        if (!found && selected(kv.first)) out << "  " << kv.first << "  本次未运行（基线中有）\n";
+    }
+    out << (regressions ? to_string(regressions) + " 项回归\n" : string("没有回归\n"));
+    return regressions;
+}
@@ -1,54 +1,119 @@
 #include "door_core.h"     //门禁核心类头文件
-#include "log_util.h"      // 日志工具（postLog/g_log_queue）
-#include "gpio_control.h"  // GPIO硬件控制（开门/报警）
+#include "log_util.h"      // 日志工具（logEvent/postLog/日志线程）
+#include "gpio_control.h"  // GPIO后端（libgpiod/模拟芯片）
 #include "config.h"        // 系统配置参数（常量定义）
-#include <opencv2/face.hpp>// OpenCV人脸识别模块（LBPH算法）
+#include "jpeg_decode.h"   // MJPEG亮度平面解码
+#include "face_tracker.h"  // 先跟踪后检测
+#include "lbph_engine.h"   // 自研LBPH识别引擎（SIMD、批量预测）
+#include "identity_cache.h"// 轨迹身份缓存（多帧投票、确认后跳过识别）
 #include <iostream>        // 标准输入输出（日志打印）
-#include <atomic>          // 原子变量（人脸框/识别结果）
+#include <algorithm>       // stable_sort（人脸按质量得分排序）
+#include <array>           // 人脸批次定长数组
+#include <atomic>          // 原子变量（运行状态）
 #include <opencv2/opencv.hpp>
 #include <thread>
 #include <mutex>
 #include <chrono>          //用于线程延迟
+#include <unistd.h>        // access（检查模型文件是否存在）/getpid
+#include <csignal>         // sigaction（SIGINT/SIGTERM正常退出）
 
 using namespace cv;
-using namespace cv::face;
 using namespace std;
 
 /**
- * @brief 全局LBPH人脸识别器对象
- * @details 全局唯一，在DoorCore构造函数中初始化并加载训练好的模型
+ * @brief 全局LBPH人脸识别引擎对象（当前生效的模型）
+ * @details 全局唯一，在DoorCore构造函数中加载训练好的模型（二进制模型只读映射后原地使用，
+ *          也兼容OpenCV的lbph_model.yml格式）；热更新时由模型监视线程用atomic_exchange整体替换，
+ *          识别线程每个批次用atomic_load取一次，批次内始终使用同一个模型
  *          LBPH：局部二值模式直方图，适合低成本人脸识别场景
+ * @note 引擎内部有计算缓冲，只在识别线程中调用预测
  */
-Ptr<LBPHFaceRecognizer> g_lbph;
+shared_ptr<LbphEngine> g_lbph = make_shared<LbphEngine>();
 
 atomic<bool> is_running_(true); //用于控制所有线程的循环退出，atomic保证多线程读写安全
-atomic<Rect> g_face_rect;       // 人脸矩形框,存储检测到的人脸区域坐标
-atomic<bool> g_recognize_success(false); // 识别结果（true=成功，false=失败）
+FaceOverlayBoard g_overlay;     // 人脸框及各自识别结果（检测/识别线程写，显示循环读）
+
+/**
+ * @brief 加载人脸识别模型：优先MODEL_PATH，不存在时退回旧版YAML模型
+ * @param path 输出：实际加载的模型路径
+ * @return 加载成功的新引擎，失败返回nullptr
+ */
+static shared_ptr<LbphEngine> loadModel(string& path) {
+    auto model = make_shared<LbphEngine>();
+    path = MODEL_PATH;
+    if (model->load(path)) return model;
+    if (access(MODEL_PATH, F_OK) == 0) return nullptr;// 二进制模型存在但损坏：不退回旧模型，保持现状
+    path = MODEL_YML_PATH;
+    if (!model->load(path)) return nullptr;
+    postLog(string("[提示] 使用旧版YAML模型，可用 face_model_convert ") + MODEL_YML_PATH + " " + MODEL_PATH +
+            " 转换为二进制格式以加快启动");
+    return model;
+}
 
 /**
  * @brief 构造函数：初始化门禁系统核心资源
- * @details 1. 初始化GPIO硬件（继电器/蜂鸣器）
- *          2. 创建LBPH人脸识别器实例
- *          3. 加载预训练的人脸识别模型（MODEL_PATH）
- *          4. 输出初始化成功日志
+ * @param source 帧源（为空时使用DEFAULT_FRAME_SOURCE）
+ * @param detector_spec 人脸检测后端描述（haar/lbp/dnn）
+ * @param gpio_spec GPIO后端描述（gpiod[:<芯片设备>] | sim）
+ * @param metrics_spec 指标端点描述（tcp:<地址>:<端口> | unix:<套接字路径> | off）
+ * @param graph 流水线参数（各阶段线程数/绑核/优先级，各边容量/满时策略）
+ * @param preview_spec 预览输出描述（window | mjpeg:<文件> | tcp:<地址>:<端口> | unix:<套接字路径> | off）
+ * @details 1. 初始化GPIO硬件（继电器/蜂鸣器）并启动执行机构线程；真实芯片打开失败时退回模拟芯片
+ *          2. 加载预训练的人脸识别模型（MODEL_PATH）到LBPH识别引擎
+ *          3. 输出初始化成功日志
  */
-DoorCore::DoorCore() {
-    
-    // 设置DISPLAY环境变量：指定X11显示设备
-    setenv("DISPLAY", ":0", 1);
+DoorCore::DoorCore(unique_ptr<FrameSource> source, const string& detector_spec, const string& gpio_spec,
+                   const string& metrics_spec, const PipelineGraph& graph, const string& preview_spec)
+    : source_(move(source)), detector_spec_(detector_spec), metrics_spec_(metrics_spec),
+      preview_spec_(preview_spec), graph_(graph) {
+    // 未指定帧源时使用默认实时摄像头
+    if (!source_) source_ = createFrameSource(DEFAULT_FRAME_SOURCE);
+
     // 禁用GStreamer：避免OpenCV视频采集兼容问题
     setenv("OPENCV_VIDEOIO_DISABLE_GSTREAMER", "1", 1);
     
-    gpioInit();// 初始化GPIO硬件（继电器/蜂鸣器）
-    g_lbph = LBPHFaceRecognizer::create();// 创建LBPH人脸识别器（默认参数：半径1，邻域8，网格8x8，阈值默认）
-    g_lbph->read(MODEL_PATH);             // 加载训练好的模型文件,MODEL_PATH从config.h引入
-    postLog("[系统] 模型加载成功，门禁已就绪");// 记录初始化日志，告知用户系统就绪
-
-    //初始化显示窗口
-    namedWindow("人脸识别门禁系统", WINDOW_NORMAL);
-    resizeWindow("人脸识别门禁系统", 800, 480); // 适配树莓派屏幕
-    g_face_rect = Rect();        // 初始化人脸框为空
-    g_recognize_success = false; // 初始化识别结果
+    // 初始化GPIO硬件（继电器/蜂鸣器），引脚翻转由执行机构线程完成并记录日志
+    auto on_edge = [this](ActuatorChannel channel, bool active, double latency_ms) {
+        if (active) metrics_.stage(Stage::ACTUATE).record(static_cast<int64_t>(latency_ms * 1000));
+        if (channel == ActuatorChannel::DOOR) {
+            if (active) {
+                logEvent(LogEvent::DOOR_OPEN, static_cast<int>(latency_ms));
+                // 采集→继电器吸合：从触发本次开门的帧的采集时刻算起
+                long long capture_ns = door_capture_ns_.load();
+                if (capture_ns > 0) {
+                    long long now_ns = chrono::duration_cast<chrono::nanoseconds>(
+                                           chrono::steady_clock::now().time_since_epoch()).count();
+                    metrics_.stage(Stage::DOOR).record((now_ns - capture_ns) / 1000);
+                }
+            } else {
+                logEvent(LogEvent::DOOR_CLOSED);
+            }
+        } else if (active) {
+            logEvent(LogEvent::ALARM_ON, static_cast<int>(latency_ms));
+        }
+    };
+    actuator_ = make_unique<Actuator>(createGpioBackend(gpio_spec), on_edge);
+    if (!actuator_->start()) {
+        postLog("[错误] GPIO后端初始化失败: " + gpio_spec + "，改用模拟GPIO（不驱动继电器/蜂鸣器）");
+        actuator_ = make_unique<Actuator>(make_unique<SimGpioBackend>(), on_edge);
+        actuator_->start();
+    }
+    // 出入记录目录不可写时只记日志，门禁照常工作
+    if (!journal_.start()) postLog(string("[错误] 无法创建出入记录目录: ") + JOURNAL_DIR);
+    // 加载训练好的模型文件,MODEL_PATH从config.h引入；不存在时退回旧版YAML模型
+    auto load_start = chrono::steady_clock::now();
+    string model_path;
+    if (shared_ptr<LbphEngine> model = loadModel(model_path)) {
+        atomic_store(&g_lbph, model);
+        double load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - load_start).count();
+        postLog("[系统] 模型加载成功(" + model_path + ", " + to_string(model->samples()) + " 个样本, " +
+                to_string(static_cast<int>(load_ms)) + " ms" + (model->mapped() ? ", 只读映射" : "") +
+                ", 卡方距离 " + LbphEngine::simdName() + ")，门禁已就绪");// 记录初始化日志，告知用户系统就绪
+    } else {
+        postLog("[错误] 模型加载失败: " + model_path + "，所有人脸都将判定为未知");
+    }
+
+    g_overlay.setBoxes(0, nullptr, 0);// 初始化人脸框为空
 }
 
 /**
@@ -58,229 +123,657 @@ DoorCore::DoorCore() {
  *          3. 等待所有业务线程结束，避免线程残留/资源泄漏
  */
 DoorCore::~DoorCore() {
+    if (model_watcher_) model_watcher_->stop();// 先停止模型监视（可能正在加载新模型）
+    if (metrics_server_) metrics_server_->stop();// 指标回调引用各成员，先于它们停止
     is_running_ = false;// 设置原子变量为false，所有线程的while循环会退出
-    frame_queue_.stop();// 停止帧队列
+    frame_channel_.stop();// 停止帧通道
     face_queue_.stop(); //人脸队列
-    g_log_queue.stop(); //日志队列,唤醒阻塞的pop线程
+    stopLog();          //日志线程取空缓冲后退出
 
     // 等待各线程结束（需检查joinable，避免重复join崩溃）
     if (cap_thread_.joinable()) cap_thread_.join();      // 采集线程
-    if (detect_thread_.joinable()) detect_thread_.join();// 检测线程
+    for (thread& t : detect_threads_) {                  // 检测工作线程
+        if (t.joinable()) t.join();
+    }
     if (rec_thread_.joinable()) rec_thread_.join();      // 识别线程
     if (log_thread_.joinable()) log_thread_.join();      // 日志线程
- 
-    destroyAllWindows();//销毁窗口
 }
 
 /**
  * @brief 启动门禁系统主函数
  * @details 核心流程：
  *          1. 设置系统运行状态为true
- *          2. 启动4个后台业务线程（采集、检测、识别、日志）
- *          3. 主线程进入显示循环：
- *             - 从帧队列取最新帧
- *             - 绘制人脸框和识别结果提示文字
- *             - 显示画面，监听ESC键退出
- *          4. 退出显示循环后，等待所有线程结束
- *          5. 销毁显示窗口，释放资源
- * @note 主线程负责画面显示和用户交互，后台线程负责数据处理
+ *          2. 启动后台业务线程（采集、若干个检测、识别、日志），各线程按流水线配置绑核/设置优先级
+ *          3. 主线程进入预览循环（见previewLoop），无头模式下只等待退出信号
+ *          4. 退出预览循环后，等待所有线程结束并输出统计
+ * @note 主线程负责画面预览和退出控制，后台线程负责数据处理
  */
 void DoorCore::startSystem() {
     is_running_ = true;// 重置系统运行状态
 
+    // 多个检测线程已经占满核心，关闭OpenCV内部并行，避免线程数超额订阅
+    int detect_workers = graph_.stage("detect").workers;
+    if (detect_workers > 1) setNumThreads(1);
+    postLog(graph_.describe());
+    // 检测线程池共用一个游标（在启动采集前注册，不漏掉第一帧）
+    detect_consumer_ = frame_channel_.subscribe("检测");
+    auto detect_start = chrono::steady_clock::now();
+
+    // 指标：各阶段直方图由业务线程直接写入，队列深度/丢弃数等在导出时读取
+    registerMetrics();
+    metrics_.registerThread("display");// 主线程（显示循环）
+    metrics_server_ = make_unique<MetricsServer>(metrics_, metrics_spec_, [](const string& line) { postLog(line); });
+    if (metrics_server_->start()) {
+        postLog("[系统] 指标端点: " + metrics_server_->address());
+    } else {
+        postLog("[警告] 指标端点启动失败: " + metrics_spec_ + "（只在退出时输出指标摘要）");
+    }
+
     // 启动后台线程
     cap_thread_    = thread(&DoorCore::captureThread, this);
-    detect_thread_ = thread(&DoorCore::detectThread, this);
+    for (int i = 0; i < detect_workers; i++) {
+        detect_threads_.emplace_back(&DoorCore::detectThread, this, i);
+    }
     rec_thread_    = thread(&DoorCore::recognizeThread, this);
     log_thread_    = thread(&DoorCore::logThread, this);
 
-    // 主线程： 初始化显示窗口
-    namedWindow("人脸识别门禁系统", WINDOW_NORMAL);
-    resizeWindow("人脸识别门禁系统", 640, 480);
+    // 模型热更新：监视两种格式的模型文件（重新训练/转换后自动加载），并响应SIGHUP
+    model_watcher_ = make_unique<ModelWatcher>(
+        vector<string>{MODEL_PATH, MODEL_YML_PATH},
+        [this](const string& reason, chrono::steady_clock::time_point detected) { reloadModel(reason, detected); });
+    if (!model_watcher_->start()) {
+        postLog("[警告] 模型监视启动失败，更新模型后需重启门禁程序");
+    } else if (!model_watcher_->watchingFiles()) {
+        postLog("[警告] inotify不可用，模型热更新只响应 kill -HUP " + to_string(getpid()));
+    }
+    // 主线程即显示阶段：在创建完其余线程后才绑核，辅助线程（指标、模型监视、执行机构、出入记录）不受限制
+    applyStage("display");
 
-    // 存储最新帧（用于显示）
-    Mat latest_frame;
-    while (is_running_) {
-         // 非阻塞从帧队列取最新帧（超时则保留上一帧，避免画面卡顿）
-        if (frame_queue_.pop(latest_frame) ){
-            // 成功取到帧，继续显示
-        } else {
-        // 超时，没有新帧，保持上一帧显示
+    // 主线程：预览（按PREVIEW_FPS限速）或无头模式下等待退出
+    previewLoop();
+    is_running_ = false;// ESC/SIGINT/SIGTERM或回放结束，终止所有线程
+
+    // 停止业务队列，唤醒阻塞在pop上的线程，否则join会一直等待
+    frame_channel_.stop();
+    face_queue_.stop();
+
+    // 等待业务线程结束
+    if (cap_thread_.joinable()) cap_thread_.join();
+    for (thread& t : detect_threads_) {
+        if (t.joinable()) t.join();
+    }
+    if (rec_thread_.joinable()) rec_thread_.join();
+    model_watcher_->stop();
+    actuator_->stop();// 复位继电器/蜂鸣器后释放引脚
+    metrics_server_->stop();
+    postLog(metrics_.summary());
+    postLog(actuator_->summary());
+    journal_.stop();// 写完剩余的出入记录
+    postLog(journal_.summary());
+    // 检测吞吐统计（回放测量时用于对比不同版本）
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - detect_start).count();
+    long long detected = detected_frames_;
+    postLog("[检测] " + to_string(detect_workers) + " 个工作线程共检测 " + to_string(detected) +
+            " 帧, 平均 " + to_string(sec > 0 ? detected / sec : 0.0) + " FPS, 重排滞留最多 " +
+            to_string(detect_order_.maxPending()) + " 帧");
+    postLog("[检测] 全图检测 " + to_string(tracker_.fullScans()) + " 次, 局部搜索 " +
+            to_string(tracker_.roiScans()) + " 次, 跟踪丢失 " + to_string(tracker_.lostCount()) + " 次");
+    postLog(quality_.summary());
+    postLog(idle_.summary());
+    postLog(face_pool_.summary());
+    postLog("[人脸队列] 队列满丢弃 " + to_string(face_queue_.dropped()) + " 个批次");
+    postLog(frame_channel_.summary());// 各消费者收帧/丢帧统计
+    // 业务线程退出前的统计日志输出完毕后再停止日志线程
+    stopLog();
+    if (log_thread_.joinable()) log_thread_.join();
+}
+
+//SIGINT/SIGTERM：请求正常退出（复位继电器、写完出入记录和日志）
+static volatile sig_atomic_t g_stop_signal = 0;
+static void onStopSignal(int) { g_stop_signal = 1; }
+
+//两次快照的人脸框和识别结果是否相同（帧序号不参与比较：无人脸时每帧都会更新）
+static bool sameOverlay(const FaceOverlay& a, const FaceOverlay& b) {
+    if (a.count != b.count) return false;
+    for (int i = 0; i < a.count; i++) {
+        if (a.boxes[i] != b.boxes[i] || a.labels[i] != b.labels[i] || a.states[i] != b.states[i]) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 预览循环（主线程）
+ * @details 1. 预览输出为off（无头模式）时不订阅帧通道、不解码、不绘制，只等待退出信号或回放结束
+ *          2. 否则每1/PREVIEW_FPS秒从帧通道取一次最新帧（其余帧在通道中被跳过，不解码彩色）
+ *          3. 有新帧或人脸框/识别结果变化时才绘制并写入预览输出，否则保持上一次的画面
+ *          4. 窗口中按ESC、收到SIGINT/SIGTERM或回放结束时返回；预览输出打开/写入失败时退回无头模式
+ */
+void DoorCore::previewLoop() {
+    struct sigaction sa = {};
+    sa.sa_handler = onStopSignal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    unique_ptr<PreviewSink> sink;
+    if (preview_spec_ != "off") {
+        sink = createPreviewSink(preview_spec_);
+        if (!sink || !sink->open()) {
+            postLog("[警告] 预览输出打开失败: " + preview_spec_ + "，改为无头模式");
+            sink.reset();
         }
+    }
+    if (!sink) {
+        postLog("[显示] 无头模式（不取帧、不绘制），SIGINT/SIGTERM退出");
+        while (is_running_ && !g_stop_signal) this_thread::sleep_for(chrono::milliseconds(100));
+        return;
+    }
+    postLog("[显示] 预览输出: " + sink->name() + ", 最多 " + to_string(PREVIEW_FPS) + " FPS");
 
-        // 仅当有有效帧时才绘制和显示
-        if (!latest_frame.empty()) {
-            // 克隆帧（避免原帧被其他线程修改）
-            Mat show_frame = latest_frame.clone();
-            // 读取人脸框
-            Rect face_rect = g_face_rect;
-            // 检测到人脸时绘制人脸框和提示文字
-            if (!face_rect.empty()) {
-                 // 识别成功→绿色，识别失败→红色
-                Scalar color = g_recognize_success ? Scalar(0,255,0) : Scalar(0,0,255);
-                // 绘制人脸矩形框（线宽2）
-                rectangle(show_frame, face_rect, color, 2);
-                // 提示文字内容
-                string text = g_recognize_success ? "识别成功 - 开门" : "识别失败 - 报警";
-                // 绘制提示文字（位置：人脸框上方10像素，字体大小0.8，线宽2）
-                putText(show_frame, text, Point(face_rect.x, face_rect.y - 10),  
-                FONT_HERSHEY_SIMPLEX, 0.8, color, 2);
+    const auto period = chrono::microseconds(1000000 / max(1, PREVIEW_FPS));
+    auto next = chrono::steady_clock::now();
+    FrameRef latest_frame;
+    Mat color_frame;// 最新帧的彩色图像（灰度解码模式下只为真正预览的帧解码彩色）
+    Mat show_frame; // 绘制缓冲，尺寸不变时copyTo复用同一块内存
+    FaceOverlay drawn;        // 上一次绘制的叠加层
+    bool has_drawn = false;   // 是否已绘制过
+    int consumer = frame_channel_.subscribe("显示");// 显示循环独立游标，不和检测线程抢帧
+    while (is_running_ && !g_stop_signal) {
+        // 处理界面/连接事件直到下一个预览时刻
+        auto now = chrono::steady_clock::now();
+        int wait_ms = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(next - now).count());
+        if (sink->poll(min(max(wait_ms, 0), FRAME_WAIT_MS))) break;// 按ESC退出
+        if (chrono::steady_clock::now() < next) continue;
+        next += period;
+        if (next < chrono::steady_clock::now()) next = chrono::steady_clock::now() + period;// 落后时不追赶
+
+        // 取最新帧（不等待）：得到彩色图像后立即归还槽位
+        bool new_frame = frame_channel_.popLatest(consumer, latest_frame, chrono::milliseconds(0));
+        if (new_frame) {
+            vector<unsigned char>& jpeg = latest_frame.jpeg();
+            if (!jpeg.empty()) {
+                // 灰度解码模式：从MJPEG原始数据解码彩色（color_frame尺寸不变时复用缓冲）
+                imdecode(Mat(1, static_cast<int>(jpeg.size()), CV_8UC1, jpeg.data()), IMREAD_COLOR, &color_frame);
+            } else {
+                latest_frame.mat().copyTo(color_frame);
             }
-            // 显示处理后的画面
-            imshow("人脸识别门禁系统", show_frame);
+            latest_frame.reset();
         }
+        FaceOverlay overlay = g_overlay.snapshot();
+        // 画面和识别结果都没变：不重绘，保持上一次的画面
+        if (color_frame.empty() || (!new_frame && has_drawn && sameOverlay(overlay, drawn))) continue;
 
-            if (waitKey(1) == 27) { // 按ESC退出
-                is_running_ = false;// 设置运行状态为false，终止所有线程
-                break;
+        // 拷贝到绘制缓冲（保留未绘制的原图，无新帧时在原图上重新叠加最新识别结果）
+        color_frame.copyTo(show_frame);
+        // 每张人脸各自绘制人脸框和提示文字
+        for (int i = 0; i < overlay.count; i++) {
+            const Rect& face_rect = overlay.boxes[i];
+            // 识别成功→绿色，识别失败→红色，尚未识别→黄色
+            Scalar color;
+            string text;
+            if (overlay.states[i] == FaceState::ACCEPTED) {
+                color = Scalar(0,255,0);
+                text = "识别成功 ID=" + to_string(overlay.labels[i]) + " - 开门";
+            } else if (overlay.states[i] == FaceState::REJECTED) {
+                color = Scalar(0,0,255);
+                text = "识别失败 - 报警";
+            } else {
+                color = Scalar(0,255,255);
+                text = "识别中";
             }
+            // 绘制人脸矩形框（线宽2）
+            rectangle(show_frame, face_rect, color, 2);
+            // 绘制提示文字（位置：人脸框上方10像素，字体大小0.8，线宽2）
+            putText(show_frame, text, Point(face_rect.x, face_rect.y - 10),
+            FONT_HERSHEY_SIMPLEX, 0.8, color, 2);
         }
-
-    // 等待所有线程结束
-    if (cap_thread_.joinable()) cap_thread_.join();
-    if (detect_thread_.joinable()) detect_thread_.join();
-    if (rec_thread_.joinable()) rec_thread_.join();
-    if (log_thread_.joinable()) log_thread_.join();
-
-    destroyAllWindows();// 销毁显示窗口，释放资源
+        if (!sink->write(show_frame)) {
+            postLog("[警告] 预览输出写入失败: " + sink->name() + "，改为无头模式");
+            sink.reset();
+            while (is_running_ && !g_stop_signal) this_thread::sleep_for(chrono::milliseconds(100));
+            return;
+        }
+        drawn = overlay;
+        has_drawn = true;
+        preview_frames_++;
+    }
 }
 
 /**
- * @brief 摄像头采集线程：采集视频帧并写入帧队列
+ * @brief 采集线程：从帧源采集视频帧并广播到帧通道
  * @details 核心流程：
- *          1. 延迟2秒启动（等待系统初始化完成）
- *          2. 打开V4L2摄像头（设备0，树莓派默认摄像头）
- *          3. 配置摄像头参数（MJPG格式、640x480分辨率、25FPS）
- *          4. 循环采集帧，写入帧队列（线程安全）
- *          5. 系统停止时退出循环，释放摄像头资源
+ *          1. 实时摄像头延迟CAMERA_WARMUP_MS启动（等待系统初始化完成），回放源不等待
+ *          2. 打开帧源（V4L2摄像头/录像/图片目录/合成画面）
+ *          3. 循环采集帧，广播到帧通道（线程安全，满时覆盖最旧帧）；
+ *             空闲状态下每IDLE_FRAME_SKIP帧只解码1帧
+ *          4. 回放源播放完毕时输出帧数与平均FPS，并停止整个系统
+ *          5. 系统停止时退出循环，释放帧源资源
  */
 void DoorCore::captureThread() {
-    // 延迟2秒启动：等待构造函数初始化完成，避免摄像头抢占资源
-    this_thread::sleep_for(chrono::seconds(2));
-    // 打开摄像头
-    VideoCapture cap(0, CAP_V4L2);
-    if (!cap.isOpened()) {
-        postLog("[错误] 摄像头打开失败");
+    applyStage("capture");
+    // 实时摄像头延迟启动：等待构造函数初始化完成，避免摄像头抢占资源
+    if (source_->isLive()) this_thread::sleep_for(chrono::milliseconds(CAMERA_WARMUP_MS));
+    // 打开帧源
+    if (!source_->open()) {
+        postLog("[错误] 帧源打开失败: " + source_->name());
         return;
     }
+    // 帧源能直接提供MJPEG原始数据时，只解码亮度平面（可DCT域缩小），彩色留给显示按需解码
+    bool gray_mode = MJPEG_GRAY_DECODE && source_->supportsJpeg();
+    if (gray_mode) {
+        Size gray_size = jpegScaledSize(CAMERA_WIDTH, CAMERA_HEIGHT, MJPEG_SCALE_DENOM);
+        frame_pool_ = make_unique<FramePool>("frame", graph_.framePoolSize(), gray_size.height, gray_size.width,
+                                             CV_8UC1, MJPEG_RESERVE_BYTES);
+    } else {
+        frame_pool_ = make_unique<FramePool>("frame", graph_.framePoolSize(), CAMERA_HEIGHT, CAMERA_WIDTH, CV_8UC3);
+    }
+    ThreadCpuScope cpu_scope(metrics_, "capture");// 退出时记下最终CPU时间（停止摘要在join之后输出）
+    postLog("[线程] 采集线程启动(" + source_->name() + (gray_mode ? ", MJPEG灰度解码 1/" +
+            to_string(MJPEG_SCALE_DENOM) : string(", BGR解码")) + ")");// 记录线程启动日志
 
-    // 强制使用 MJPG 格式
-    cap.set(CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
-    // 设置采集分辨率：640x480（平衡清晰度和性能）
-    cap.set(CAP_PROP_FRAME_WIDTH, 640);
-    cap.set(CAP_PROP_FRAME_HEIGHT, 480);
-    // 设置帧率：25FPS
-    cap.set(CAP_PROP_FPS, 25);
-
-    postLog("[线程] 采集线程启动(MJPG格式)");// 记录线程启动日志
-
-    // 存储采集到的帧
-    Mat frame;
+    Mat scratch;                     // 帧池耗尽时的临时缓冲：仍要读帧，避免摄像头驱动缓冲积压旧帧
+    vector<unsigned char> scratch_jpeg;// 同上（灰度解码模式，只读取不解码）
+    long long frame_count = 0;// 已采集帧数（用于回放统计FPS，同时作为帧序号）
+    auto start = chrono::steady_clock::now();
+    int idle_skip = 0;        // 空闲状态下已连续跳过的帧数
     while (is_running_) {
+        // 空闲状态：每IDLE_FRAME_SKIP帧只处理1帧，其余帧只出队不解码
+        // （摄像头仍按全速输出，恢复活跃时无需重新协商帧率，下一帧即恢复全速）
+        if (idle_.isIdle()) {
+            if (++idle_skip < IDLE_FRAME_SKIP && source_->skip()) {
+                frame_count++;
+                continue;
+            }
+            idle_skip = 0;
+        }
+        // 从帧池取空闲槽位，直接解码到槽位缓冲（不再clone）
+        auto read_start = chrono::steady_clock::now();
+        FrameRef slot = frame_pool_->acquire();
+        bool ok;
+        if (gray_mode) {
+            // 原始数据存入槽位（显示时用于解码彩色），亮度平面解码到槽位图像
+            vector<unsigned char>& jpeg = slot.empty() ? scratch_jpeg : slot.jpeg();
+            ok = source_->readJpeg(jpeg) &&
+                 (slot.empty() || decodeJpegGray(jpeg.data(), jpeg.size(), slot.mat(), MJPEG_SCALE_DENOM));
+        } else {
+            Mat& target = slot.empty() ? scratch : slot.mat();
+            ok = source_->read(target) && !target.empty();
+        }
         // 采集一帧并检查有效性
-        if (cap.read(frame) && !frame.empty()) {
-            // 将帧克隆后写入帧队列（避免原帧被覆盖）
-            frame_queue_.push(frame.clone());
+        if (ok) {
+            frame_count++;
+            if (slot.empty()) continue;// 帧池耗尽：下游处理不过来，丢弃本帧
+            frame_pool_->commit(slot); // 核对是否发生了堆分配
+            auto captured = chrono::steady_clock::now();
+            metrics_.stage(Stage::CAPTURE).record(
+                chrono::duration_cast<chrono::microseconds>(captured - read_start).count());
+            slot.setMeta(frame_count, captured);
+            slot.setScale(gray_mode ? MJPEG_SCALE_DENOM : 1);
+            // 广播到帧通道（只传递引用；通道满时覆盖最旧帧，被覆盖的槽位立即回收）
+            frame_channel_.publish(slot);
+        } else if (source_->finished()) {
+            // 回放结束：输出统计后停止系统
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            postLog("[采集] 回放结束: " + to_string(frame_count) + " 帧, 平均 " +
+                    to_string(sec > 0 ? frame_count / sec : 0.0) + " FPS");
+            is_running_ = false;
+            frame_channel_.stop();// 唤醒等待新帧的显示循环和检测线程
+            break;
         } else {
              // 采集失败时短暂休眠（避免空循环占用CPU）
             this_thread::sleep_for(chrono::milliseconds(10));
         }
     }
+    source_->release();
+    postLog(frame_pool_->summary());
 }
 
 /**
- * @brief 人脸检测线程：从帧队列取帧，检测人脸并存入人脸队列
+ * @brief 人脸检测工作线程：从帧通道取最新帧检测人脸，结果交给重排序缓冲按帧顺序输出
+ * @param worker_id 工作线程编号（用于日志）
  * @details 核心流程：
- *          1. 加载Haar级联分类器（预训练人脸检测模型）
- *          2. 循环从帧队列取帧，预处理（转灰度图+直方图均衡化）
- *          3. 检测人脸，取第一个人脸区域存入人脸队列
- *          4. 更新全局人脸框原子变量（供主线程绘制）
- *          5. 系统停止时退出循环
+ *          1. 创建本线程独立的人脸检测器（检测器内部有可变状态，不能跨线程共用）
+ *          2. 在取帧锁内从共享游标取最新帧并领取票号，保证票号顺序与帧顺序一致
+ *          3. 预处理（转灰度图+直方图均衡化）；空闲状态下先做降采样帧差，画面静止则跳过检测
+ *          4. 按跟踪器当前状态生成检测计划，在锁外执行检测（全图或上一帧人脸附近）
+ *          5. 质量门限：在未均衡化的亮度图上给每张人脸评分（尺寸/清晰度/曝光/正脸程度），按得分排序；
+ *             合格的人脸缩放到FACE_CANONICAL_SIZE拷贝到人脸池，不合格的只保留人脸框（不送识别）
+ *          6. 无论是否检测都以本票号提交结果，由publishDetectResult按帧顺序更新跟踪状态、
+ *             空闲状态、人脸框并把批次送入人脸队列
+ *          7. 系统停止时退出循环
  * @note 预处理步骤（灰度+均衡化）大幅提升低光照下的检测准确率
  */
-void DoorCore::detectThread() {
-    postLog("[线程] 检测线程启动");
-    // 创建Haar级联分类器（用于人脸检测）
-    CascadeClassifier face_cascade;
-    // 加载预训练的人脸检测器模型（HAAR_PATH从config.h引入）
-    face_cascade.load(HAAR_PATH);
+void DoorCore::detectThread(int worker_id) {
+    applyStage("detect");
+    // 创建人脸检测器（后端由detector_spec_指定），每个工作线程一份
+    unique_ptr<FaceDetector> detector = createFaceDetector(detector_spec_);
+    if (!detector || !detector->load()) {
+        postLog("[错误] 检测线程" + to_string(worker_id) + " 人脸检测器加载失败: " + detector_spec_);
+        return;
+    }
+    postLog("[线程] 检测线程" + to_string(worker_id) + "启动(" + detector->name() + ")");
+    ThreadCpuScope cpu_scope(metrics_, "detect" + to_string(worker_id));
 
-    Mat frame, gray;   // 原始帧、灰度帧
-    vector<Rect> faces;// 存储检测到的人脸矩形区域
+    FrameRef frame;    // 原始帧（帧池槽位引用）
+    Mat gray;          // 灰度帧（线程内复用，尺寸不变时不再分配）
+    Mat equalized;     // 均衡化后的灰度帧（检测与识别使用，亮度图保留给质量评分）
+    FaceQualityGate quality;          // 人脸质量评分（内部缓冲复用）
+    vector<pair<FaceQuality, Rect>> scored;// 本帧各人脸的评分（排序用，容量复用）
+    DetectResult result;// 本帧检测结果（提交时与重排序缓冲中的旧结果交换，容量复用）
 
     // 循环检测，直到系统停止
     while (is_running_) {
-        // 从帧队列阻塞取帧（队列空则等待，stop则返回false）
-        if (!frame_queue_.pop(frame)) continue;
-        // 转为灰度图（人脸检测需灰度图，减少计算量）
-        cvtColor(frame, gray, COLOR_BGR2GRAY);
-        // 直方图均衡化（增强对比度，提升检测准确率）
-        equalizeHist(gray, gray);
-        // 检测人脸：参数（灰度图，人脸区域，缩放因子，邻域数，过滤规则，最小人脸尺寸）
-        face_cascade.detectMultiScale(gray, faces, 1.1, 4, 0, Size(60, 60));
-        // 检测到人脸时，取第一个人脸区域存入人脸队列
-        if (!faces.empty()) {
-            face_queue_.push(gray(faces[0]));// gray(faces[0])：截取人脸区域
-            g_face_rect = faces[0];//记录人脸矩形框坐标
-        }else{
-             g_face_rect = Rect();//无人脸时清空矩形框
+        unsigned long long ticket;
+        {
+            // 取帧与领票号在同一把锁内完成：先取到的帧一定拿到更小的票号
+            lock_guard<mutex> lock(detect_mtx_);
+            // 从帧通道取最新帧（跳过处理不过来的旧帧，超时/停止则返回false）
+            if (!frame_channel_.popLatest(detect_consumer_, frame, chrono::milliseconds(FRAME_WAIT_MS))) continue;
+            ticket = detect_ticket_++;
+        }
+        auto detect_start = chrono::steady_clock::now();
+        metrics_.stage(Stage::DETECT_WAIT).record(
+            chrono::duration_cast<chrono::microseconds>(detect_start - frame.captureTime()).count());
+        result.detected = false;
+        result.faces.clear();
+        result.batch.count = 0;
+        result.batch.frame_id = frame.seq();
+        result.batch.capture_ts = frame.captureTime();
+        result.scale = frame.scale();// 灰度图相对原始分辨率的缩小倍数
+        // 亮度图：MJPEG灰度解码模式下帧本身就是亮度平面，否则转为灰度图（人脸检测需灰度图，减少计算量）
+        bool gray_frame = frame.mat().channels() == 1;
+        if (!gray_frame) cvtColor(frame.mat(), gray, COLOR_BGR2GRAY);
+        const Mat& luma = gray_frame ? frame.mat() : gray;
+        {
+            // 运动门限：空闲状态下画面静止则跳过本帧检测（帧差用未均衡化的亮度图，避免放大噪声）
+            lock_guard<mutex> lock(idle_mtx_);
+            result.detected = idle_.onFrame(motion_gate_.update(luma));
+        }
+        if (result.detected) {
+            // 直方图均衡化（增强对比度，提升检测准确率）；均衡化到线程内缓冲，亮度图保留给质量评分
+            equalizeHist(luma, equalized);
+            // 亮度图为线程内缓冲时提前归还整帧槽位，采集线程可立即复用（灰度帧本身就是亮度图，评分后再归还）
+            if (!gray_frame) frame.reset();
+            // 检测人脸：每隔TRACK_FULL_SCAN_INTERVAL帧或跟踪丢失后全图检测，其余帧只搜索上一帧人脸附近
+            // 最小人脸尺寸随缩放倍数同比缩小，保证检出的实际人脸大小不变
+            tracker_.plan(equalized.size(), result.plan);
+            int min_face = FACE_MIN_SIZE / result.scale;
+            FaceTracker::run(*detector, equalized, result.plan, result.faces, Size(min_face, min_face));
+            // 质量评分：合格的人脸在前、按得分从高到低（人脸超过MAX_FACES_PER_FRAME张时优先送最好的）
+            scored.clear();
+            for (const Rect& f : result.faces) {
+                FaceQuality q;
+                if (QUALITY_GATE) q = quality.evaluate(luma(f), result.scale);
+                else q.score = 1.0;
+                quality_.record(q.reason);
+                scored.emplace_back(q, f);
+            }
+            stable_sort(scored.begin(), scored.end(), [](const pair<FaceQuality, Rect>& a,
+                                                         const pair<FaceQuality, Rect>& b) {
+                return a.first.score > b.first.score;
+            });
+            for (size_t i = 0; i < scored.size(); i++) result.faces[i] = scored[i].second;
+            // 合格的人脸（最多MAX_FACES_PER_FRAME张）缩放到统一尺寸拷贝到紧凑的人脸池槽位（ROI视图会让
+            // 整张灰度图一直被队列持有，而且下一帧会原地改写它）；不合格或人脸池耗尽时该人脸为空引用
+            FaceBatch& batch = result.batch;
+            batch.count = min(static_cast<int>(result.faces.size()), MAX_FACES_PER_FRAME);
+            Size canonical(FACE_CANONICAL_SIZE, FACE_CANONICAL_SIZE);
+            for (int i = 0; i < batch.count; i++) {
+                if (scored[i].first.reason != QualityReason::OK) continue;
+                batch.crops[i] = face_pool_.copyFrom(equalized(result.faces[i]), canonical);
+                if (!batch.crops[i].empty()) batch.crops[i].setMeta(batch.frame_id, batch.capture_ts);
+            }
         }
+        frame.reset();
+        metrics_.stage(Stage::DETECT).recordSince(detect_start);
+        // 跳过检测的帧也要提交，保证票号连续
+        detect_order_.submit(ticket, result, [this](DetectResult& r) { publishDetectResult(r); });
+    }
+}
+
+/**
+ * @brief 按帧顺序输出一帧检测结果（在重排序缓冲锁内调用）
+ * @details 1. 跳过检测的帧：清空人脸框
+ *          2. 用本帧结果更新跟踪状态和空闲状态（必须按帧顺序，否则跟踪会退回旧位置）
+ *          3. 有人脸时更新全部人脸框（换算回原始分辨率，供显示绘制），分配轨迹ID，批次送入人脸队列
+ */
+void DoorCore::publishDetectResult(DetectResult& result) {
+    detected_frames_++;
+    FaceBatch& batch = result.batch;
+    if (!result.detected) {
+        g_overlay.setBoxes(batch.frame_id, nullptr, 0);
+        return;
+    }
+    tracker_.commit(result.plan, result.faces);
+    {
+        lock_guard<mutex> lock(idle_mtx_);
+        idle_.onDetectResult(!result.faces.empty());// 持续无人脸时进入空闲状态
+    }
+    // 人脸框换算回原始分辨率（无人脸时count=0，即清空人脸框）
+    int scale = result.scale;
+    bool has_crop = false;
+    for (int i = 0; i < batch.count; i++) {
+        const Rect& f = result.faces[i];
+        batch.boxes[i] = Rect(f.x * scale, f.y * scale, f.width * scale, f.height * scale);
+        has_crop = has_crop || !batch.crops[i].empty();
+    }
+    track_ids_.assign(batch.boxes.data(), batch.count, batch.track_ids.data());
+    g_overlay.setBoxes(batch.frame_id, batch.boxes.data(), batch.count);
+    batch.queued_ts = chrono::steady_clock::now();
+    if (has_crop) {
+        // reject：队列满时丢弃本批次，batch不变；overwrite_oldest：丢弃最旧的批次，识别线程总拿到最新的人脸；
+        // block：等待识别线程取走（检测线程池随之暂停，帧通道覆盖旧帧）
+        face_queue_.push(move(batch), graph_.edge("faces").policy);
     }
+    // 结果留在重排序缓冲中复用，未送出的人脸池槽位在此归还
+    for (FrameRef& crop : batch.crops) crop.reset();
 }
 
 /**
- * @brief 人脸识别线程：从人脸队列取人脸，识别并控制硬件
+ * @brief 人脸识别线程：从人脸队列取人脸批次，按轨迹投票判定并投递开门/报警命令
  * @details 核心流程：
- *          1. 循环从人脸队列取人脸图像
- *          2. 调用LBPH模型预测（输出标签+置信度）
- *          3. 判断识别结果：
- *             - 成功（标签有效+置信度<阈值）：记录日志→开门→更新识别结果
- *             - 失败（标签无效/置信度≥阈值）：记录日志→报警→更新识别结果
- *          4. 系统停止时退出循环
+ *          1. 循环从人脸队列取一帧的人脸批次
+ *          2. 逐张查轨迹身份缓存：已确认且未到复核时间的轨迹直接沿用确认结果，跳过识别
+ *          3. 其余人脸批量预测（画廊只扫描一遍），统计采集时刻→判定的延迟
+ *          4. 识别结果（成功=标签有效+置信度<阈值）投入各自轨迹的投票窗口：
+ *             - 轨迹确认：记录日志并开门（每条轨迹一次，人站在门前不再反复开门）
+ *             - 轨迹判定为未知人脸：记录日志并报警（每条轨迹一次）
+ *             开门/报警只是投递给执行机构线程的命令，识别线程不等待继电器/蜂鸣器
+ *             - 复核未通过：撤销确认，重新投票
+ *          5. 各人脸所属轨迹的状态写回叠加层（按帧序号对应回人脸框）
+ *          6. 系统停止时退出循环，输出识别次数与缓存节省统计
  * @note LBPH置信度越小表示匹配度越高，阈值从config.h的RECOGNIZE_THRESHOLD获取
  */
 void DoorCore::recognizeThread() {
+    applyStage("recognize");
     postLog("[线程] 识别线程启动");
-    Mat face;          // 存储人脸图像
-    int label = -1;    // 识别标签（-1表示未识别）
-    double conf = 0.0; // 置信度（距离值，越小越相似）
+    ThreadCpuScope cpu_scope(metrics_, "recognize");
+    FaceBatch batch;   // 一帧的人脸批次（人脸池槽位引用）
+    IdentityCache cache;// 轨迹身份缓存
+    array<Mat, MAX_FACES_PER_FRAME> faces;   // 需要识别的人脸图像
+    array<int, MAX_FACES_PER_FRAME> slots;   // faces对应的批次下标
+    array<Rect, MAX_FACES_PER_FRAME> boxes;  // 批次中有效人脸的人脸框
+    array<int, MAX_FACES_PER_FRAME> tracks;  // 与boxes对应的轨迹ID
+    array<int, MAX_FACES_PER_FRAME> labels;  // 用户ID（-1表示未识别）
+    array<double, MAX_FACES_PER_FRAME> confs;// 置信度（距离值，越小越相似）
+    array<FaceState, MAX_FACES_PER_FRAME> states;// 各人脸所属轨迹的状态
+    long long decisions = 0, faces_total = 0;     // 做过识别的批次数/人脸数
+    double latency_sum = 0.0, latency_max = 0.0;  // 采集→判定延迟累计/最大值（毫秒）
+    auto start = chrono::steady_clock::now();
 
     // 循环识别，直到系统停止
     while (is_running_) {
-        // 从人脸队列阻塞取人脸（队列空则等待，stop则返回false）
-        if (!face_queue_.pop(face)) continue;
-        // LBPH模型预测：输入人脸，输出标签+置信度
-        g_lbph->predict(face, label, conf);
-        // 识别成功：标签有效 且 置信度<阈值（RECOGNIZE_THRESHOLD=50）
-        if (label != -1 && conf < RECOGNIZE_THRESHOLD) {
-            postLog("[成功] ID=" + to_string(label) + " 置信度=" + to_string((int)conf));
-            openDoorDelay();// 调用GPIO控制函数，开门2秒
-            g_recognize_success = true;//记录识别成功
-        } else {
-            postLog("[失败] 未知人脸，置信度=" + to_string((int)conf));
-            alarmBeep(); // 调用GPIO控制函数，蜂鸣器报警0.5秒
-            g_recognize_success = false;//记录识别失败
+        // 从人脸队列阻塞取批次（队列空则等待，stop则返回false）
+        if (!face_queue_.pop(batch)) continue;
+        auto now = chrono::steady_clock::now();
+        metrics_.stage(Stage::RECOGNIZE_WAIT).record(
+            chrono::duration_cast<chrono::microseconds>(now - batch.queued_ts).count());
+        // 收集有效人脸（人脸池耗尽时的空引用跳过），已确认的轨迹跳过识别
+        int valid = 0, n = 0;
+        for (int i = 0; i < batch.count; i++) {
+            if (batch.crops[i].empty()) continue;
+            boxes[valid] = batch.boxes[i];
+            tracks[valid] = batch.track_ids[i];
+            if (cache.needsPredict(tracks[valid], now, labels[valid])) {
+                faces[n] = batch.crops[i].mat();
+                slots[n] = valid;
+                n++;
+            }
+            valid++;
+        }
+        if (valid == 0) continue;
+        bool open_door = false, alarm = false;
+        auto decided = now;// 做出判定的时刻（执行机构据此统计判定→引脚翻转延迟）
+        if (n > 0) {
+            // 批量预测：输入需要识别的人脸，输出各自的标签+置信度
+            // 本批次持有当前模型的引用：热更新在此期间发生时，本批次仍用旧模型完成
+            array<int, MAX_FACES_PER_FRAME> pred_labels;
+            array<double, MAX_FACES_PER_FRAME> pred_confs;
+            auto predict_start = chrono::steady_clock::now();
+            atomic_load(&g_lbph)->predictBatch(faces.data(), n, pred_labels.data(), pred_confs.data());
+            // 判定延迟：从该帧采集时刻到做出判定（不含开门/报警的执行时间）
+            decided = chrono::steady_clock::now();
+            double latency = chrono::duration<double, milli>(decided - batch.capture_ts).count();
+            metrics_.stage(Stage::RECOGNIZE).record(
+                chrono::duration_cast<chrono::microseconds>(decided - predict_start).count());
+            metrics_.stage(Stage::DECISION).record(static_cast<int64_t>(latency * 1000));
+            decisions++;
+            faces_total += n;
+            latency_sum += latency;
+            latency_max = max(latency_max, latency);
+            for (int k = 0; k < n; k++) {
+                int i = slots[k];
+                labels[i] = pred_labels[k];
+                confs[i] = pred_confs[k];
+                // 识别成功：标签有效 且 置信度<阈值（RECOGNIZE_THRESHOLD=50）
+                bool accepted = labels[i] != -1 && confs[i] < RECOGNIZE_THRESHOLD;
+                switch (cache.addResult(tracks[i], labels[i], accepted, now)) {
+                case TrackVerdict::CONFIRMED:
+                    open_door = true;
+                    logEvent(LogEvent::RECOG_CONFIRMED, batch.frame_id, tracks[i], labels[i], confs[i],
+                             cache.votes(tracks[i]), (int)latency);
+                    journal_.append(JournalVerdict::CONFIRMED, labels[i], confs[i], tracks[i], faces[k]);
+                    break;
+                case TrackVerdict::REJECTED:
+                    alarm = true;
+                    logEvent(LogEvent::RECOG_REJECTED, batch.frame_id, tracks[i], confs[i],
+                             cache.votes(tracks[i]), (int)latency);
+                    journal_.append(JournalVerdict::REJECTED, labels[i], confs[i], tracks[i], faces[k]);
+                    break;
+                case TrackVerdict::REVOKED:
+                    logEvent(LogEvent::RECOG_REVOKED, batch.frame_id, tracks[i], labels[i], confs[i]);
+                    journal_.append(JournalVerdict::REVOKED, labels[i], confs[i], tracks[i], faces[k]);
+                    break;
+                case TrackVerdict::NONE:
+                    break;
+                }
+            }
+        }
+        // 预测完成即归还人脸池槽位
+        for (int k = 0; k < n; k++) faces[k].release();
+        for (int i = 0; i < batch.count; i++) batch.crops[i].reset();
+        // 各人脸所属轨迹的状态写回叠加层
+        for (int i = 0; i < valid; i++) {
+            states[i] = cache.state(tracks[i]);
+            labels[i] = cache.label(tracks[i]);
+        }
+        g_overlay.setResults(batch.frame_id, boxes.data(), labels.data(), states.data(), valid);
+        cache.expire(now);
+        // 投递给执行机构后立即返回（开门/报警期间识别照常进行）
+        if (open_door) {
+            door_capture_ns_ = chrono::duration_cast<chrono::nanoseconds>(batch.capture_ts.time_since_epoch()).count();
+            actuator_->openDoor(decided);// 开门DOOR_OPEN_MS，门已打开时从本次判定起重新计时
+        } else if (alarm) {
+            actuator_->alarm(decided);   // 蜂鸣器报警ALARM_BEEP_MS（ALARM_DEBOUNCE_MS内只响一次）
         }
     }
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    postLog("[识别] 共识别 " + to_string(decisions) + " 帧 " + to_string(faces_total) +
+            " 张人脸, 平均延迟 " + to_string(decisions > 0 ? latency_sum / decisions : 0.0) +
+            " ms, 最大延迟 " + to_string(latency_max) + " ms");
+    postLog(cache.summary(sec));
 }
 
 /**
- * @brief 日志线程：异步输出日志到控制台
- * @details 核心流程：
- *          1. 循环从全局日志队列取日志消息
- *          2. 将消息打印到控制台（std::cout）
- *          3. 系统停止时退出循环
+ * @brief 模型热更新：在模型监视线程中加载新模型，原子替换后旧模型随最后一个引用释放
+ * @details 1. 加载失败（文件损坏、写入未完成等）时保留当前模型继续识别
+ *          2. 替换不加锁：识别线程下一个批次起使用新模型，正在进行的批次不受影响
+ *          3. 日志记录加载耗时，以及从检测到文件变更到新模型生效的总延迟
+ * @param reason 触发原因（文件变更/SIGHUP）
+ * @param detected 检测到变更的时刻
  */
-void DoorCore::logThread() {
-    string msg;// 存储日志消息
-    // 循环处理日志，直到系统停止
-    while (is_running_) {
-        // 从日志队列取消息，成功则打印到控制台s
-        if (g_log_queue.pop(msg)) {
-            cout << msg << endl;
-        }
+void DoorCore::reloadModel(const string& reason, chrono::steady_clock::time_point detected) {
+    auto load_start = chrono::steady_clock::now();
+    string model_path;
+    shared_ptr<LbphEngine> model = loadModel(model_path);
+    if (!model) {
+        postLog("[错误] 模型热更新失败(" + reason + ")，继续使用当前模型");
+        return;
     }
+    auto published = chrono::steady_clock::now();
+    shared_ptr<LbphEngine> old = atomic_exchange(&g_lbph, model);
+    double load_ms = chrono::duration<double, milli>(published - load_start).count();
+    double total_ms = chrono::duration<double, milli>(published - detected).count();
+    postLog("[系统] 模型热更新完成(" + reason + ", " + model_path + ", " + to_string(old->samples()) + " → " +
+            to_string(model->samples()) + " 个样本, 加载 " + to_string(static_cast<int>(load_ms)) +
+            " ms, 变更到生效 " + to_string(static_cast<int>(total_ms)) + " ms)");
+    // old在此释放（识别线程仍在用旧模型预测时，由识别线程在批次结束后释放）
 }
 
+/**
+ * @brief 日志线程：异步格式化并输出日志
+ * @details 核心流程：
+ *          1. 轮询全局日志环形缓冲，取出业务线程写入的二进制记录
+ *          2. 在本线程中格式化，批量写入控制台和按大小轮转的日志文件（LOG_FILE_PATH）
+ *          3. 收到退出请求（stopLog）且缓冲取空后退出循环，输出写出/丢弃统计
+ */
+void DoorCore::logThread() {
+    applyStage("log");
+    ThreadCpuScope cpu_scope(metrics_, "log");
+    // 循环处理日志，直到收到退出请求且缓冲已取空（保证退出前的统计日志也能输出）
+    runLogWriter();
+}
 
+/**
+ * @brief 登记导出时读取的指标（队列深度、丢弃数、人脸池空闲槽位、空闲状态）
+ * @note 回调在指标线程中调用，只读取各组件自带锁或原子变量保护的统计
+ */
+void DoorCore::registerMetrics() {
+    metrics_.addGauge("face_door_face_queue_depth", "人脸队列中的批次数", "",
+                      [this]() { return static_cast<double>(face_queue_.size()); });
+    metrics_.addCounter("face_door_dropped_total", "各环节丢弃数", "stage=\"face_queue\"",
+                        [this]() { return static_cast<double>(face_queue_.dropped()); });
+    metrics_.addCounter("face_door_dropped_total", "各环节丢弃数", "stage=\"detect_channel\"", [this]() {
+        unsigned long long backlog, drops;
+        frame_channel_.consumerStats(detect_consumer_, backlog, drops);
+        return static_cast<double>(drops);
+    });
+    metrics_.addCounter("face_door_dropped_total", "各环节丢弃数", "stage=\"log\"",
+                        []() { return static_cast<double>(logDropped()); });
+    metrics_.addCounter("face_door_dropped_total", "各环节丢弃数", "stage=\"journal\"",
+                        [this]() { return static_cast<double>(journal_.dropped()); });
+    metrics_.addGauge("face_door_detect_backlog", "帧通道中检测线程池未读的帧数", "", [this]() {
+        unsigned long long backlog, drops;
+        frame_channel_.consumerStats(detect_consumer_, backlog, drops);
+        return static_cast<double>(backlog);
+    });
+    metrics_.addGauge("face_door_face_pool_free", "人脸池空闲槽位数", "",
+                      [this]() { return static_cast<double>(face_pool_.freeCount()); });
+    metrics_.addGauge("face_door_idle", "是否处于空闲降频状态", "",
+                      [this]() { return idle_.isIdle() ? 1.0 : 0.0; });
+    metrics_.addCounter("face_door_detected_frames_total", "已输出检测结果的帧数", "",
+                        [this]() { return static_cast<double>(detected_frames_.load()); });
+    metrics_.addCounter("face_door_journal_written_total", "已写入的出入记录数", "",
+                        [this]() { return static_cast<double>(journal_.written()); });
+    metrics_.addCounter("face_door_preview_frames_total", "已绘制并输出的预览帧数", "",
+                        [this]() { return static_cast<double>(preview_frames_.load()); });
+}
 
+/**
+ * @brief 按流水线配置设置调用线程的CPU亲和性和调度优先级
+ * @param stage 阶段名（capture | detect | recognize | display | log）
+ * @note 失败（如提高优先级缺少CAP_SYS_NICE）只记录日志，线程照常运行
+ */
+void DoorCore::applyStage(const string& stage) {
+    string problems = applyThreadPolicy(graph_.stage(stage));
+    if (!problems.empty()) postLog("[警告] " + stage + "线程调度设置失败:" + problems);
+}
@@ -0,0 +1,1380 @@
+/**
+ * @file face_bench.cpp
+ * @brief 门禁流水线性能测试工具主程序
+ * @details 用录像/图片目录/合成画面等可复现的输入测量各处理环节的耗时与效果，
+ *          便于在任意Linux机器上对比优化前后的数据
+ * @note 用法：face_door_bench <子命令> [参数...]
+ *       track <帧源> [全图检测间隔]  对比“每帧全图检测”与“先跟踪后检测”的单帧耗时和漏检率
+ *       detect-pool <帧源> [最大线程数] [检测后端]  检测线程池在1..N个线程下的全图检测吞吐
+ *       detect <帧源> [后端列表] [标注CSV]  各检测后端的单帧耗时和召回率
+ *       lbph <样本根目录> [测试样本间隔]  自研LBPH引擎与OpenCV LBPHFaceRecognizer的一致性和预测耗时
+ *       gallery [身份数列表] [每人样本数] [网格边长] [展开簇数列表]  大画廊下先粗后精索引与全量扫描的耗时和准确率
+ *       enroll [身份数列表] [每人样本数]  按身份分片存储时单人录入与合并的耗时随画廊规模的变化
+ *       actuator [判定次数] [平均间隔ms]  执行机构在模拟GPIO上的判定→引脚翻转延迟、脉冲宽度误差、投递耗时
+ *       log [生产者线程数] [每线程条数]  二进制日志与字符串日志的生产者耗时（纳秒/条）
+ *       queue [每生产者元素数] [容量] [负载字节]  队列家族与改造前SafeQueue的吞吐
+ *       jitter [秒数] [负载线程数]  CPU满载时周期采集线程的唤醒抖动（不绑核 vs 按流水线配置绑核/调整优先级）
+ *       suite [--选项...]  各热点路径的微基准（文本/JSON/CSV输出，可与基线比较，见benchSuite）
+ */
+#include "config.h"
+#include "frame_source.h"
+#include "face_tracker.h"
+#include "face_detector.h"
+#include "lbph_engine.h"
+#include "model_shards.h"
+#include "actuator.h"
+#include "gpio_control.h"
+#include "log_util.h"
+#include "safe_queue.h"
+#include "pipeline_graph.h"
+#include "metrics.h"
+#include "bench_harness.h"
+#include "jpeg_decode.h"
+#include <opencv2/face.hpp>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief 计算两个矩形框的交并比（IoU）
+ */
+static double rectIoU(const Rect& a, const Rect& b) {
+    double inter = (a & b).area();
+    double uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0;
+}
+
+/**
+ * @brief 先跟踪后检测对比测试
+ * @details 每帧分别执行：1. 全图检测（当前行为，作为基准） 2. 先跟踪后检测
+ *          漏检：基准检出的人脸在跟踪结果中找不到IoU≥0.5的对应框
+ * @return int 程序退出码
+ */
+static int benchTrack(int argc, char** argv) {
+    if (argc < 1) {
+        cerr << "用法：face_door_bench track <帧源> [全图检测间隔]\n";
+        return -1;
+    }
+    int interval = (argc > 1) ? atoi(argv[1]) : TRACK_FULL_SCAN_INTERVAL;
+    unique_ptr<FrameSource> source = createFrameSource(argv[0], ReplayMode::FAST);
+    if (!source || !source->open()) {
+        cerr << "帧源打开失败: " << argv[0] << "\n";
+        return -1;
+    }
+    unique_ptr<FaceDetector> detector = createFaceDetector(DETECTOR_BACKEND);
+    if (!detector || !detector->load()) {
+        cerr << "人脸检测器加载失败: " << DETECTOR_BACKEND << "\n";
+        return -1;
+    }
+
+    FaceTracker tracker(interval);
+    Mat frame, gray;
+    vector<Rect> base, tracked;
+    long long frames = 0, base_faces = 0, missed = 0;
+    double base_ms = 0.0, track_ms = 0.0;
+    Size min_size(FACE_MIN_SIZE, FACE_MIN_SIZE);
+
+    while (source->read(frame)) {
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+
+        auto t0 = chrono::steady_clock::now();
+        detector->detect(gray, base, min_size);
+        auto t1 = chrono::steady_clock::now();
+        tracker.detect(*detector, gray, tracked, min_size);
+        auto t2 = chrono::steady_clock::now();
+        base_ms += chrono::duration<double, milli>(t1 - t0).count();
+        track_ms += chrono::duration<double, milli>(t2 - t1).count();
+
+        // 统计漏检
+        for (const Rect& b : base) {
+            bool matched = false;
+            for (const Rect& t : tracked) {
+                if (rectIoU(b, t) >= 0.5) { matched = true; break; }
+            }
+            if (!matched) missed++;
+        }
+        base_faces += base.size();
+        frames++;
+    }
+    if (frames == 0) {
+        cerr << "帧源中没有可用帧\n";
+        return -1;
+    }
+
+    cout << "帧数: " << frames << "  全图检测间隔: " << interval << "\n";
+    cout << "每帧全图检测: " << base_ms / frames << " ms/帧\n";
+    cout << "先跟踪后检测: " << track_ms / frames << " ms/帧"
+         << "  (全图 " << tracker.fullScans() << " 次, 局部 " << tracker.roiScans()
+         << " 次, 丢失 " << tracker.lostCount() << " 次)\n";
+    cout << "加速比: " << (track_ms > 0 ? base_ms / track_ms : 0.0) << "x\n";
+    cout << "漏检率: " << (base_faces > 0 ? 100.0 * missed / base_faces : 0.0) << "% ("
+         << missed << "/" << base_faces << ")\n";
+    return 0;
+}
+
+/**
+ * @brief 检测线程池吞吐测试
+ * @details 先把帧源全部读入内存并预处理为均衡化灰度图（排除解码耗时），
+ *          再分别用1..N个线程（每个线程独立的检测器）对全部帧做全图检测，
+ *          输出每种线程数下的FPS和相对单线程的加速比
+ * @note 测试期间关闭OpenCV内部并行（setNumThreads(1)），只测量线程池本身的扩展性
+ * @return int 程序退出码
+ */
+static int benchDetectPool(int argc, char** argv) {
+    if (argc < 1) {
+        cerr << "用法：face_door_bench detect-pool <帧源> [最大线程数] [检测后端]\n";
+        return -1;
+    }
+    int max_workers = (argc > 1) ? atoi(argv[1]) : static_cast<int>(thread::hardware_concurrency());
+    if (max_workers < 1) max_workers = 1;
+    string detector_spec = (argc > 2) ? argv[2] : DETECTOR_BACKEND;
+    unique_ptr<FrameSource> source = createFrameSource(argv[0], ReplayMode::FAST);
+    if (!source || !source->open()) {
+        cerr << "帧源打开失败: " << argv[0] << "\n";
+        return -1;
+    }
+
+    // 预读全部帧
+    vector<Mat> grays;
+    Mat frame;
+    while (source->read(frame)) {
+        Mat gray;
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+        grays.push_back(gray);
+    }
+    if (grays.empty()) {
+        cerr << "帧源中没有可用帧\n";
+        return -1;
+    }
+
+    setNumThreads(1);
+    Size min_size(FACE_MIN_SIZE, FACE_MIN_SIZE);
+    double base_fps = 0.0;
+    cout << "帧数: " << grays.size() << "\n";
+    for (int workers = 1; workers <= max_workers; workers++) {
+        // 每个线程独立的检测器（在计时之外加载）
+        vector<unique_ptr<FaceDetector>> detectors;
+        for (int w = 0; w < workers; w++) {
+            detectors.push_back(createFaceDetector(detector_spec));
+            if (!detectors.back() || !detectors.back()->load()) {
+                cerr << "人脸检测器加载失败: " << detector_spec << "\n";
+                return -1;
+            }
+        }
+        atomic<size_t> next{0};
+        atomic<long long> faces_found{0};
+        auto t0 = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (int w = 0; w < workers; w++) {
+            threads.emplace_back([&, w]() {
+                vector<Rect> faces;
+                for (size_t i = next++; i < grays.size(); i = next++) {
+                    detectors[w]->detect(grays[i], faces, min_size);
+                    faces_found += faces.size();
+                }
+            });
+        }
+        for (thread& t : threads) t.join();
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        double fps = sec > 0 ? grays.size() / sec : 0.0;
+        if (workers == 1) base_fps = fps;
+        cout << workers << " 线程: " << fps << " FPS  加速比 "
+             << (base_fps > 0 ? fps / base_fps : 0.0) << "x  (人脸 " << faces_found << ")\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取人脸标注CSV
+ * @details 每行 "帧号,x,y,w,h"（帧号从0开始，同一帧可有多行，#开头为注释），坐标为原始分辨率
+ * @return 帧号→人脸框列表，文件打不开返回false
+ */
+static bool loadGroundTruth(const string& path, map<long long, vector<Rect>>& truth) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        for (char& c : line) {
+            if (c == ',') c = ' ';
+        }
+        istringstream ss(line);
+        long long frame;
+        Rect r;
+        if (ss >> frame >> r.x >> r.y >> r.width >> r.height) truth[frame].push_back(r);
+    }
+    return true;
+}
+
+/**
+ * @brief 检测后端对比测试
+ * @details 预读全部帧为均衡化灰度图后，逐个后端对每帧做全图检测，输出ms/帧和召回率
+ *          （标注框与检出框IoU≥0.5视为召回）。未提供标注CSV时以第一个后端的检出结果为基准，
+ *          输出的是相对召回率
+ * @return int 程序退出码
+ */
+static int benchDetect(int argc, char** argv) {
+    if (argc < 1) {
+        cerr << "用法：face_door_bench detect <帧源> [后端列表,逗号分隔，默认haar,lbp,dnn] [标注CSV]\n";
+        return -1;
+    }
+    vector<string> specs;
+    string list = (argc > 1) ? argv[1] : "haar,lbp,dnn";
+    // 后端之间用分号或逗号分隔；dnn带模型路径时用分号（路径内部本身用逗号分隔权重和网络结构）
+    char sep = list.find(';') != string::npos ? ';' : ',';
+    istringstream ls(list);
+    for (string spec; getline(ls, spec, sep);) {
+        if (!spec.empty()) specs.push_back(spec);
+    }
+    map<long long, vector<Rect>> truth;
+    bool has_truth = argc > 2;
+    if (has_truth && !loadGroundTruth(argv[2], truth)) {
+        cerr << "标注文件打开失败: " << argv[2] << "\n";
+        return -1;
+    }
+    unique_ptr<FrameSource> source = createFrameSource(argv[0], ReplayMode::FAST);
+    if (!source || !source->open()) {
+        cerr << "帧源打开失败: " << argv[0] << "\n";
+        return -1;
+    }
+    vector<Mat> grays;
+    Mat frame;
+    while (source->read(frame)) {
+        Mat gray;
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+        grays.push_back(gray);
+    }
+    if (grays.empty()) {
+        cerr << "帧源中没有可用帧\n";
+        return -1;
+    }
+
+    Size min_size(FACE_MIN_SIZE, FACE_MIN_SIZE);
+    cout << "帧数: " << grays.size() << (has_truth ? "  基准: 标注文件" : "  基准: 第一个后端") << "\n";
+    for (const string& spec : specs) {
+        unique_ptr<FaceDetector> detector = createFaceDetector(spec);
+        if (!detector || !detector->load()) {
+            cout << spec << ": 加载失败，跳过\n";
+            continue;
+        }
+        vector<Rect> faces;
+        long long expected = 0, recalled = 0, found = 0;
+        double ms = 0.0;
+        for (size_t i = 0; i < grays.size(); i++) {
+            auto t0 = chrono::steady_clock::now();
+            detector->detect(grays[i], faces, min_size);
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            found += faces.size();
+            // 无标注时第一个成功加载的后端的结果作为基准
+            if (!has_truth) {
+                truth[static_cast<long long>(i)] = faces;
+                continue;
+            }
+            auto it = truth.find(static_cast<long long>(i));
+            if (it == truth.end()) continue;
+            for (const Rect& t : it->second) {
+                expected++;
+                for (const Rect& f : faces) {
+                    if (rectIoU(t, f) >= 0.5) { recalled++; break; }
+                }
+            }
+        }
+        cout << detector->name() << ": " << ms / grays.size() << " ms/帧  检出 " << found;
+        if (has_truth) {
+            cout << "  召回率 " << (expected > 0 ? 100.0 * recalled / expected : 0.0) << "% ("
+                 << recalled << "/" << expected << ")";
+        }
+        cout << "\n";
+        has_truth = true;// 之后的后端与基准比较
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取人脸样本根目录（下级为用户ID文件夹，同face_train），每隔interval张取1张作为测试样本
+ */
+static void loadFaceSamples(const string& root, int interval, vector<Mat>& train_images,
+                            vector<int>& train_labels, vector<Mat>& test_images, vector<int>& test_labels) {
+    error_code ec;
+    vector<fs::path> dirs;
+    for (auto& entry : fs::directory_iterator(root, ec)) {
+        if (entry.is_directory()) dirs.push_back(entry.path());
+    }
+    sort(dirs.begin(), dirs.end());
+    for (const fs::path& dir : dirs) {
+        int id = atoi(dir.filename().string().c_str());
+        vector<fs::path> files;
+        for (auto& entry : fs::directory_iterator(dir, ec)) {
+            if (entry.is_regular_file()) files.push_back(entry.path());
+        }
+        sort(files.begin(), files.end());
+        int index = 0;
+        for (const fs::path& file : files) {
+            Mat img = imread(file.string(), IMREAD_GRAYSCALE);
+            if (img.empty()) continue;
+            bool is_test = interval > 0 && (index++ % interval) == interval - 1;
+            (is_test ? test_images : train_images).push_back(img);
+            (is_test ? test_labels : train_labels).push_back(id);
+        }
+    }
+}
+
+/**
+ * @brief 自研LBPH引擎与OpenCV LBPHFaceRecognizer对比测试
+ * @details 用同一组训练样本分别训练两者，输出：
+ *          1. 训练直方图的最大逐元素差异
+ *          2. 卡方距离：SIMD实现、标量实现、cv::compareHist三者的最大相对误差
+ *          3. 测试样本的预测标签一致率、置信度最大相对误差
+ *          4. 单张预测耗时，以及按批次预测（MAX_FACES_PER_FRAME张共享一次画廊扫描）的单张耗时
+ * @return int 程序退出码（统一模式无法与OpenCV对比，直接返回失败）
+ */
+static int benchLbph(int argc, char** argv) {
+    if (argc < 1) {
+        cerr << "用法：face_door_bench lbph <样本根目录> [测试样本间隔，默认5]\n";
+        return -1;
+    }
+    if (LBPH_UNIFORM_PATTERNS) {
+        cerr << "统一模式直方图与OpenCV不兼容，无法对比\n";
+        return -1;
+    }
+    int interval = (argc > 1) ? atoi(argv[1]) : 5;
+    vector<Mat> train_images, test_images;
+    vector<int> train_labels, test_labels;
+    loadFaceSamples(argv[0], interval, train_images, train_labels, test_images, test_labels);
+    if (train_images.empty() || test_images.empty()) {
+        cerr << "样本不足: " << argv[0] << "\n";
+        return -1;
+    }
+
+    // 1. 训练两个实现
+    Ptr<face::LBPHFaceRecognizer> cv_model = face::LBPHFaceRecognizer::create();
+    auto t0 = chrono::steady_clock::now();
+    cv_model->train(train_images, train_labels);
+    auto t1 = chrono::steady_clock::now();
+    LbphEngine engine;
+    engine.setSearchMode(LbphEngine::SearchMode::EXHAUSTIVE);// 与OpenCV逐项对比，不使用索引
+    engine.train(train_images, train_labels);
+    auto t2 = chrono::steady_clock::now();
+
+    vector<Mat> cv_hists = cv_model->getHistograms();
+    double hist_diff = 0.0, chi_simd_err = 0.0, chi_cv_err = 0.0;
+    for (int i = 0; i < engine.samples(); i++) {
+        const float* ours = engine.histogram(i);
+        const float* theirs = cv_hists[i].ptr<float>();
+        for (int k = 0; k < engine.histSize(); k++) hist_diff = max(hist_diff, fabs(double(ours[k]) - theirs[k]));
+    }
+    // 2. 卡方距离：相邻训练样本两两比较
+    for (int i = 0; i + 1 < engine.samples(); i++) {
+        double scalar = chiSquareAltScalar(engine.histogram(i), engine.histogram(i + 1), engine.histSize());
+        double simd = chiSquareAlt(engine.histogram(i), engine.histogram(i + 1), engine.stride());
+        double ref = compareHist(cv_hists[i], cv_hists[i + 1], HISTCMP_CHISQR_ALT);
+        if (ref > 0) {
+            chi_simd_err = max(chi_simd_err, fabs(simd - ref) / ref);
+            chi_cv_err = max(chi_cv_err, fabs(scalar - ref) / ref);
+        }
+    }
+
+    // 3. 逐张预测对比
+    size_t n = test_images.size();
+    vector<int> cv_labels(n), our_labels(n);
+    vector<double> cv_confs(n), our_confs(n);
+    auto t3 = chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) cv_model->predict(test_images[i], cv_labels[i], cv_confs[i]);
+    auto t4 = chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) engine.predict(test_images[i], our_labels[i], our_confs[i]);
+    auto t5 = chrono::steady_clock::now();
+    engine.predictBatch(test_images.data(), static_cast<int>(n), our_labels.data(), our_confs.data());
+    auto t6 = chrono::steady_clock::now();
+    // 批量预测的结果覆盖逐张结果（两者应完全相同），与OpenCV比对
+    size_t agree = 0, correct = 0;
+    double conf_err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        agree += cv_labels[i] == our_labels[i];
+        correct += our_labels[i] == test_labels[i];
+        if (cv_confs[i] > 0) conf_err = max(conf_err, fabs(our_confs[i] - cv_confs[i]) / cv_confs[i]);
+    }
+
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+    cout << "训练样本: " << train_images.size() << "  测试样本: " << n << "  直方图长度: "
+         << engine.histSize() << "  指令集: " << LbphEngine::simdName() << "\n";
+    cout << "训练耗时: OpenCV " << ms(t0, t1) << " ms, 自研 " << ms(t1, t2) << " ms\n";
+    cout << "训练直方图最大差异: " << hist_diff << "\n";
+    cout << "卡方距离最大相对误差: SIMD " << chi_simd_err << ", 标量 " << chi_cv_err << "\n";
+    cout << "预测标签一致: " << agree << "/" << n << "  置信度最大相对误差: " << conf_err
+         << "  识别正确: " << correct << "/" << n << "\n";
+    cout << "单张预测: OpenCV " << ms(t3, t4) / n << " ms, 自研 " << ms(t4, t5) / n
+         << " ms, 自研批量 " << ms(t5, t6) / n << " ms  加速比 "
+         << (ms(t4, t5) > 0 ? ms(t3, t4) / ms(t4, t5) : 0.0) << "x\n";
+    return agree == n ? 0 : -1;
+}
+
+/**
+ * @brief 生成一个合成的LBPH直方图：base与随机噪声按mix混合后逐格归一化
+ * @details 每格模式分布取指数分布的平方（少数模式占大头，接近真实人脸的LBP分布）；
+ *          base为空时生成一个新身份的基准直方图
+ */
+static void syntheticHistogram(const float* base, float mix, int cells, int patterns,
+                               mt19937& rng, float* hist) {
+    exponential_distribution<float> dist(1.0f);
+    for (int c = 0; c < cells; c++) {
+        float* cell = hist + c * patterns;
+        float sum = 0.0f;
+        for (int k = 0; k < patterns; k++) {
+            float noise = dist(rng);
+            noise *= noise;
+            cell[k] = base ? (1.0f - mix) * base[c * patterns + k] * patterns + mix * noise : noise;
+            sum += cell[k];
+        }
+        for (int k = 0; k < patterns; k++) cell[k] /= sum;
+    }
+}
+
+/**
+ * @brief 大画廊检索测试：先粗后精索引 vs 全量扫描
+ * @details 摄像头样本无法凑出上万个身份，这里直接合成直方图：每个身份一个基准直方图，
+ *          训练样本与测试样本都是基准加独立噪声。对每个身份数分别报告：
+ *          1. 索引构建耗时（含身份质心聚类）
+ *          2. 全量扫描与索引（每个展开簇数各一行）的单张预测耗时（MAX_FACES_PER_FRAME张一批）及加速比
+ *          3. 索引与全量扫描的识别结果一致率，以及两者相对真实身份的正确率
+ * @note 1. 画廊内存约为 身份数×每人样本数×直方图长度×4字节，默认使用统一模式（59个模式/格）控制内存
+ *       2. 合成身份彼此独立、没有真实人脸那样的聚集结构，是簇索引的最坏情况，一致率应视为下限
+ * @return int 程序退出码
+ */
+static int benchGallery(int argc, char** argv) {
+    vector<int> sizes;
+    stringstream ss(argc > 0 ? argv[0] : "100,1000,10000");
+    for (string item; getline(ss, item, ',');) {
+        if (atoi(item.c_str()) > 0) sizes.push_back(atoi(item.c_str()));
+    }
+    int per_id = (argc > 1) ? max(1, atoi(argv[1])) : 2;
+    int grid = (argc > 2) ? max(1, atoi(argv[2])) : 4;
+    vector<int> probe_list;
+    stringstream ps(argc > 3 ? argv[3] : "4,8,16");
+    for (string item; getline(ps, item, ',');) {
+        if (atoi(item.c_str()) > 0) probe_list.push_back(atoi(item.c_str()));
+    }
+    const int probe_count = 200;     // 每个规模的测试人脸数
+    const float sample_noise = 0.35f;// 样本相对基准的噪声比例
+
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+    bool ok = true;
+    for (int identities : sizes) {
+        LbphEngine engine(1, 8, grid, grid, DBL_MAX, true);
+        int patterns = engine.histSize() / (grid * grid);
+        size_t hist = engine.histSize();
+        mt19937 rng(identities);// 固定种子，结果可复现
+
+        // 1. 合成画廊与测试人脸（测试人脸的真实身份均匀分布）
+        vector<float> bases(identities * hist), gallery(size_t(identities) * per_id * hist);
+        vector<int> labels(identities * per_id);
+        for (int id = 0; id < identities; id++) {
+            syntheticHistogram(nullptr, 0.0f, grid * grid, patterns, rng, &bases[id * hist]);
+            for (int j = 0; j < per_id; j++) {
+                int s = id * per_id + j;
+                syntheticHistogram(&bases[id * hist], sample_noise, grid * grid, patterns, rng, &gallery[s * hist]);
+                labels[s] = id;
+            }
+        }
+        // 测试直方图按引擎行长对齐存放（predictHistograms要求）
+        size_t stride = engine.stride();
+        vector<float> probe_buf(probe_count * stride + LBPH_ALIGN / sizeof(float), 0.0f);
+        float* probes = probe_buf.data();
+        while (reinterpret_cast<uintptr_t>(probes) % LBPH_ALIGN) probes++;
+        vector<int> truth(probe_count);
+        for (int i = 0; i < probe_count; i++) {
+            truth[i] = static_cast<int>(rng() % identities);
+            syntheticHistogram(&bases[truth[i] * hist], sample_noise, grid * grid, patterns, rng, probes + i * stride);
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        if (!engine.assign(gallery.data(), hist, labels.data(), identities * per_id)) {
+            cerr << "画廊设置失败（内存不足？）: " << identities << " 个身份\n";
+            ok = false;
+            continue;
+        }
+        auto t1 = chrono::steady_clock::now();
+
+        // 2. 两种方式分别预测全部测试人脸
+        vector<int> full_labels(probe_count), idx_labels(probe_count);
+        vector<double> full_confs(probe_count), idx_confs(probe_count);
+        auto run = [&](LbphEngine::SearchMode mode, vector<int>& out_labels, vector<double>& out_confs) {
+            engine.setSearchMode(mode);
+            auto start = chrono::steady_clock::now();
+            for (int base = 0; base < probe_count; base += MAX_FACES_PER_FRAME) {
+                int n = min(MAX_FACES_PER_FRAME, probe_count - base);
+                engine.predictHistograms(probes + base * stride, n, &out_labels[base], &out_confs[base]);
+            }
+            return ms(start, chrono::steady_clock::now()) / probe_count;
+        };
+        double full_ms = run(LbphEngine::SearchMode::EXHAUSTIVE, full_labels, full_confs);
+        int full_correct = 0;
+        for (int i = 0; i < probe_count; i++) full_correct += full_labels[i] == truth[i];
+        cout << "身份数 " << identities << " (样本 " << engine.samples() << ", 直方图长度 " << hist
+             << ", 画廊 " << engine.samples() * stride * sizeof(float) / (1024 * 1024) << " MB)  索引构建 "
+             << ms(t0, t1) << " ms\n";
+        cout << "  全量扫描: 单张 " << full_ms << " ms  正确率 " << 100.0 * full_correct / probe_count << "%\n";
+        for (int probe_clusters : probe_list) {
+            engine.setProbeClusters(probe_clusters);
+            double idx_ms = run(LbphEngine::SearchMode::INDEXED, idx_labels, idx_confs);
+            int agree = 0, idx_correct = 0;
+            for (int i = 0; i < probe_count; i++) {
+                agree += full_labels[i] == idx_labels[i];
+                idx_correct += idx_labels[i] == truth[i];
+            }
+            cout << "  索引(展开" << probe_clusters << "簇, 候选" << LBPH_INDEX_TOP_K << "人): 单张 " << idx_ms
+                 << " ms  加速比 " << (idx_ms > 0 ? full_ms / idx_ms : 0.0) << "x  与全量一致 " << agree << "/"
+                 << probe_count << "  正确率 " << 100.0 * idx_correct / probe_count << "%\n";
+        }
+    }
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief 单人录入测试：按身份分片存储时，录入一人的耗时不随画廊规模增长
+ * @details 对每个身份数：先在临时目录中写出全部身份的合成直方图分片（准备工作，不计时），然后
+ *          1. 录入一个新身份：per_id张合成人脸图计算直方图并写出其分片（face_train add的计算部分）
+ *          2. 合并全部分片、写出二进制模型（只拼接与重建索引，不重新计算直方图）
+ *          3. 按单张直方图耗时估算全量重算全部样本所需的时间（分片之前每次录入的代价）
+ * @note 画廊使用统一模式直方图（59个模式/格）控制临时文件大小，临时目录测试结束后删除
+ * @return int 程序退出码
+ */
+static int benchEnroll(int argc, char** argv) {
+    vector<int> sizes;
+    stringstream ss(argc > 0 ? argv[0] : "100,1000");
+    for (string item; getline(ss, item, ',');) {
+        if (atoi(item.c_str()) > 0) sizes.push_back(atoi(item.c_str()));
+    }
+    int per_id = (argc > 1) ? max(1, atoi(argv[1])) : 5;
+    const int grid = 8;
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+    string dir = (fs::temp_directory_path() / "face_door_bench_shards").string();
+
+    // 新身份的人脸图（随机纹理，尺寸同识别时送入的人脸）
+    vector<Mat> faces(per_id);
+    for (Mat& f : faces) {
+        f.create(TRAIN_SAMPLE_SIZE, TRAIN_SAMPLE_SIZE, CV_8UC1);
+        randu(f, Scalar(0), Scalar(256));
+    }
+    bool ok = true;
+    for (int identities : sizes) {
+        fs::remove_all(dir);
+        ShardStore store(dir);
+
+        // 1. 准备：合成全部身份的直方图并按身份写出分片
+        {
+            LbphEngine gallery_engine(1, 8, grid, grid, DBL_MAX, true);
+            size_t hist = gallery_engine.histSize();
+            int patterns = gallery_engine.histSize() / (grid * grid);
+            mt19937 rng(identities);
+            vector<float> base(hist), gallery(size_t(identities) * per_id * hist);
+            vector<int> labels(identities * per_id);
+            for (int id = 0; id < identities; id++) {
+                syntheticHistogram(nullptr, 0.0f, grid * grid, patterns, rng, base.data());
+                for (int j = 0; j < per_id; j++) {
+                    int k = id * per_id + j;
+                    syntheticHistogram(base.data(), 0.35f, grid * grid, patterns, rng, &gallery[k * hist]);
+                    labels[k] = id;
+                }
+            }
+            if (!gallery_engine.assign(gallery.data(), hist, labels.data(), identities * per_id)) {
+                cerr << "画廊设置失败（内存不足？）: " << identities << " 个身份\n";
+                ok = false;
+                continue;
+            }
+            for (int id = 0; id < identities; id++) {
+                vector<int> rows(per_id);
+                for (int j = 0; j < per_id; j++) rows[j] = id * per_id + j;
+                if (!store.write(id, gallery_engine, rows)) {
+                    cerr << "分片写入失败: " << store.path(id) << "\n";
+                    return -1;
+                }
+            }
+        }
+
+        // 2. 录入一个新身份：计算直方图 + 写分片
+        auto t0 = chrono::steady_clock::now();
+        LbphEngine person(1, 8, grid, grid, DBL_MAX, true);
+        vector<int> person_labels(per_id, identities), rows(per_id);
+        for (int j = 0; j < per_id; j++) rows[j] = j;
+        if (!person.train(faces, person_labels) || !store.write(identities, person, rows)) {
+            cerr << "录入失败\n";
+            return -1;
+        }
+        auto t1 = chrono::steady_clock::now();
+
+        // 3. 合并全部分片并写出模型
+        LbphEngine model(1, 8, grid, grid, DBL_MAX, true);
+        int shards = 0;
+        if (!store.merge(model, shards) || !model.writeBinary(dir + "/model.bin")) {
+            cerr << "合并失败\n";
+            return -1;
+        }
+        auto t2 = chrono::steady_clock::now();
+        double per_sample = ms(t0, t1) / per_id;// 单张直方图+写分片的耗时（略高估计算部分）
+        cout << "身份数 " << identities << " (合并后样本 " << model.samples() << ")  录入1人(" << per_id << "张) "
+             << ms(t0, t1) << " ms  合并 " << shards << " 个分片 " << ms(t1, t2) << " ms  全量重算直方图约 "
+             << per_sample * model.samples() << " ms\n";
+    }
+    fs::remove_all(dir);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief 执行机构测试：在模拟GPIO芯片上测量判定→引脚翻转的延迟
+ * @details 模拟识别线程按随机间隔做出判定（约70%开门、30%报警），通过Actuator投递命令，报告：
+ *          1. 投递耗时（识别线程被占用的时间，改造前为阻塞的开门/报警时长）
+ *          2. 判定→激活沿延迟的中位数/P99/最大值
+ *          3. 蜂鸣器脉冲宽度相对ALARM_BEEP_MS的误差；继电器每次打开的时长（连续确认会延长）
+ * @return int 程序退出码（脉冲宽度误差超过两个时间轮刻度时返回-1）
+ */
+static int benchActuator(int argc, char** argv) {
+    int decisions = (argc > 0) ? max(1, atoi(argv[0])) : 100;
+    int interval_ms = (argc > 1) ? max(1, atoi(argv[1])) : 100;
+
+    auto sim_owner = make_unique<SimGpioBackend>();
+    SimGpioBackend* sim = sim_owner.get();
+    mutex mtx;
+    vector<double> latencies;// 判定→激活沿延迟
+    Actuator actuator(move(sim_owner), [&](ActuatorChannel, bool active, double latency_ms) {
+        if (!active) return;
+        lock_guard<mutex> lock(mtx);
+        latencies.push_back(latency_ms);
+    });
+    if (!actuator.start()) {
+        cerr << "执行机构启动失败\n";
+        return -1;
+    }
+
+    // 1. 模拟识别线程投递判定
+    mt19937 rng(12345);
+    uniform_int_distribution<int> gap(interval_ms / 2, interval_ms * 3 / 2);
+    double submit_sum_us = 0.0, submit_max_us = 0.0;
+    int doors = 0, alarms = 0;
+    for (int i = 0; i < decisions; i++) {
+        this_thread::sleep_for(chrono::milliseconds(gap(rng)));
+        bool door = rng() % 10 < 7;
+        auto decided = chrono::steady_clock::now();
+        if (door) actuator.openDoor(decided);
+        else actuator.alarm(decided);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - decided).count();
+        submit_sum_us += us;
+        submit_max_us = max(submit_max_us, us);
+        (door ? doors : alarms)++;
+    }
+    // 等待最后一次开门/报警自然结束
+    this_thread::sleep_for(chrono::milliseconds(max(DOOR_OPEN_MS, ALARM_BEEP_MS) + 5 * ACTUATOR_TICK_MS));
+    actuator.stop();
+
+    // 2. 由模拟芯片记录的翻转计算各脉冲宽度
+    vector<GpioEdge> edges = sim->takeEdges();
+    vector<double> door_widths, beep_errors;
+    chrono::steady_clock::time_point door_on, beep_on;
+    for (const GpioEdge& e : edges) {
+        if (e.pin == DOOR_PIN_BCM) {
+            if (e.value) door_on = e.ts;
+            else door_widths.push_back(chrono::duration<double, milli>(e.ts - door_on).count());
+        } else if (e.pin == BUZZER_PIN_BCM) {
+            if (!e.value) beep_on = e.ts;// 低电平响
+            else beep_errors.push_back(chrono::duration<double, milli>(e.ts - beep_on).count() - ALARM_BEEP_MS);
+        }
+    }
+    sort(latencies.begin(), latencies.end());
+    auto pct = [](const vector<double>& v, double p) {
+        return v.empty() ? 0.0 : v[min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+    };
+    double beep_err_max = 0.0;
+    for (double e : beep_errors) beep_err_max = max(beep_err_max, fabs(e));
+    double door_min = door_widths.empty() ? 0.0 : *min_element(door_widths.begin(), door_widths.end());
+    double door_max = door_widths.empty() ? 0.0 : *max_element(door_widths.begin(), door_widths.end());
+
+    cout << "判定 " << decisions << " 次（开门 " << doors << "，报警 " << alarms << "），平均间隔 " << interval_ms
+         << " ms，时间轮刻度 " << ACTUATOR_TICK_MS << " ms\n"
+         << "投递耗时: 平均 " << submit_sum_us / decisions << " us  最大 " << submit_max_us
+         << " us（阻塞实现为开门 " << DOOR_OPEN_MS << " ms / 报警 " << ALARM_BEEP_MS << " ms）\n"
+         << "判定→激活沿: 中位数 " << pct(latencies, 0.5) << " ms  P99 " << pct(latencies, 0.99) << " ms  最大 "
+         << (latencies.empty() ? 0.0 : latencies.back()) << " ms（" << latencies.size() << " 次激活）\n"
+         << "继电器: 打开 " << door_widths.size() << " 次，每次 " << door_min << " ~ " << door_max
+         << " ms（连续确认时延长）\n"
+         << "蜂鸣器: 响 " << beep_errors.size() << " 次（去抖 " << ALARM_DEBOUNCE_MS << " ms），宽度误差最大 "
+         << beep_err_max << " ms\n"
+         << actuator.summary() << "\n";
+    bool ok = beep_err_max <= 2.0 * ACTUATOR_TICK_MS && (door_widths.empty() || door_min >= DOOR_OPEN_MS - 1);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief 日志测试：识别线程一条“识别成功”日志的生产者耗时
+ * @details 两种实现各自用同样的生产者线程数写同样条数，消费者线程同时取出（不写终端/文件）：
+ *          1. 字符串日志（改造前）：to_string拼接std::string，加锁入SafeQueue（容量50，满时丢弃）
+ *          2. 二进制日志：logEvent写入无锁环形缓冲（参数拷贝，不格式化），消费者取出后再格式化
+ *          报告每条的平均生产者耗时（纳秒）、丢弃数，以及二进制日志在消费者端的格式化耗时
+ * @return int 程序退出码
+ */
+static int benchLog(int argc, char** argv) {
+    int producers = (argc > 0) ? max(1, atoi(argv[0])) : 3;
+    int per_thread = (argc > 1) ? max(1, atoi(argv[1])) : 200000;
+    using Clock = chrono::steady_clock;
+
+    // 各生产者线程同时开始，返回每条平均耗时（纳秒）
+    auto run = [&](auto produce) {
+        atomic<bool> go{false};
+        atomic<long long> total_ns{0};
+        vector<thread> threads;
+        for (int t = 0; t < producers; t++) {
+            threads.emplace_back([&, t]() {
+                while (!go) this_thread::yield();
+                auto start = Clock::now();
+                for (int i = 0; i < per_thread; i++) produce(t, i);
+                total_ns += chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+            });
+        }
+        go = true;
+        for (thread& th : threads) th.join();
+        return static_cast<double>(total_ns) / (static_cast<double>(producers) * per_thread);
+    };
+
+    // 1. 字符串日志
+    SafeQueue<string> queue(50);
+    atomic<bool> done{false};
+    atomic<long long> string_dropped{0};
+    thread string_consumer([&]() {
+        string msg;
+        while (queue.pop(msg)) {}
+    });
+    double string_ns = run([&](int t, int i) {
+        string msg = "[成功] [帧" + to_string(i) + "] 轨迹" + to_string(t) + " ID=" + to_string(i % 100) +
+                     " 置信度=" + to_string(i % 50) + " (3/" + to_string(VOTE_WINDOW) + "票) 延迟=" +
+                     to_string(i % 80) + "ms";
+        if (!queue.push(msg)) string_dropped++;
+    });
+    queue.stop();
+    string_consumer.join();
+
+    // 2. 二进制日志（消费者只取出，格式化另行计时）
+    unsigned long long dropped_before = logDropped();
+    atomic<long long> popped{0};
+    thread binary_consumer([&]() {
+        LogRecord rec;
+        while (true) {
+            bool stopping = done.load();
+            bool got = false;
+            while (g_log_ring.pop(rec)) {
+                popped++;
+                got = true;
+            }
+            if (!got && stopping) break;
+            if (!got) this_thread::yield();
+        }
+    });
+    double binary_ns = run([](int t, int i) {
+        logEvent(LogEvent::RECOG_CONFIRMED, static_cast<long long>(i), t, i % 100, i % 50, 3, i % 80);
+    });
+    done = true;
+    binary_consumer.join();
+    unsigned long long binary_dropped = logDropped() - dropped_before;
+
+    // 3. 消费者端格式化耗时
+    LogRecord rec;
+    rec.event = static_cast<uint16_t>(LogEvent::RECOG_CONFIRMED);
+    rec.argc = 6;
+    rec.ts_ns = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    for (int i = 0; i < 6; i++) rec.args[i].i = 1000 + i;
+    string out;
+    const int format_count = 100000;
+    auto f0 = Clock::now();
+    for (int i = 0; i < format_count; i++) {
+        out.clear();
+        formatLogRecord(rec, out);
+    }
+    double format_ns = chrono::duration<double, nano>(Clock::now() - f0).count() / format_count;
+
+    long long total = static_cast<long long>(producers) * per_thread;
+    cout << "生产者 " << producers << " 线程 × " << per_thread << " 条\n"
+         << "字符串日志: " << string_ns << " ns/条  丢弃 " << string_dropped << "/" << total << "\n"
+         << "二进制日志: " << binary_ns << " ns/条  丢弃 " << binary_dropped << "/" << total << "（缓冲 "
+         << g_log_ring.capacity() << " 条）  加速比 " << (binary_ns > 0 ? string_ns / binary_ns : 0.0) << "x\n"
+         << "日志线程格式化: " << format_ns << " ns/条\n";
+    return 0;
+}
+
+//改造前的SafeQueue（互斥锁 + std::queue，只能拷贝入队），作为队列测试的基准
+template <typename T>
+class LegacySafeQueue {
+public:
+    explicit LegacySafeQueue(size_t max_size) : max_size_(max_size) {}
+    bool push(const T& item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (queue_.size() >= max_size_) return false;
+        queue_.push(item);
+        cond_.notify_one();
+        return true;
+    }
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cond_.wait(lock, [this]() { return !queue_.empty() || stop_flag_; });
+        if (stop_flag_ && queue_.empty()) return false;
+        item = queue_.front();
+        queue_.pop();
+        return true;
+    }
+    void stop() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_flag_ = true;
+        cond_.notify_all();
+    }
+
+private:
+    std::queue<T> queue_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    size_t max_size_;
+    bool stop_flag_ = false;
+};
+
+//队列测试的元素：序号 + 可选的堆上负载（模拟携带缓冲的批次，拷贝需要分配内存，移动只交换指针）
+struct QueueItem {
+    long long seq = 0;
+    vector<unsigned char> payload;
+};
+
+/**
+ * @brief 一次队列吞吐测量：producers个生产者各入队per_producer个元素，consumers个消费者取完
+ * @details 入队失败（改造前的队列满时丢弃）则让出CPU后重试，保证每个元素都被取出；
+ *          消费者累加序号校验没有丢失或重复；batch>0时消费者用drain批量取出
+ * @return double 每个元素的平均耗时（纳秒，按墙上时间计）
+ */
+template <typename Queue>
+static double queueThroughput(Queue& queue, int producers, int consumers, long long per_producer,
+                              size_t payload_bytes, size_t batch, bool& ok) {
+    using Clock = chrono::steady_clock;
+    atomic<bool> go{false};
+    atomic<long long> sum{0}, count{0};
+    vector<thread> consumer_threads, producer_threads;
+    for (int c = 0; c < consumers; c++) {
+        consumer_threads.emplace_back([&]() {
+            long long local_sum = 0, local_count = 0;
+            QueueItem item;
+            if constexpr (!is_same<Queue, LegacySafeQueue<QueueItem>>::value) {
+                if (batch > 0) {
+                    vector<QueueItem> items;
+                    while (queue.pop(item)) {
+                        local_sum += item.seq;
+                        local_count++;
+                        items.clear();
+                        queue.drain(items, batch);
+                        for (const QueueItem& it : items) local_sum += it.seq;
+                        local_count += static_cast<long long>(items.size());
+                    }
+                    sum += local_sum;
+                    count += local_count;
+                    return;
+                }
+            }
+            while (queue.pop(item)) {
+                local_sum += item.seq;
+                local_count++;
+            }
+            sum += local_sum;
+            count += local_count;
+        });
+    }
+    for (int p = 0; p < producers; p++) {
+        producer_threads.emplace_back([&, p]() {
+            while (!go) this_thread::yield();
+            for (long long i = 0; i < per_producer; i++) {
+                QueueItem item;
+                item.seq = p * per_producer + i + 1;
+                if (payload_bytes > 0) item.payload.assign(payload_bytes, static_cast<unsigned char>(i));
+                while (!queue.push(move(item))) this_thread::yield();// 改造前的队列在这里拷贝
+            }
+        });
+    }
+    auto start = Clock::now();
+    go = true;
+    for (thread& t : producer_threads) t.join();
+    queue.stop();
+    for (thread& t : consumer_threads) t.join();
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+    long long total = producers * per_producer;
+    ok = count == total && sum == total * (total + 1) / 2;
+    return ns / static_cast<double>(total);
+}
+
+/**
+ * @brief 队列测试：改造前的SafeQueue与新队列家族的吞吐对比
+ * @details 两种负载（8字节序号 / 带payload字节堆缓冲）× 两种拓扑（1生产者1消费者、2生产者2消费者），
+ *          新队列均用BLOCK策略（满时等待），改造前的队列满时丢弃、生产者让出CPU后重试；
+ *          SpscRing只参加1对1测试
+ * @return int 程序退出码（校验失败返回-1）
+ */
+static int benchQueue(int argc, char** argv) {
+    long long per_producer = (argc > 0) ? max(1, atoi(argv[0])) : 1000000;
+    size_t capacity = (argc > 1) ? max(1, atoi(argv[1])) : 64;
+    size_t payload = (argc > 2) ? max(0, atoi(argv[2])) : 256;
+    bool all_ok = true;
+
+    cout << "每个生产者 " << per_producer << " 个元素, 容量 " << capacity << "\n";
+    for (size_t bytes : {static_cast<size_t>(0), payload}) {
+        for (int threads : {1, 2}) {
+            cout << "负载 " << (bytes ? to_string(bytes) + " 字节" : string("无")) << ", " << threads
+                 << " 生产者/" << threads << " 消费者:\n";
+            double base = 0;
+            auto report = [&](const string& name, double ns, bool ok) {
+                if (base == 0) base = ns;
+                all_ok = all_ok && ok;
+                cout << "  " << name << ": " << ns << " ns/个  相对改造前 " << (ns > 0 ? base / ns : 0.0) << "x"
+                     << (ok ? "" : "  校验失败") << "\n";
+            };
+            bool ok = false;
+            {
+                LegacySafeQueue<QueueItem> q(capacity);
+                double ns = queueThroughput(q, threads, threads, per_producer, bytes, 0, ok);
+                report("改造前SafeQueue", ns, ok);
+            }
+            {
+                SafeQueue<QueueItem, QueueFullPolicy::BLOCK> q(capacity);
+                double ns = queueThroughput(q, threads, threads, per_producer, bytes, 0, ok);
+                report("SafeQueue(移动入队)", ns, ok);
+            }
+            {
+                SafeQueue<QueueItem, QueueFullPolicy::BLOCK> q(capacity);
+                double ns = queueThroughput(q, threads, threads, per_producer, bytes, capacity, ok);
+                report("SafeQueue+drain", ns, ok);
+            }
+            if (threads == 1) {
+                SpscRing<QueueItem, QueueFullPolicy::BLOCK> q(capacity);
+                double ns = queueThroughput(q, 1, 1, per_producer, bytes, 0, ok);
+                report("SpscRing", ns, ok);
+            }
+            {
+                MpmcQueue<QueueItem, QueueFullPolicy::BLOCK> q(capacity);
+                double ns = queueThroughput(q, threads, threads, per_producer, bytes, 0, ok);
+                report("MpmcQueue", ns, ok);
+            }
+        }
+    }
+    return all_ok ? 0 : -1;
+}
+
+/**
+ * @brief 一轮抖动测试：周期线程按30fps节拍sleep_until，记录每次唤醒相对计划时刻的延迟
+ * @param pinned 是否按流水线配置调度：采集线程绑定cpu0并提高优先级（nice:-5），
+ *               负载线程绑定其余核；只有一个核时负载线程与采集线程同核，降为nice:19
+ * @param problems 输出：调度设置失败的说明（如权限不足）
+ */
+static void jitterRun(int seconds, int loads, bool pinned, LatencyHistogram& hist, string& problems) {
+    const int cores = max(1, static_cast<int>(thread::hardware_concurrency()));
+    StageConfig capture_stage, load_stage;
+    if (pinned) {
+        capture_stage.cpus = {0};
+        capture_stage.priority = "nice:-5";
+        if (cores > 1) {
+            for (int c = 1; c < cores; c++) load_stage.cpus.push_back(c);
+        } else {
+            load_stage.cpus = {0};
+            load_stage.priority = "nice:19";
+        }
+    }
+    atomic<bool> stop{false};
+    mutex problems_mtx;
+    auto note = [&](const string& who, const string& text) {
+        if (text.empty()) return;
+        lock_guard<mutex> lock(problems_mtx);
+        problems += " " + who + ":" + text;
+    };
+
+    // 负载线程：纯计算忙循环，模拟检测线程池占满CPU
+    vector<thread> load_threads;
+    for (int i = 0; i < loads; i++) {
+        load_threads.emplace_back([&, i]() {
+            if (i == 0) note("负载", applyThreadPolicy(load_stage));
+            else applyThreadPolicy(load_stage);
+            volatile uint64_t x = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                for (int k = 0; k < 10000; k++) x = x * 6364136223846793005ULL + 1;
+            }
+        });
+    }
+    // 周期线程：模拟采集线程的固定帧间隔
+    thread periodic([&]() {
+        note("采集", applyThreadPolicy(capture_stage));
+        const auto period = chrono::microseconds(1000000 / 30);
+        auto next = chrono::steady_clock::now() + period;
+        auto end = chrono::steady_clock::now() + chrono::seconds(seconds);
+        while (next < end) {
+            this_thread::sleep_until(next);
+            hist.recordSince(next);
+            next += period;
+        }
+    });
+    periodic.join();
+    stop = true;
+    for (thread& t : load_threads) t.join();
+}
+
+/**
+ * @brief 调度抖动测试：负载线程占满CPU时，周期采集线程的唤醒延迟在默认调度与绑核/调整优先级下的对比
+ * @note 提高优先级（nice<0）需要root或CAP_SYS_NICE，失败时只有绑核和负载降级生效，结果中会注明
+ * @return int 程序退出码
+ */
+static int benchJitter(int argc, char** argv) {
+    int seconds = (argc > 0) ? max(1, atoi(argv[0])) : 5;
+    int cores = max(1, static_cast<int>(thread::hardware_concurrency()));
+    int loads = (argc > 1) ? max(0, atoi(argv[1])) : cores;
+
+    cout << "CPU核数 " << cores << ", 负载线程 " << loads << ", 每轮 " << seconds << " 秒, 30fps周期\n";
+    for (bool pinned : {false, true}) {
+        LatencyHistogram hist;
+        string problems;
+        jitterRun(seconds, loads, pinned, hist, problems);
+        cout << "  " << (pinned ? "绑核+优先级" : "默认调度  ") << ": " << hist.count() << " 次唤醒, 延迟 p50 "
+             << hist.percentile(0.5) << " us, p99 " << hist.percentile(0.99) << " us, 最大 " << hist.maxUs() << " us"
+             << (problems.empty() ? "" : "  （设置失败:" + problems + "）") << "\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief 微基准套件：逐项测量流水线各热点路径的单次耗时，输出可机读的结果并与基线比较
+ * @details 用例（名称前缀可用--filter筛选）：
+ *          1. preprocess/ jpeg/：整帧转灰度+均衡化、MJPEG亮度平面解码（输入取自帧源的第一帧，默认合成画面）
+ *          2. detect/：各检测后端的全图检测（模型文件不存在的后端跳过）
+ *          3. lbph/：人脸直方图计算、各画廊规模下的单张检索（合成直方图，≥LBPH_INDEX_MIN_IDENTITIES时
+ *             与门禁程序一样走索引），以及OpenCV LBPHFaceRecognizer的预测耗时（只测小画廊，作参照）
+ *          4. queue/：三种队列单线程入队+出队一次
+ *          5. log/ metrics/：postLog、二进制logEvent（后台线程同时取空日志缓冲）、直方图记录
+ * @note 选项：--format=text|json|csv  --out=<文件>（JSON/CSV写入文件，否则输出到标准输出）
+ *             --baseline=<JSON>  --tolerance=<百分比，默认10>  --filter=<名称子串>
+ *             --source=<帧源，默认synthetic:1>  --gallery=<身份数列表，默认10,100,1000>
+ *             --batches=<计时批数>  --batch-ms=<每批毫秒>
+ * @return int 程序退出码（参数错误、输出失败或存在回归时返回-1）
+ */
+static int benchSuite(int argc, char** argv) {
+    BenchOptions options;
+    string format = "text", out_path, baseline_path, source_spec = "synthetic:1", gallery_list = "10,100,1000";
+    double tolerance = 10.0;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--format") format = value;
+        else if (key == "--out") out_path = value;
+        else if (key == "--baseline") baseline_path = value;
+        else if (key == "--tolerance") tolerance = atof(value.c_str());
+        else if (key == "--filter") options.filter = value;
+        else if (key == "--source") source_spec = value;
+        else if (key == "--gallery") gallery_list = value;
+        else if (key == "--batches") options.batches = max(1, atoi(value.c_str()));
+        else if (key == "--batch-ms") options.batch_ms = max(1.0, atof(value.c_str()));
+        else {
+            cerr << "未知选项: " << arg << "\n";
+            return -1;
+        }
+    }
+    if (format != "text" && format != "json" && format != "csv") {
+        cerr << "未知输出格式: " << format << "（text | json | csv）\n";
+        return -1;
+    }
+    map<string, double> baseline;
+    if (!baseline_path.empty()) {
+        string error;
+        if (!BenchSuite::loadBaseline(baseline_path, baseline, error)) {
+            cerr << "基线读取失败: " << error << "\n";
+            return -1;
+        }
+    }
+
+    // 输入帧：帧源的第一帧（实际分辨率）
+    unique_ptr<FrameSource> source = createFrameSource(source_spec, ReplayMode::FAST);
+    Mat frame;
+    if (!source || !source->open() || !source->read(frame) || frame.empty()) {
+        cerr << "帧源打开失败: " << source_spec << "\n";
+        return -1;
+    }
+    if (frame.channels() == 1) cvtColor(frame, frame, COLOR_GRAY2BGR);
+    const string frame_desc = to_string(frame.cols) + "x" + to_string(frame.rows);
+    BenchSuite suite(options);
+    volatile long long sink = 0;// 防止被测结果被优化掉
+
+    // 1. 预处理与解码
+    Mat gray, equalized;
+    suite.run("preprocess/cvt_equalize", frame_desc + " BGR", [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            cvtColor(frame, gray, COLOR_BGR2GRAY);
+            equalizeHist(gray, equalized);
+        }
+    });
+    vector<unsigned char> jpeg;
+    imencode(".jpg", frame, jpeg);
+    Mat luma;
+    suite.run("jpeg/decode_gray", frame_desc + " 1/" + to_string(MJPEG_SCALE_DENOM) + " " +
+              to_string(jpeg.size() / 1024) + "KB", [&](long long n) {
+        for (long long i = 0; i < n; i++) decodeJpegGray(jpeg.data(), jpeg.size(), luma, MJPEG_SCALE_DENOM);
+    });
+    suite.run("jpeg/decode_color", frame_desc + " imdecode", [&](long long n) {
+        Mat color;
+        Mat data(1, static_cast<int>(jpeg.size()), CV_8UC1, jpeg.data());
+        for (long long i = 0; i < n; i++) imdecode(data, IMREAD_COLOR, &color);
+    });
+
+    // 2. 全图检测
+    cvtColor(frame, gray, COLOR_BGR2GRAY);
+    equalizeHist(gray, equalized);
+    for (const char* backend : {"haar", "lbp", "dnn"}) {
+        string name = string("detect/") + backend + "_full";
+        if (!suite.selected(name)) continue;
+        unique_ptr<FaceDetector> detector = createFaceDetector(backend);
+        if (!detector || !detector->load()) {
+            cerr << "跳过 " << name << "（模型加载失败）\n";
+            continue;
+        }
+        vector<Rect> faces;
+        suite.run(name, frame_desc + " min" + to_string(FACE_MIN_SIZE), [&](long long n) {
+            for (long long i = 0; i < n; i++) detector->detect(equalized, faces, Size(FACE_MIN_SIZE, FACE_MIN_SIZE));
+            sink = sink + static_cast<long long>(faces.size());
+        });
+    }
+
+    // 3. LBPH：直方图计算、各画廊规模下的检索
+    const int face_side = 128;// 典型人脸区域边长
+    Mat face;
+    resize(equalized(Rect(0, 0, min(equalized.cols, equalized.rows), min(equalized.cols, equalized.rows))), face,
+           Size(face_side, face_side));
+    {
+        LbphEngine engine;
+        vector<float> hist(engine.histSize());
+        suite.run("lbph/histogram", to_string(face_side) + "x" + to_string(face_side) + " " +
+                  to_string(engine.histSize()) + "维", [&](long long n) {
+            for (long long i = 0; i < n; i++) engine.computeHistogram(face, hist.data());
+        });
+    }
+    stringstream gs(gallery_list);
+    for (string item; getline(gs, item, ',');) {
+        int identities = atoi(item.c_str());
+        if (identities <= 0) continue;
+        const int per_id = 2;
+        string name = "lbph/predict_" + to_string(identities) + "id";
+        if (suite.selected(name)) {
+            LbphEngine engine;
+            int cells = engine.gridX() * engine.gridY();
+            int patterns = engine.histSize() / cells;
+            size_t hist = engine.histSize();
+            mt19937 rng(identities);
+            vector<float> base(hist), gallery(size_t(identities) * per_id * hist);
+            vector<int> labels(identities * per_id);
+            for (int id = 0; id < identities; id++) {
+                syntheticHistogram(nullptr, 0.0f, cells, patterns, rng, base.data());
+                for (int j = 0; j < per_id; j++) {
+                    syntheticHistogram(base.data(), 0.35f, cells, patterns, rng, &gallery[(id * per_id + j) * hist]);
+                    labels[id * per_id + j] = id;
+                }
+            }
+            if (!engine.assign(gallery.data(), hist, labels.data(), identities * per_id)) {
+                cerr << "跳过 " << name << "（画廊设置失败）\n";
+            } else {
+                // 探针按引擎行长对齐存放（predictHistograms要求）
+                vector<float> probe_buf(engine.stride() + LBPH_ALIGN / sizeof(float), 0.0f);
+                float* probe = probe_buf.data();
+                while (reinterpret_cast<uintptr_t>(probe) % LBPH_ALIGN) probe++;
+                syntheticHistogram(&gallery[0], 0.35f, cells, patterns, rng, probe);
+                int label;
+                double conf;
+                suite.run(name, to_string(identities) + "人×" + to_string(per_id) + "样本" +
+                          (engine.indexed() ? " 索引" : " 全量"), [&](long long n) {
+                    for (long long i = 0; i < n; i++) engine.predictHistograms(probe, 1, &label, &conf);
+                    sink = sink + label;
+                });
+            }
+        }
+        // OpenCV参照：训练需要图像，只测小画廊
+        string cv_name = "lbph/opencv_predict_" + to_string(identities) + "id";
+        if (identities <= 100 && suite.selected(cv_name)) {
+            vector<Mat> images;
+            vector<int> labels;
+            RNG cv_rng(identities);
+            for (int id = 0; id < identities; id++) {
+                for (int j = 0; j < per_id; j++) {
+                    Mat img(face_side, face_side, CV_8UC1);
+                    cv_rng.fill(img, RNG::UNIFORM, 0, 256);
+                    images.push_back(img);
+                    labels.push_back(id);
+                }
+            }
+            Ptr<face::LBPHFaceRecognizer> model = face::LBPHFaceRecognizer::create();
+            model->train(images, labels);
+            int label;
+            double conf;
+            suite.run(cv_name, to_string(identities) + "人×" + to_string(per_id) + "样本", [&](long long n) {
+                for (long long i = 0; i < n; i++) model->predict(face, label, conf);
+                sink = sink + label;
+            });
+        }
+    }
+
+    // 4. 队列：单线程入队+出队一次（无竞争时的固定开销）
+    {
+        SafeQueue<long long> q(64);
+        suite.run("queue/safe_queue", "容量64 单线程", [&](long long n) {
+            long long v = 0;
+            for (long long i = 0; i < n; i++) {
+                q.push(i);
+                q.try_pop(v);
+            }
+            sink = sink + v;
+        });
+    }
+    {
+        SpscRing<long long> q(64);
+        suite.run("queue/spsc_ring", "容量64 单线程", [&](long long n) {
+            long long v = 0;
+            for (long long i = 0; i < n; i++) {
+                q.push(i);
+                q.try_pop(v);
+            }
+            sink = sink + v;
+        });
+    }
+    {
+        MpmcQueue<long long> q(64);
+        suite.run("queue/mpmc_queue", "容量64 单线程", [&](long long n) {
+            long long v = 0;
+            for (long long i = 0; i < n; i++) {
+                q.push(i);
+                q.try_pop(v);
+            }
+            sink = sink + v;
+        });
+    }
+
+    // 5. 日志与指标：后台线程持续取空日志缓冲（同日志线程，不格式化），测量的是生产者一侧的耗时
+    if (suite.selected("log/post_log") || suite.selected("log/log_event")) {// 各用例是否运行由suite.run()判断
+        atomic<bool> done{false};
+        thread consumer([&]() {
+            LogRecord rec;
+            while (!done) {
+                bool got = false;
+                while (g_log_ring.pop(rec)) got = true;// 文本记录的文本槽在pop中归还
+                if (!got) this_thread::yield();
+            }
+        });
+        suite.run("log/post_log", "文本约60字节", [&](long long n) {
+            for (long long i = 0; i < n; i++) postLog("[识别] 轨迹" + to_string(i % 16) + " 确认 ID=" + to_string(i % 100));
+        });
+        suite.run("log/log_event", "6个整数参数", [&](long long n) {
+            for (long long i = 0; i < n; i++) logEvent(LogEvent::RECOG_CONFIRMED, i, 1, static_cast<int>(i % 100), 42, 3, 17);
+        });
+        done = true;
+        consumer.join();
+        LogRecord rec;
+        while (g_log_ring.pop(rec)) {}
+    }
+    {
+        LatencyHistogram histogram;
+        suite.run("metrics/histogram_record", "单线程", [&](long long n) {
+            for (long long i = 0; i < n; i++) histogram.record(i & 0xFFFF);
+        });
+    }
+
+    // 6. 输出与基线比较
+    if (suite.results().empty()) {
+        cerr << "没有用例匹配: " << options.filter << "\n";
+        return -1;
+    }
+    char when[32];
+    time_t now = time(nullptr);
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    map<string, string> meta = {{"timestamp", when},
+                                {"cpus", to_string(thread::hardware_concurrency())},
+                                {"simd", LbphEngine::simdName()},
+                                {"compiler", __VERSION__},
+                                {"opencv", CV_VERSION},
+                                {"source", source_spec}};
+    string text = format == "json" ? suite.toJson(meta) : format == "csv" ? suite.toCsv() : string();
+    if (format == "text") {
+        suite.printText(cout);
+    } else if (out_path.empty()) {
+        cout << text;
+    } else {
+        ofstream out(out_path, ios::binary);
+        if (!(out << text)) {
+            cerr << "结果写入失败: " << out_path << "\n";
+            return -1;
+        }
+        suite.printText(cout);
+        cout << "结果已写入 " << out_path << "\n";
+    }
+    if (!baseline.empty()) {
+        // JSON/CSV输出到标准输出时，比较结果写到标准错误，不混入机读内容
+        ostream& report = (format != "text" && out_path.empty()) ? cerr : cout;
+        if (suite.compare(baseline, tolerance, report) > 0) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 主函数：按子命令分发到各项测试
+ * @return int 程序退出码（0表示正常退出，-1表示参数错误或测试失败）
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "用法：face_door_bench <子命令> [参数...]\n"
+                "  track <帧源> [全图检测间隔]   先跟踪后检测 vs 每帧全图检测\n"
+                "  detect-pool <帧源> [最大线程数] [检测后端]  检测线程池吞吐扩展性\n"
+                "  detect <帧源> [后端列表] [标注CSV]  各检测后端的耗时与召回率\n"
+                "  lbph <样本根目录> [测试样本间隔]    自研LBPH引擎 vs OpenCV（一致性、耗时）\n"
+                "  gallery [身份数列表] [每人样本数] [网格边长] [展开簇数列表]  画廊索引 vs 全量扫描\n"
+                "  enroll [身份数列表] [每人样本数]  分片存储下单人录入耗时 vs 合并耗时（随画廊规模）\n"
+                "  actuator [判定次数] [平均间隔ms]  执行机构判定→引脚翻转延迟（模拟GPIO）\n"
+                "  log [生产者线程数] [每线程条数]  二进制日志 vs 字符串日志的生产者耗时\n"
+                "  queue [每生产者元素数] [容量] [负载字节]  队列家族 vs 改造前SafeQueue的吞吐\n"
+                "  jitter [秒数] [负载线程数]  满载时采集线程唤醒抖动：默认调度 vs 绑核+优先级\n"
+                "  suite [--format=text|json|csv] [--out=文件] [--baseline=JSON] [--tolerance=%] [--filter=子串]\n"
+                "        [--source=帧源] [--gallery=身份数列表]  各热点路径微基准，可与基线比较\n";
+        return -1;
+    }
+    string cmd = argv[1];
+    if (cmd == "track") return benchTrack(argc - 2, argv + 2);
+    if (cmd == "detect-pool") return benchDetectPool(argc - 2, argv + 2);
+    if (cmd == "detect") return benchDetect(argc - 2, argv + 2);
+    if (cmd == "lbph") return benchLbph(argc - 2, argv + 2);
+    if (cmd == "gallery") return benchGallery(argc - 2, argv + 2);
+    if (cmd == "enroll") return benchEnroll(argc - 2, argv + 2);
+    if (cmd == "actuator") return benchActuator(argc - 2, argv + 2);
+    if (cmd == "log") return benchLog(argc - 2, argv + 2);
+    if (cmd == "queue") return benchQueue(argc - 2, argv + 2);
+    if (cmd == "jitter") return benchJitter(argc - 2, argv + 2);
+    if (cmd == "suite") return benchSuite(argc - 2, argv + 2);
+    cerr << "未知子命令: " << cmd << "\n";
+    return -1;
+}
@@ -6,20 +6,26 @@
  */
 #include "face_tool.h"
 #include <iostream>
+#include <cstdlib>
 
 /**
  * @brief 主函数：人脸采集工具入口
+ * @note 用法：face_collect [用户ID] [帧源] [检测后端]
  * @return int 程序退出码（0表示正常退出，-1表示采集失败）
  */
-int main() {
-    // 1. 配置采集参数：指定待采集的用户ID
-    int user_id = 1;
+int main(int argc, char** argv) {
+    // 1. 配置采集参数：指定待采集的用户ID（命令行第1个参数，默认1）
+    int user_id = (argc > 1) ? std::atoi(argv[1]) : 1;
+    // 帧源描述（命令行第2个参数，默认实时摄像头）
+    std::string source_spec = (argc > 2) ? argv[2] : "v4l2:0";
+    // 人脸检测后端（命令行第3个参数，默认与门禁主程序相同）
+    std::string detector_spec = (argc > 3) ? argv[3] : DETECTOR_BACKEND;
 
     // 2. 拼接样本保存目录路径,"face_data/用户ID"
     std::string save_dir = "face_data/" + std::to_string(user_id);
     
     // 3. 调用人脸采集核心函数，执行样本采集流程
-    if (collectFace(user_id, save_dir)) {
+    if (collectFace(user_id, save_dir, source_spec, detector_spec)) {
         std::cout << "人脸采集完成！\n";// 采集成功：打印提示信息
     } else {
         std::cerr << "人脸采集失败！\n";// 采集失败：打印错误信息，并返回非0退出码（标识程序异常）
@@ -0,0 +1,303 @@
+/**
+ * @file face_dataset.cpp
+ * @brief 训练样本集实现（目录同步、线程池解码归一化、打包文件读写）
+ */
+#include "face_dataset.h"
+#include <sys/stat.h>   // stat（纳秒精度修改时间）
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>       // rename/remove
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using namespace cv;
+using namespace std;
+
+namespace {
+
+/**
+ * @brief 打包文件头（各段偏移均相对文件开头，按LBPH_ALIGN对齐）
+ */
+struct DatasetHeader {
+    char magic[8];          // 文件标识 "FACEDSET"
+    uint32_t version;       // 格式版本
+    uint32_t header_size;   // sizeof(DatasetHeader)
+    uint32_t samples;       // 样本数
+    uint32_t sample_size;   // 样本边长（像素）
+    uint64_t labels_offset; // 标签段偏移（int32[samples]）
+    uint64_t records_offset;// 清单段偏移（PackedRecord[samples]）
+    uint64_t paths_offset;  // 相对路径字符串段偏移
+    uint64_t paths_bytes;   // 相对路径字符串段长度
+    uint64_t pixels_offset; // 样本像素段偏移（samples×边长²字节）
+    uint64_t file_size;     // 文件总长度
+};
+
+/**
+ * @brief 清单记录（定长32字节）
+ */
+struct PackedRecord {
+    uint64_t bytes;       // 源文件大小
+    int64_t mtime_ns;     // 源文件修改时间（纳秒）
+    uint64_t hash;        // 源文件内容的64位FNV-1a
+    uint32_t path_offset; // 相对路径在字符串段中的偏移
+    uint32_t path_size;   // 相对路径长度
+};
+static_assert(sizeof(PackedRecord) == 32, "PackedRecord应为32字节");
+
+constexpr char kDatasetMagic[8] = {'F', 'A', 'C', 'E', 'D', 'S', 'E', 'T'};
+constexpr uint32_t kDatasetVersion = 1;
+constexpr size_t kSampleBytes = size_t(TRAIN_SAMPLE_SIZE) * TRAIN_SAMPLE_SIZE;
+
+uint64_t alignUp(uint64_t value) { return (value + LBPH_ALIGN - 1) / LBPH_ALIGN * LBPH_ALIGN; }
+
+uint64_t fnv1a(const unsigned char* data, size_t size) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//目录名转为用户ID（必须全为数字），不是用户目录时返回false
+bool parseLabel(const string& name, int& label) {
+    if (name.empty() || name.size() > 9) return false;
+    if (!all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) return false;
+    label = stoi(name);
+    return true;
+}
+
+//一个待处理的样本文件
+struct ScanEntry {
+    string path;     // 相对路径
+    int label;       // 用户ID
+    uint64_t bytes;  // 文件大小
+    int64_t mtime_ns;// 修改时间
+    int cached;      // 缓存中同路径同标签的记录下标（-1表示没有）
+};
+
+//样本处理结果
+enum class SampleState : uint8_t { REUSED, REHASHED, DECODED, FAILED };
+
+}// namespace
+
+Mat FaceDataset::sample(int i) const {
+    return Mat(TRAIN_SAMPLE_SIZE, TRAIN_SAMPLE_SIZE, CV_8UC1,
+               const_cast<unsigned char*>(pixels_.data()) + size_t(i) * kSampleBytes);
+}
+
+bool FaceDataset::sync(const string& data_dir, int workers, DatasetStats& stats, int only_label) {
+    using Clock = chrono::steady_clock;
+    stats = DatasetStats();
+    auto scan_start = Clock::now();
+
+    // 1. 遍历 <根目录>/<用户ID>/，按路径排序（样本顺序与遍历顺序无关，训练结果可复现）
+    unordered_map<string, int> cached;
+    for (int i = 0; i < size(); i++) cached.emplace(records_[i].path, i);
+    vector<ScanEntry> entries;
+    error_code ec;
+    for (auto& user_dir : fs::directory_iterator(data_dir, ec)) {
+        int label;
+        if (!user_dir.is_directory() || !parseLabel(user_dir.path().filename().string(), label)) continue;
+        if (only_label >= 0 && label != only_label) continue;
+        error_code user_ec;// 单个用户目录无法读取时跳过该用户
+        for (auto& img_file : fs::directory_iterator(user_dir.path(), user_ec)) {
+            string name = img_file.path().filename().string();
+            if (name.empty() || name[0] == '.' || !img_file.is_regular_file()) continue;// 跳过隐藏文件（如写入中的临时文件）
+            struct stat st;
+            if (stat(img_file.path().c_str(), &st) != 0) continue;
+            ScanEntry e{user_dir.path().filename().string() + "/" + name, label, static_cast<uint64_t>(st.st_size),
+                        int64_t(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec, -1};
+            auto it = cached.find(e.path);
+            if (it != cached.end() && labels_[it->second] == label) e.cached = it->second;
+            entries.push_back(move(e));
+        }
+    }
+    if (ec) {
+        cerr << "无法遍历样本目录 " << data_dir << ": " << ec.message() << "\n";
+        return false;
+    }
+    sort(entries.begin(), entries.end(), [](const ScanEntry& a, const ScanEntry& b) { return a.path < b.path; });
+    stats.scan_ms = chrono::duration<double, milli>(Clock::now() - scan_start).count();
+
+    // 2. 大小和修改时间都未变的直接复用缓存中的像素，其余的交给线程池
+    int count = static_cast<int>(entries.size());
+    vector<unsigned char> pixels(size_t(count) * kSampleBytes);
+    vector<Record> records(count);
+    vector<SampleState> states(count, SampleState::REUSED);
+    vector<int> jobs;
+    for (int i = 0; i < count; i++) {
+        const ScanEntry& e = entries[i];
+        records[i] = Record{e.path, e.bytes, e.mtime_ns, 0};
+        if (e.cached >= 0 && records_[e.cached].bytes == e.bytes && records_[e.cached].mtime_ns == e.mtime_ns) {
+            records[i].hash = records_[e.cached].hash;
+            memcpy(pixels.data() + size_t(i) * kSampleBytes, pixels_.data() + size_t(e.cached) * kSampleBytes,
+                   kSampleBytes);
+        } else {
+            jobs.push_back(i);
+        }
+    }
+
+    // 3. 线程池：读文件 → 内容哈希（与缓存相同则复用）→ 灰度解码 → 缩放到统一尺寸，直接写入样本槽位
+    auto decode_start = Clock::now();
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        vector<unsigned char> buf;// 文件内容缓冲（线程内复用）
+        Mat img;
+        for (size_t j = next.fetch_add(1); j < jobs.size(); j = next.fetch_add(1)) {
+            int i = jobs[j];
+            const ScanEntry& e = entries[i];
+            unsigned char* slot = pixels.data() + size_t(i) * kSampleBytes;
+            states[i] = SampleState::FAILED;
+            ifstream in(data_dir + "/" + e.path, ios::binary);
+            buf.resize(e.bytes);
+            if (!in.read(reinterpret_cast<char*>(buf.data()), buf.size()) || buf.empty()) continue;
+            records[i].hash = fnv1a(buf.data(), buf.size());
+            if (e.cached >= 0 && records_[e.cached].bytes == e.bytes && records_[e.cached].hash == records[i].hash) {
+                memcpy(slot, pixels_.data() + size_t(e.cached) * kSampleBytes, kSampleBytes);
+                states[i] = SampleState::REHASHED;
+                continue;
+            }
+            img = imdecode(Mat(1, static_cast<int>(buf.size()), CV_8UC1, buf.data()), IMREAD_GRAYSCALE);
+            if (img.empty()) continue;// 跳过损坏/格式错误的样本文件
+            Mat dst(TRAIN_SAMPLE_SIZE, TRAIN_SAMPLE_SIZE, CV_8UC1, slot);
+            if (img.size() == dst.size()) img.copyTo(dst);
+            else resize(img, dst, dst.size(), 0, 0, img.cols > TRAIN_SAMPLE_SIZE ? INTER_AREA : INTER_LINEAR);// 插值方式同人脸池
+            states[i] = SampleState::DECODED;
+        }
+    };
+    if (workers <= 0) workers = static_cast<int>(thread::hardware_concurrency());
+    workers = max(1, min(workers, static_cast<int>(jobs.size())));
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) pool.emplace_back(worker);
+    worker();// 当前线程也参与
+    for (thread& t : pool) t.join();
+    stats.decode_ms = chrono::duration<double, milli>(Clock::now() - decode_start).count();
+
+    // 4. 去掉失败的样本（就地前移），替换原样本集
+    vector<int> labels;
+    labels.reserve(count);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        switch (states[i]) {
+            case SampleState::REUSED: stats.reused++; break;
+            case SampleState::REHASHED: stats.rehashed++; break;
+            case SampleState::DECODED: stats.decoded++; break;
+            case SampleState::FAILED: stats.failed++; continue;
+        }
+        if (kept != i) {
+            memmove(pixels.data() + size_t(kept) * kSampleBytes, pixels.data() + size_t(i) * kSampleBytes, kSampleBytes);
+            records[kept] = move(records[i]);
+        }
+        labels.push_back(entries[i].label);
+        kept++;
+    }
+    pixels.resize(size_t(kept) * kSampleBytes);
+    records.resize(kept);
+    int matched = 0;// 缓存中仍在目录里的记录数（其余为已删除的样本）
+    for (const ScanEntry& e : entries) matched += e.cached >= 0;
+    stats.removed = size() - matched;
+    stats.samples = kept;
+    pixels_ = move(pixels);
+    records_ = move(records);
+    labels_ = move(labels);
+    return true;
+}
+
+bool FaceDataset::load(const string& path) {
+    labels_.clear();
+    records_.clear();
+    pixels_.clear();
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in) return false;
+    uint64_t actual_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    DatasetHeader h{};
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || memcmp(h.magic, kDatasetMagic, sizeof(h.magic)) != 0 ||
+        h.version != kDatasetVersion || h.header_size != sizeof(DatasetHeader) ||
+        h.sample_size != static_cast<uint32_t>(TRAIN_SAMPLE_SIZE) || h.file_size != actual_size) {
+        return false;// 不是本格式/版本或样本尺寸已修改，调用方重新同步
+    }
+    uint64_t n = h.samples;
+    if (h.labels_offset + n * sizeof(int32_t) > h.file_size || h.records_offset + n * sizeof(PackedRecord) > h.file_size ||
+        h.paths_offset + h.paths_bytes > h.file_size || h.pixels_offset + n * kSampleBytes > h.file_size) {
+        return false;
+    }
+    vector<int32_t> labels(n);
+    vector<PackedRecord> packed(n);
+    string paths(h.paths_bytes, '\0');
+    vector<unsigned char> pixels(n * kSampleBytes);
+    auto readAt = [&in](uint64_t offset, void* dst, size_t bytes) {
+        return bytes == 0 || (in.seekg(static_cast<streamoff>(offset)) && in.read(static_cast<char*>(dst), bytes));
+    };
+    if (!readAt(h.labels_offset, labels.data(), n * sizeof(int32_t)) ||
+        !readAt(h.records_offset, packed.data(), n * sizeof(PackedRecord)) ||
+        !readAt(h.paths_offset, &paths[0], paths.size()) || !readAt(h.pixels_offset, pixels.data(), pixels.size())) {
+        return false;
+    }
+    vector<Record> records(n);
+    for (uint64_t i = 0; i < n; i++) {
+        const PackedRecord& r = packed[i];
+        if (uint64_t(r.path_offset) + r.path_size > paths.size()) return false;
+        records[i] = Record{paths.substr(r.path_offset, r.path_size), r.bytes, r.mtime_ns, r.hash};
+    }
+    labels_.assign(labels.begin(), labels.end());
+    records_ = move(records);
+    pixels_ = move(pixels);
+    return true;
+}
+
+bool FaceDataset::save(const string& path) const {
+    // 1. 拼出文件头、标签、清单和路径段（像素段直接从pixels_写出，不再复制一份）
+    uint64_t n = labels_.size();
+    string paths;
+    vector<PackedRecord> packed(n);
+    for (uint64_t i = 0; i < n; i++) {
+        const Record& r = records_[i];
+        packed[i] = PackedRecord{r.bytes, r.mtime_ns, r.hash, static_cast<uint32_t>(paths.size()),
+                                 static_cast<uint32_t>(r.path.size())};
+        paths += r.path;
+    }
+    DatasetHeader h{};
+    memcpy(h.magic, kDatasetMagic, sizeof(kDatasetMagic));
+    h.version = kDatasetVersion;
+    h.header_size = sizeof(DatasetHeader);
+    h.samples = static_cast<uint32_t>(n);
+    h.sample_size = TRAIN_SAMPLE_SIZE;
+    h.labels_offset = alignUp(sizeof(DatasetHeader));
+    h.records_offset = alignUp(h.labels_offset + n * sizeof(int32_t));
+    h.paths_offset = alignUp(h.records_offset + n * sizeof(PackedRecord));
+    h.paths_bytes = paths.size();
+    h.pixels_offset = alignUp(h.paths_offset + h.paths_bytes);
+    h.file_size = h.pixels_offset + pixels_.size();
+    vector<int32_t> labels(labels_.begin(), labels_.end());
+
+    // 2. 按偏移依次写出（段间补0），先写临时文件再改名
+    string tmp_path = path + ".tmp";
+    {
+        ofstream out(tmp_path, ios::binary | ios::trunc);
+        uint64_t written = 0;
+        auto writeAt = [&](uint64_t offset, const void* data, size_t bytes) {
+            static const char zeros[LBPH_ALIGN] = {};
+            out.write(zeros, static_cast<streamsize>(offset - written));
+            out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+            written = offset + bytes;
+        };
+        writeAt(0, &h, sizeof(h));
+        writeAt(h.labels_offset, labels.data(), labels.size() * sizeof(int32_t));
+        writeAt(h.records_offset, packed.data(), packed.size() * sizeof(PackedRecord));
+        writeAt(h.paths_offset, paths.data(), paths.size());
+        writeAt(h.pixels_offset, pixels_.data(), pixels_.size());
+        if (!out.flush()) {
+            remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
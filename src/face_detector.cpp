@@ -0,0 +1,102 @@
+/**
+ * @file face_detector.cpp
+ * @brief 人脸检测后端实现：Haar/LBP级联分类器、cv::dnn SSD模型
+ */
+#include "face_detector.h"
+#include "config.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+using namespace cv;
+using namespace std;
+
+// ====================== 模型文件查找 ======================
+
+string findModelFile(const string& file) {
+    error_code ec;
+    if (file.empty()) return "";
+    // 绝对路径或带目录的相对路径：只检查这一个位置
+    if (fs::path(file).has_parent_path()) return fs::is_regular_file(file, ec) ? file : "";
+    for (const char* dir : MODEL_SEARCH_DIRS) {
+        string path = string(dir) + file;
+        if (fs::is_regular_file(path, ec)) return path;
+    }
+    return "";
+}
+
+//人脸边长是否在[min_size, max_size]范围内（max_size为空表示不限）
+static bool sizeInRange(const Rect& r, Size min_size, Size max_size) {
+    if (r.width < min_size.width || r.height < min_size.height) return false;
+    if (max_size.area() > 0 && (r.width > max_size.width || r.height > max_size.height)) return false;
+    return true;
+}
+
+// ====================== 级联分类器 ======================
+
+bool CascadeFaceDetector::load() {
+    string path = findModelFile(path_);
+    if (path.empty() || !cascade_.load(path)) return false;
+    path_ = path;
+    return true;
+}
+
+void CascadeFaceDetector::detect(const Mat& gray, vector<Rect>& faces, Size min_size, Size max_size) {
+    cascade_.detectMultiScale(gray, faces, DETECT_SCALE_FACTOR, DETECT_MIN_NEIGHBORS, 0, min_size, max_size);
+}
+
+// ====================== cv::dnn ======================
+
+bool DnnFaceDetector::load() {
+    string model = findModelFile(model_);
+    string config = config_.empty() ? "" : findModelFile(config_);
+    if (model.empty() || (!config_.empty() && config.empty())) return false;
+    net_ = dnn::readNet(model, config);
+    if (net_.empty()) return false;
+    net_.setPreferableBackend(dnn::DNN_BACKEND_OPENCV);
+    net_.setPreferableTarget(dnn::DNN_TARGET_CPU);
+    model_ = model;
+    config_ = config;
+    return true;
+}
+
+void DnnFaceDetector::detect(const Mat& gray, vector<Rect>& faces, Size min_size, Size max_size) {
+    faces.clear();
+    if (gray.empty()) return;
+    // 模型按BGR训练：灰度复制到3通道，减去训练集均值
+    cvtColor(gray, bgr_, COLOR_GRAY2BGR);
+    blob_ = dnn::blobFromImage(bgr_, 1.0, Size(DNN_INPUT_SIZE, DNN_INPUT_SIZE), Scalar(104, 177, 123));
+    net_.setInput(blob_);
+    Mat out = net_.forward();
+    // 输出为[1,1,N,7]：每行 (batch, class, conf, x1, y1, x2, y2)，坐标为0~1的相对值
+    const float* det = out.ptr<float>();
+    size_t n = out.total() / 7;
+    Rect bounds(0, 0, gray.cols, gray.rows);
+    for (size_t i = 0; i < n; i++, det += 7) {
+        if (det[2] < DNN_CONFIDENCE) continue;
+        int x1 = static_cast<int>(det[3] * gray.cols), y1 = static_cast<int>(det[4] * gray.rows);
+        int x2 = static_cast<int>(det[5] * gray.cols), y2 = static_cast<int>(det[6] * gray.rows);
+        Rect r = Rect(x1, y1, x2 - x1, y2 - y1) & bounds;
+        if (!r.empty() && sizeInRange(r, min_size, max_size)) faces.push_back(r);
+    }
+}
+
+// ====================== 工厂函数 ======================
+
+unique_ptr<FaceDetector> createFaceDetector(const string& spec) {
+    // 拆分 "后端:模型路径"
+    size_t colon = spec.find(':');
+    string type = spec.substr(0, colon);
+    string arg = (colon == string::npos) ? "" : spec.substr(colon + 1);
+
+    if (type == "haar") return make_unique<CascadeFaceDetector>("haar", arg.empty() ? HAAR_PATH : arg);
+    if (type == "lbp") return make_unique<CascadeFaceDetector>("lbp", arg.empty() ? LBP_PATH : arg);
+    if (type == "dnn") {
+        if (arg.empty()) return make_unique<DnnFaceDetector>(DNN_MODEL_PATH, DNN_CONFIG_PATH);
+        // "权重,网络结构"（网络结构可省略）
+        size_t comma = arg.find(',');
+        return make_unique<DnnFaceDetector>(arg.substr(0, comma),
+                                            comma == string::npos ? "" : arg.substr(comma + 1));
+    }
+    return nullptr;
+}
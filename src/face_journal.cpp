@@ -0,0 +1,166 @@
+/**
+ * @file face_journal.cpp
+ * @brief 出入记录查询工具主程序
+ * @details 只读映射journal目录下的索引文件，按时间范围（段内二分）、用户ID、判定类型筛选记录，
+ *          可导出单条记录的人脸缩略图；可与门禁程序同时运行（只看到打开时已写入的记录）
+ * @note 用法见usage()
+ */
+#include "config.h"
+#include "journal.h"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace std;
+
+static void usage() {
+    cerr << "用法：face_journal [--dir=目录，默认" << JOURNAL_DIR << "] <命令> [条件...]\n"
+            "  query                      列出符合条件的记录\n"
+            "  count                      按判定类型、用户ID统计符合条件的记录\n"
+            "  thumb <段名>#<序号> <输出.jpg>  导出一条记录的人脸缩略图（编号见query输出）\n"
+            "  stats                      段数、记录数、磁盘占用\n"
+            "条件：--from=\"2026-10-16 08:00\" --to=\"2026-10-16 09:00\"（本地时间，不含to）\n"
+            "      --label=用户ID --verdict=confirmed|rejected|revoked --limit=最多列出条数\n";
+}
+
+//解析本地时间"YYYY-MM-DD[ HH:MM[:SS]]"为毫秒时间戳，失败返回false
+static bool parseTime(const string& text, int64_t& ms) {
+    static const char* formats[] = {"%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%d"};
+    for (const char* fmt : formats) {
+        tm t;
+        memset(&t, 0, sizeof(t));
+        const char* end = strptime(text.c_str(), fmt, &t);
+        if (!end || *end != '\0') continue;
+        t.tm_isdst = -1;
+        time_t sec = mktime(&t);
+        if (sec == -1) return false;
+        ms = static_cast<int64_t>(sec) * 1000;
+        return true;
+    }
+    return false;
+}
+
+static string formatTime(int64_t ms) {
+    time_t sec = static_cast<time_t>(ms / 1000);
+    tm t;
+    localtime_r(&sec, &t);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &t);
+    char out[40];
+    snprintf(out, sizeof(out), "%s.%03d", buf, static_cast<int>(ms % 1000));
+    return out;
+}
+
+static const char* verdictName(uint8_t verdict) {
+    switch (static_cast<JournalVerdict>(verdict)) {
+    case JournalVerdict::CONFIRMED: return "confirmed";
+    case JournalVerdict::REJECTED: return "rejected";
+    case JournalVerdict::REVOKED: return "revoked";
+    }
+    return "?";
+}
+
+/**
+ * @brief 主函数：出入记录查询工具入口
+ * @return int 程序退出码（0表示正常退出，-1表示参数错误或查询失败）
+ */
+int main(int argc, char** argv) {
+    string dir = JOURNAL_DIR, command;
+    vector<string> args;
+    JournalReader::Query q;
+    long limit = -1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool ok = true;
+        if (arg.rfind("--dir=", 0) == 0) dir = arg.substr(6);
+        else if (arg.rfind("--from=", 0) == 0) ok = parseTime(arg.substr(7), q.from_ms);
+        else if (arg.rfind("--to=", 0) == 0) ok = parseTime(arg.substr(5), q.to_ms);
+        else if (arg.rfind("--label=", 0) == 0) q.label = atoi(arg.c_str() + 8);
+        else if (arg.rfind("--limit=", 0) == 0) ok = (limit = atol(arg.c_str() + 8)) > 0;// 至少列出1条
+        else if (arg.rfind("--verdict=", 0) == 0) {
+            string v = arg.substr(10);
+            if (v == "confirmed") q.verdict = static_cast<uint8_t>(JournalVerdict::CONFIRMED);
+            else if (v == "rejected") q.verdict = static_cast<uint8_t>(JournalVerdict::REJECTED);
+            else if (v == "revoked") q.verdict = static_cast<uint8_t>(JournalVerdict::REVOKED);
+            else ok = false;
+        } else if (arg.rfind("--", 0) == 0) ok = false;
+        else if (command.empty()) command = arg;
+        else args.push_back(arg);
+        if (!ok) {
+            cerr << "无效参数: " << arg << "\n";
+            usage();
+            return -1;
+        }
+    }
+    if (command.empty()) {
+        usage();
+        return -1;
+    }
+
+    JournalReader reader;
+    if (!reader.open(dir)) {
+        cerr << "无法打开出入记录目录: " << dir << "\n";
+        return -1;
+    }
+
+    if (command == "stats") {
+        cout << "目录 " << dir << "：" << reader.segments() << " 段, " << reader.entries() << " 条记录, "
+             << reader.bytes() / 1024 << " KB\n";
+        return 0;
+    }
+
+    if (command == "thumb") {
+        size_t hash = args.size() == 2 ? args[0].find('#') : string::npos;
+        if (hash == string::npos) {
+            usage();
+            return -1;
+        }
+        vector<unsigned char> jpeg;
+        if (!reader.thumbnail(args[0].substr(0, hash), static_cast<uint32_t>(atol(args[0].c_str() + hash + 1)), jpeg)) {
+            cerr << "记录不存在或没有缩略图: " << args[0] << "\n";
+            return -1;
+        }
+        ofstream out(args[1], ios::binary);
+        out.write(reinterpret_cast<const char*>(jpeg.data()), static_cast<streamsize>(jpeg.size()));
+        if (!out) {
+            cerr << "无法写入: " << args[1] << "\n";
+            return -1;
+        }
+        cout << "已导出 " << args[0] << " -> " << args[1] << "（" << jpeg.size() << " 字节）\n";
+        return 0;
+    }
+
+    if (command == "query" || command == "count") {
+        bool list = command == "query";
+        map<int, size_t> per_label;
+        size_t per_verdict[4] = {0, 0, 0, 0};
+        long listed = 0;
+        auto t0 = chrono::steady_clock::now();
+        size_t hits = reader.query(q, [&](const JournalReader::Hit& hit) {
+            const JournalEntry& e = hit.entry;
+            if (list) {
+                cout << hit.segment << "#" << hit.index << "  " << formatTime(e.ts_ms) << "  " << verdictName(e.verdict)
+                     << "  用户 " << e.label << "  距离 " << e.confidence << "  轨迹 " << e.track_id
+                     << (e.thumb_size ? "" : "  （无缩略图）") << "\n";
+                return limit < 0 || ++listed < limit;
+            }
+            if (e.verdict < 4) per_verdict[e.verdict]++;
+            per_label[e.label]++;
+            return true;
+        });
+        double query_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (!list) {
+            cout << "确认 " << per_verdict[1] << "  拒绝 " << per_verdict[2] << "  撤销 " << per_verdict[3] << "\n";
+            for (const auto& kv : per_label) cout << "  用户 " << kv.first << ": " << kv.second << " 条\n";
+        }
+        cout << "共 " << hits << " 条（检索 " << reader.entries() << " 条中的匹配项），查询耗时 " << query_ms << " ms\n";
+        return 0;
+    }
+
+    usage();
+    return -1;
+}
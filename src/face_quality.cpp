@@ -0,0 +1,85 @@
+/**
+ * @file face_quality.cpp
+ * @brief 人脸质量评分实现（尺寸、曝光、拉普拉斯清晰度、镜像对称性）
+ */
+#include "face_quality.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+//指标相对阈值的余量映射到(0,1]：刚好达到阈值为0.5，达到2倍阈值为1
+static double margin(double value, double threshold) {
+    return min(1.0, value / (2.0 * threshold));
+}
+
+FaceQuality FaceQualityGate::evaluate(const Mat& luma, int scale) {
+    FaceQuality q;
+    // 1. 尺寸（按原始分辨率）
+    int side = min(luma.cols, luma.rows) * scale;
+    if (side < QUALITY_MIN_FACE) {
+        q.reason = QualityReason::SMALL;
+        return q;
+    }
+    // 2. 曝光：统一缩放后的平均亮度与标准差
+    resize(luma, sample_, Size(QUALITY_SAMPLE_SIZE, QUALITY_SAMPLE_SIZE), 0, 0, INTER_AREA);
+    Scalar mean, stddev;
+    meanStdDev(sample_, mean, stddev);
+    q.mean = mean[0];
+    q.contrast = stddev[0];
+    if (q.mean < QUALITY_MIN_MEAN) q.reason = QualityReason::DARK;
+    else if (q.mean > QUALITY_MAX_MEAN) q.reason = QualityReason::BRIGHT;
+    else if (q.contrast < QUALITY_MIN_CONTRAST) q.reason = QualityReason::LOW_CONTRAST;
+    if (q.reason != QualityReason::OK) return q;
+    // 3. 清晰度：拉普拉斯响应的方差（模糊/拖影时边缘响应弱）
+    Laplacian(sample_, lap_, CV_16S);
+    meanStdDev(lap_, mean, stddev);
+    q.sharpness = stddev[0] * stddev[0];
+    if (q.sharpness < QUALITY_MIN_SHARPNESS) {
+        q.reason = QualityReason::BLUR;
+        return q;
+    }
+    // 4. 正脸程度：左半与水平翻转后的右半逐像素比较（侧脸时五官偏向一侧，差异变大）
+    int half = QUALITY_SAMPLE_SIZE / 2;
+    flip(sample_(Rect(QUALITY_SAMPLE_SIZE - half, 0, half, QUALITY_SAMPLE_SIZE)), mirror_, 1);
+    absdiff(sample_(Rect(0, 0, half, QUALITY_SAMPLE_SIZE)), mirror_, diff_);
+    q.asymmetry = cv::mean(diff_)[0] / max(q.mean, 1.0);
+    if (q.asymmetry > QUALITY_MAX_ASYMMETRY) {
+        q.reason = QualityReason::ASYMMETRIC;
+        return q;
+    }
+    // 5. 综合得分：各项余量之积（曝光取离上下限较近的一侧）
+    double exposure = min(q.mean - QUALITY_MIN_MEAN, QUALITY_MAX_MEAN - q.mean) /
+                      (0.5 * (QUALITY_MAX_MEAN - QUALITY_MIN_MEAN));
+    q.score = margin(side, QUALITY_MIN_FACE) * margin(q.sharpness, QUALITY_MIN_SHARPNESS) *
+              margin(q.contrast, QUALITY_MIN_CONTRAST) * (0.5 + 0.5 * exposure) *
+              (1.0 - 0.5 * q.asymmetry / QUALITY_MAX_ASYMMETRY);
+    return q;
+}
+
+const char* FaceQualityGate::reasonName(QualityReason reason) {
+    switch (reason) {
+    case QualityReason::OK: return "合格";
+    case QualityReason::SMALL: return "过小";
+    case QualityReason::DARK: return "欠曝";
+    case QualityReason::BRIGHT: return "过曝";
+    case QualityReason::LOW_CONTRAST: return "对比度低";
+    case QualityReason::BLUR: return "模糊";
+    case QualityReason::ASYMMETRIC: return "侧脸";
+    default: return "未知";
+    }
+}
+
+string QualityCounters::summary() const {
+    unsigned long long total = 0;
+    for (const auto& c : counts_) total += c;
+    unsigned long long passed = count(QualityReason::OK);
+    string text = "[质量] 评估 " + to_string(total) + " 张人脸, 通过 " + to_string(passed) + " 张, 拒绝 " +
+                  to_string(total - passed) + " 张(省去同等次数的识别)";
+    for (int i = static_cast<int>(QualityReason::OK) + 1; i < static_cast<int>(QualityReason::COUNT); i++) {
+        unsigned long long n = counts_[i];
+        text += string(", ") + FaceQualityGate::reasonName(static_cast<QualityReason>(i)) + " " + to_string(n) +
+                "(" + to_string(total > 0 ? 100.0 * n / total : 0.0) + "%)";
+    }
+    return text;
+}
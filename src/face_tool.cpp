@@ -2,52 +2,51 @@
  * @file face_tool.cpp
  * @brief 人脸工具类实现（采集+训练）
  * @details 1. collectFace：从摄像头采集指定用户ID的人脸样本，保存到指定目录
- *          2. trainLBPHModel：遍历人脸样本目录，训练LBPH人脸识别模型并保存
+ *          2. trainLBPHModel：同步人脸样本目录（只解码新增/变化的样本），多线程训练LBPH人脸识别模型，写出分片并保存
+ *          3. enrollIdentity/removeIdentity：单人录入/删除，只重算该人的分片，合并分片生成模型
  */
 #include "face_tool.h"
-#include <opencv2/face.hpp> // OpenCV人脸识别模块（LBPH算法）
+#include "face_dataset.h"   // 训练样本集（线程池解码、预处理缓存）
+#include "frame_source.h" // 帧源（摄像头/录像/图片目录）
+#include "face_detector.h"// 人脸检测后端（与门禁主程序共用）
+#include "lbph_engine.h"    // 自研LBPH识别引擎（模型与OpenCV格式兼容）
+#include "model_shards.h"   // 按身份分片的模型存储
+#include <chrono>           // 训练各阶段计时
 #include <filesystem>       // C++17文件系统（遍历目录/创建文件夹）
 #include <iostream>         // 标准输入输出（提示/错误信息）
+#include <map>
+#include <thread>           // hardware_concurrency
 
 namespace fs = std::filesystem;
 using namespace cv;
-using namespace cv::face;
 using namespace std;
 
 /**
  * @brief 人脸采集函数（核心实现）
  * @details 1. 根据传入的保存目录创建文件夹
- *          2. 打开摄像头，加载Haar人脸检测器
+ *          2. 打开帧源，加载人脸检测器
  *          3. 实时采帧、检测人脸并框选显示
  *          4. 按C键保存灰度人脸样本，按Q键退出
  * @param user_id 采集的用户ID（用于标识样本归属）
  * @param save_dir 人脸样本保存目录（如"face_data/1"）
- * @return bool 采集成功返回true，摄像头打开失败返回false
+ * @param source_spec 帧源描述（默认实时摄像头，也可用录像/图片目录离线采集）
+ * @param detector_spec 人脸检测后端描述（haar/lbp/dnn）
+ * @return bool 采集成功返回true，摄像头打开失败或检测器加载失败返回false
  */
-bool collectFace(int user_id, const std::string& save_dir) {
+bool collectFace(int user_id, const std::string& save_dir, const std::string& source_spec,
+                 const std::string& detector_spec) {
     // 1. 递归创建样本保存目录
     fs::create_directories(save_dir);
     
-    // 2. 打开默认摄像头（设备号0）
-    VideoCapture cap(0, CAP_V4L2); // 强制V4L2后端，和门禁主程序保持一致
-    if (!cap.isOpened()) return false;// 摄像头打开失败，直接返回false
-
-    //设置采集分辨率（和门禁主程序匹配，避免训练/识别分辨率不一致）
-    cap.set(CAP_PROP_FRAME_WIDTH, 640);
-    cap.set(CAP_PROP_FRAME_HEIGHT, 480);
+    // 2. 打开帧源（与门禁主程序共用帧源实现，分辨率配置保持一致，避免训练/识别分辨率不一致）
+    unique_ptr<FrameSource> source = createFrameSource(source_spec);
+    if (!source || !source->open()) return false;// 帧源打开失败，直接返回false
     
-    // 3. 加载Haar人脸检测器
-    CascadeClassifier face_cascade;// 声明Haar级联分类器对象
-    std::string haar_path = "haarcascade_frontalface_alt.xml";
-    if (!face_cascade.load(haar_path)) {
-        haar_path = "/usr/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml";
-        if (!face_cascade.load(haar_path)) {
-            haar_path = "/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_alt.xml";
-            if (!face_cascade.load(haar_path)) {
-                std::cerr << "Haar检测器加载失败!\n";
-                return false;
-            }
-        }
+    // 3. 加载人脸检测器（模型文件在当前目录/OpenCV安装目录中查找，见MODEL_SEARCH_DIRS）
+    unique_ptr<FaceDetector> detector = createFaceDetector(detector_spec);
+    if (!detector || !detector->load()) {
+        std::cerr << "人脸检测器加载失败: " << detector_spec << "\n";
+        return false;
     }
     
     // 4. 变量初始化
@@ -58,14 +57,17 @@ bool collectFace(int user_id, const std::string& save_dir) {
     
     // 5. 主循环：采帧→检测→显示→保存
     while (true) {
-        // 读取摄像头帧
-        cap >> frame;
+        // 读取一帧，回放源播放完毕时结束采集
+        if (!source->read(frame)) {
+            if (source->finished()) break;
+            continue;
+        }
         
         // 彩色帧转灰度帧（减少计算量，符合检测/训练要求）
         cvtColor(frame, gray, COLOR_BGR2GRAY);
         
-        // Haar人脸检测：参数（灰度图，人脸区域，缩放因子，邻域数，过滤规则，最小人脸尺寸）
-        face_cascade.detectMultiScale(gray, faces, 1.1, 4, 0, Size(60, 60));
+        // 人脸检测：参数（灰度图，人脸区域，最小人脸尺寸），检测参数与门禁主程序一致
+        detector->detect(gray, faces, Size(FACE_MIN_SIZE, FACE_MIN_SIZE));
         
         // 绘制人脸框（绿色，线宽2，方便用户查看检测结果）
         for (auto& f : faces) rectangle(frame, f, Scalar(0,255,0), 2);
@@ -89,54 +91,195 @@ bool collectFace(int user_id, const std::string& save_dir) {
     }
     
     // 6. 资源释放
-    cap.release();       // 释放摄像头
+    source->release();   // 释放帧源
     destroyAllWindows(); // 关闭显示窗口
     return true;
 }
 
+//耗时（毫秒）
+static double msSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+//训练线程数（≤0表示使用全部CPU核）
+static int resolveWorkers(int workers) {
+    return workers > 0 ? workers : max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+/**
+ * @brief 合并全部分片为运行时画廊并保存模型
+ * @details 只读取分片拼接直方图、重建画廊索引、写出模型，不重新计算任何直方图；
+ *          skip_label≥0时不合并该用户的分片（没有其他分片时保存空画廊）
+ * @return bool 成功返回true，没有分片/分片损坏/保存失败返回false
+ */
+static bool mergeShards(const ShardStore& store, const string& model_path, int skip_label = -1) {
+    auto start = chrono::steady_clock::now();
+    LbphEngine model;
+    int shards = 0;
+    if (!store.merge(model, shards, skip_label) || !model.save(model_path)) return false;
+    cout << "合并 " << shards << " 个分片（" << model.samples() << " 个样本）→ " << model_path << "：" << msSince(start)
+         << " ms\n";
+    return true;
+}
+
 /**
- * @brief LBPH人脸识别模型训练函数（核心实现）
- * @details 1. 遍历指定样本目录（按用户ID分文件夹）
- *          2. 读取所有用户的灰度人脸样本，关联对应的ID标签
- *          3. 训练LBPH模型，保存到指定路径
+ * @brief 首次单人增删时从现有模型导出分片
+ * @details 分片目录为空而模型已存在（分片存储之前训练的模型）时，按用户ID把模型中的直方图写成分片，
+ *          否则合并结果只剩本次录入的用户
+ * @return bool 无需导出或导出成功返回true
+ */
+static bool ensureShards(const ShardStore& store, const string& model_path) {
+    if (!store.labels().empty() || !fs::exists(model_path)) return true;
+    LbphEngine model;
+    if (!model.load(model_path)) {
+        cerr << "现有模型加载失败，无法导出分片: " << model_path << "\n";
+        return false;
+    }
+    map<int, vector<int>> rows;// 用户ID → 样本下标
+    for (int i = 0; i < model.samples(); i++) rows[model.label(i)].push_back(i);
+    for (const auto& kv : rows) {
+        if (!store.write(kv.first, model, kv.second)) return false;
+    }
+    cout << "已从现有模型导出 " << rows.size() << " 个分片 → " << store.dir() << "\n";
+    return true;
+}
+
+/**
+ * @brief LBPH人脸识别模型训练函数（全量重建）
+ * @details 1. 读取样本根目录下的预处理缓存（TRAIN_DATASET_FILE），与目录同步：
+ *             只有新增或变化的样本才在线程池中解码并缩放到统一尺寸，已删除的样本从缓存中去掉
+ *          2. 保存更新后的缓存，下次训练直接复用
+ *          3. 线程池计算全部样本的直方图，按用户ID写出全部分片，删除已无样本的用户的分片
+ *          4. 训练结果即全部分片的合并结果，直接保存到指定路径
  * @param data_dir 人脸样本根目录（如"face_data"，下级为用户ID文件夹）
- * @param model_path 训练好的模型保存路径（如"lbph_model.yml"）
+ * @param model_path 训练好的模型保存路径（如"lbph_model.bin"；扩展名为.yml时保存为OpenCV兼容格式）
+ * @param workers 线程数（≤0表示使用全部CPU核）
+ * @param shard_dir 分片目录
  * @return bool 训练成功返回true，无样本/训练失败返回false
  */
-bool trainLBPHModel(const std::string& data_dir, const std::string& model_path) {
-    // 1. 初始化样本容器：images存储人脸图像，labels存储对应用户ID
-    vector<Mat> images;// 人脸样本图像集合
-    vector<int> labels;// 样本对应的用户ID标签集合
-
-    // 2. 遍历样本根目录（遍历每个用户ID文件夹）
-    for (auto& user_dir : fs::directory_iterator(data_dir)) {
-        // 跳过非目录文件（只处理用户ID文件夹）
-        if (!user_dir.is_directory()) continue;
-        
-        // 获取用户ID（文件夹名转为数字）
-        int id = stoi(user_dir.path().filename().string());
-        
-        // 遍历当前用户ID文件夹下的所有文件（即该用户的所有人脸样本）
-        for (auto& img_file : fs::directory_iterator(user_dir.path())) {
-            Mat img = imread(img_file.path().string(), 0);// 读取人脸样本图像
-            if (img.empty()) continue;// 过滤空图像：跳过损坏/格式错误/无法读取的样本文件
-            images.push_back(img);    // 将有效人脸样本添加到训练集
-            labels.push_back(id);     // 将样本对应的用户ID标签添加到标签集
-        }
+bool trainLBPHModel(const std::string& data_dir, const std::string& model_path, int workers,
+                    const std::string& shard_dir) {
+    workers = resolveWorkers(workers);
+
+    // 1. 读取预处理缓存（不存在、格式版本或样本尺寸不符时从空样本集开始，全部重新解码）
+    string cache_path = data_dir + "/" + TRAIN_DATASET_FILE;
+    FaceDataset dataset;
+    bool cached = dataset.load(cache_path);
+
+    // 2. 与样本目录同步，只解码新增或变化的样本
+    DatasetStats stats;
+    if (!dataset.sync(data_dir, workers, stats)) return false;
+    cout << "样本 " << stats.samples << " 张（" << workers << " 线程）：复用 " << stats.reused + stats.rehashed
+         << "（其中按内容哈希 " << stats.rehashed << "），解码 " << stats.decoded << "，失败 " << stats.failed
+         << "，已删除 " << stats.removed << (cached ? "" : "，无可用缓存") << "；遍历 " << stats.scan_ms
+         << " ms，解码 " << stats.decode_ms << " ms\n";
+
+    // 3. 保存缓存（失败不影响本次训练，下次训练全部重新解码）
+    if (stats.decoded + stats.rehashed + stats.removed + stats.failed > 0 || !cached) {
+        if (!dataset.save(cache_path)) cerr << "预处理缓存保存失败: " << cache_path << "\n";
     }
 
     // 检查训练集是否为空
-    if (images.empty()) return false;
+    if (dataset.size() == 0) return false;
+
+    // 4. 训练：样本为指向缓存像素的视图（不复制），直方图由线程池计算
+    vector<Mat> images(dataset.size());
+    for (int i = 0; i < dataset.size(); i++) images[i] = dataset.sample(i);
+    auto train_start = chrono::steady_clock::now();
+    // 创建LBPH识别引擎（默认参数：半径1，邻域8，网格8x8，阈值默认）
+    LbphEngine model;
+    if (!model.train(images, dataset.labels(), workers)) return false;
+    cout << "直方图计算 " << msSince(train_start) << " ms\n";
+
+    // 5. 按用户ID写出分片，删除已无样本的用户的分片（之后可单人增删）
+    auto shard_start = chrono::steady_clock::now();
+    ShardStore store(shard_dir);
+    map<int, vector<int>> rows;// 用户ID → 样本下标
+    for (int i = 0; i < model.samples(); i++) rows[model.label(i)].push_back(i);
+    for (const auto& kv : rows) {
+        if (!store.write(kv.first, model, kv.second)) {
+            cerr << "分片写入失败: " << store.path(kv.first) << "\n";
+            return false;
+        }
+    }
+    for (int id : store.labels()) {
+        if (!rows.count(id)) store.remove(id);
+    }
+    cout << "写出 " << rows.size() << " 个分片 → " << shard_dir << "：" << msSince(shard_start) << " ms\n";
+
+    // 将训练好的模型保存到指定路径（按扩展名选择二进制格式或OpenCV兼容的YAML格式）
+    // 保存路径示例："lbph_model.bin"，后续门禁系统通过LbphEngine::load()只读映射加载（运行中的门禁程序会自动热更新）
+    return model.save(model_path);
+}
+
+/**
+ * @brief 录入（或重新录入）一个用户：只解码该用户的样本、计算该用户的直方图并写出其分片，再合并生成模型
+ * @details 录入耗时只与该用户的样本数有关；合并只拼接已有分片，不重新计算其他人的直方图。
+ *          不读写样本根目录下的预处理缓存（下次全量重建时按修改时间发现变化）
+ * @param user_id 用户ID（样本在 data_dir/<用户ID>/ 下）
+ * @param data_dir 人脸样本根目录
+ * @param model_path 模型保存路径
+ * @param workers 线程数（≤0表示使用全部CPU核）
+ * @param shard_dir 分片目录
+ * @return bool 成功返回true，该用户没有可用样本/写入失败返回false
+ */
+bool enrollIdentity(int user_id, const std::string& data_dir, const std::string& model_path, int workers,
+                    const std::string& shard_dir) {
+    workers = resolveWorkers(workers);
+    auto start = chrono::steady_clock::now();
+
+    // 1. 只同步该用户的目录（空样本集，全部解码）
+    FaceDataset dataset;
+    DatasetStats stats;
+    if (!dataset.sync(data_dir, workers, stats, user_id)) return false;
+    if (dataset.size() == 0) {
+        cerr << "用户 " << user_id << " 没有可用样本: " << data_dir << "/" << user_id << "\n";
+        return false;
+    }
 
-    // 创建LBPH人脸识别器实例
-    Ptr<LBPHFaceRecognizer> model = LBPHFaceRecognizer::create();
+    // 2. 计算该用户的直方图并写出分片
+    vector<Mat> images(dataset.size());
+    for (int i = 0; i < dataset.size(); i++) images[i] = dataset.sample(i);
+    auto hist_start = chrono::steady_clock::now();
+    LbphEngine person;
+    if (!person.train(images, dataset.labels(), workers)) return false;
+    double hist_ms = msSince(hist_start);
+    ShardStore store(shard_dir);
+    if (!ensureShards(store, model_path)) return false;
+    vector<int> rows(person.samples());
+    for (int i = 0; i < person.samples(); i++) rows[i] = i;
+    if (!store.write(user_id, person, rows)) {
+        cerr << "分片写入失败: " << store.path(user_id) << "\n";
+        return false;
+    }
+    cout << "录入用户 " << user_id << "：样本 " << dataset.size() << " 张（失败 " << stats.failed << "），解码 "
+         << stats.decode_ms << " ms，直方图 " << hist_ms << " ms，共 " << msSince(start) << " ms\n";
 
-    // 核心训练函数：输入样本集和标签集，训练LBPH模型
-    // images：所有用户的灰度人脸样本集合（Mat类型数组）
-    model->train(images, labels);
+    // 3. 合并全部分片生成运行时模型
+    return mergeShards(store, model_path);
+}
 
-    // 将训练好的模型保存到指定路径
-    // 保存路径示例："lbph_model.yml"，后续门禁系统通过g_lbph->read()加载ss
-    model->save(model_path);
+/**
+ * @brief 删除一个用户：先合并其余分片生成模型，保存成功后再删除其分片（不删除样本目录）
+ * @details 删除的是最后一个用户时保存空画廊模型，运行中的门禁程序热更新后所有人脸判定为未知；
+ *          模型保存失败时分片保留，模型不变
+ * @param user_id 用户ID
+ * @param model_path 模型保存路径
+ * @param shard_dir 分片目录
+ * @return bool 成功返回true，分片不存在/合并或保存失败返回false
+ */
+bool removeIdentity(int user_id, const std::string& model_path, const std::string& shard_dir) {
+    ShardStore store(shard_dir);
+    if (!ensureShards(store, model_path)) return false;
+    if (!fs::exists(store.path(user_id))) {
+        cerr << "用户 " << user_id << " 没有分片: " << store.path(user_id) << "\n";
+        return false;
+    }
+    if (!mergeShards(store, model_path, user_id)) return false;
+    if (!store.remove(user_id)) {
+        cerr << "分片删除失败（模型已更新，全量重建前请手动删除）: " << store.path(user_id) << "\n";
+        return false;
+    }
+    cout << "已删除用户 " << user_id << " 的分片（样本目录保留，全量重建时仍会录入，不再需要时请一并删除）\n";
     return true;
-}
\ No newline at end of file
+}
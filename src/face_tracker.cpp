@@ -0,0 +1,115 @@
+/**
+ * @file face_tracker.cpp
+ * @brief 先跟踪后检测实现
+ */
+#include "face_tracker.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+void FaceTracker::plan(Size frame_size, TrackPlan& p) {
+    lock_guard<mutex> lock(mtx_);
+    p.rois.clear();
+    p.last_boxes.clear();
+    // 没有跟踪目标、跟踪丢失、或到达全图检测间隔：全图检测
+    p.full_scan = force_full_ || tracks_.empty() || full_scan_interval_ <= 1 ||
+                  frames_since_full_ + 1 >= full_scan_interval_;
+    if (p.full_scan) return;
+
+    Rect frame_rect(0, 0, frame_size.width, frame_size.height);
+    for (const Rect& box : tracks_) {
+        // 人脸框四边各外扩roi_expand倍宽/高，并裁剪到图像范围内
+        int dx = static_cast<int>(box.width * roi_expand_);
+        int dy = static_cast<int>(box.height * roi_expand_);
+        Rect roi = Rect(box.x - dx, box.y - dy, box.width + 2 * dx, box.height + 2 * dy) & frame_rect;
+        if (roi.empty()) continue;
+        p.rois.push_back(roi);
+        p.last_boxes.push_back(box);
+    }
+    if (p.rois.empty()) p.full_scan = true;// 人脸框全部移出画面
+}
+
+void FaceTracker::run(FaceDetector& detector, const Mat& gray, const TrackPlan& plan,
+                      vector<Rect>& faces, Size min_size) {
+    faces.clear();
+    if (plan.full_scan) {
+        detector.detect(gray, faces, min_size);
+        return;
+    }
+
+    thread_local vector<Rect> found;// 局部搜索的候选框（每个检测线程复用）
+    for (size_t i = 0; i < plan.rois.size(); i++) {
+        const Rect& roi = plan.rois[i];
+        const Rect& last = plan.last_boxes[i];
+        // 只搜索与上一帧人脸大小相近的尺度（0.7~1.4倍），金字塔层数大幅减少
+        int min_side = max(min_size.width, static_cast<int>(min(last.width, last.height) * 0.7));
+        int max_side = static_cast<int>(max(last.width, last.height) * 1.4);
+        detector.detect(gray(roi), found, Size(min_side, min_side), Size(max_side, max_side));
+        if (found.empty()) continue;// 该人脸在局部区域内丢失
+        // 同一区域内取面积最大的候选框，换算回整图坐标
+        Rect best = *max_element(found.begin(), found.end(),
+                                 [](const Rect& a, const Rect& b) { return a.area() < b.area(); });
+        faces.push_back(Rect(best.x + roi.x, best.y + roi.y, best.width, best.height));
+    }
+}
+
+void FaceTracker::commit(const TrackPlan& plan, const vector<Rect>& faces) {
+    lock_guard<mutex> lock(mtx_);
+    if (plan.full_scan) {
+        full_scans_++;
+        frames_since_full_ = 0;
+        force_full_ = false;
+    } else {
+        roi_scans_++;
+        frames_since_full_++;
+        // 任一人脸在局部搜索中丢失：下一帧回到全图检测（也能发现新进入画面的人）
+        if (faces.size() < plan.rois.size()) {
+            lost_++;
+            force_full_ = true;
+        }
+    }
+    tracks_ = faces;
+}
+
+void FaceTracker::detect(FaceDetector& detector, const Mat& gray, vector<Rect>& faces, Size min_size) {
+    plan(gray.size(), detect_plan_);
+    run(detector, gray, detect_plan_, faces, min_size);
+    commit(detect_plan_, faces);
+}
+
+void TrackIdAssigner::assign(const Rect* boxes, int count, int* ids) {
+    // 1. 全部（轨迹, 人脸框）对中IoU达标的，按IoU从大到小贪心匹配
+    pairs_.clear();
+    for (int t = 0; t < static_cast<int>(tracks_.size()); t++) {
+        for (int b = 0; b < count; b++) {
+            double inter = (tracks_[t].box & boxes[b]).area();
+            double uni = tracks_[t].box.area() + boxes[b].area() - inter;
+            double iou = uni > 0 ? inter / uni : 0.0;
+            if (iou >= min_iou_) pairs_.push_back({iou, t, b});
+        }
+    }
+    sort(pairs_.begin(), pairs_.end(), [](const Pair& a, const Pair& b) { return a.iou > b.iou; });
+    track_used_.assign(tracks_.size(), 0);
+    for (int b = 0; b < count; b++) ids[b] = 0;
+    for (const Pair& p : pairs_) {
+        if (track_used_[p.track] || ids[p.box] != 0) continue;
+        track_used_[p.track] = 1;
+        ids[p.box] = tracks_[p.track].id;
+        tracks_[p.track].box = boxes[p.box];
+        tracks_[p.track].misses = 0;
+    }
+    // 2. 未匹配的轨迹累计丢失帧数，超过上限的结束
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        if (!track_used_[t]) tracks_[t].misses++;
+    }
+    tracks_.erase(remove_if(tracks_.begin(), tracks_.end(),
+                            [this](const Track& t) { return t.misses > max_misses_; }),
+                  tracks_.end());
+    // 3. 未匹配的人脸框开始新轨迹
+    for (int b = 0; b < count; b++) {
+        if (ids[b] != 0) continue;
+        ids[b] = next_id_++;
+        tracks_.push_back({ids[b], boxes[b], 0});
+    }
+}
@@ -1,33 +1,67 @@
 /**
  * @file face_train_main.cpp
  * @brief LBPH人脸识别模型训练工具主程序
- * @details 该程序作为模型训练功能的入口，指定人脸样本根目录和模型保存路径，
- *          调用trainLBPHModel函数自动遍历样本、训练模型并保存，适配门禁系统的模型更新流程
+ * @details 该程序作为模型训练功能的入口，指定人脸样本根目录和模型保存路径，按子命令训练模型并保存，
+ *          适配门禁系统的模型更新流程（模型按身份分片存放，合并后生成门禁主程序加载的模型）：
+ *          face_train add <用户ID> [样本目录] [线程数]   录入/重新录入一人（只计算该人的分片）
+ *          face_train remove <用户ID>                    删除一人（删除其分片）
+ *          face_train rebuild [样本目录] [线程数]         全量重建全部分片（不带子命令时同rebuild）
+ *          线程数省略或为0时使用全部CPU核
  */
 #include "face_tool.h"
+#include "config.h"
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 /**
  * @brief 主函数：LBPH模型训练工具入口
- * @return int 程序退出码（0表示正常退出，-1表示训练失败）
+ * @param argc 参数个数
+ * @param argv 参数：[add <用户ID> | remove <用户ID> | rebuild] [样本目录] [线程数]
+ * @return int 程序退出码（0表示正常退出，-1表示参数错误或训练失败）
  */
-int main() {
-    // 1. 配置模型训练参数：指定人脸样本根目录,每个子文件夹存放对应用户的人脸灰度样本
-    std::string data_dir = "/home/hexiang/face_door_system/face_data";
-    
-    // 2. 配置模型保存路径：训练完成后的LBPH模型将保存为该YAML文件
-    std::string model_path = "lbph_model.yml";
-    
-    // 3. 调用模型训练核心函数，执行训练流程
-    if (trainLBPHModel(data_dir, model_path)) {
-        // 训练成功：打印提示信息，告知用户模型生成路径
-        std::cout << "模型训练完成！已生成 " << model_path << "\n";
+int main(int argc, char** argv) {
+    // 1. 解析子命令（旧用法 face_train [样本目录] [线程数] 等同于rebuild）
+    std::string cmd = (argc > 1) ? argv[1] : "rebuild";
+    int arg = 2;// 子命令之后的第一个参数
+    if (cmd != "add" && cmd != "remove" && cmd != "rebuild") {
+        cmd = "rebuild";
+        arg = 1;
+    }
+    int user_id = -1;
+    if (cmd != "rebuild") {
+        std::string id_arg = (argc > arg) ? argv[arg] : "";
+        if (id_arg.empty() || id_arg.find_first_not_of("0123456789") != std::string::npos) {
+            std::cerr << "用法：face_train add <用户ID> [样本目录] [线程数]\n"
+                         "      face_train remove <用户ID>\n"
+                         "      face_train rebuild [样本目录] [线程数]\n";
+            return -1;
+        }
+        user_id = atoi(id_arg.c_str());
+        arg++;
+    }
+
+    // 2. 配置模型训练参数：指定人脸样本根目录,每个子文件夹存放对应用户的人脸灰度样本
+    std::string data_dir = (argc > arg) ? argv[arg] : "/home/hexiang/face_door_system/face_data";
+    int workers = (argc > arg + 1) ? atoi(argv[arg + 1]) : TRAIN_WORKERS;
+
+    // 3. 配置模型保存路径：训练完成后的LBPH模型将保存为二进制模型文件（门禁主程序直接映射加载）
+    std::string model_path = MODEL_PATH;
+
+    // 4. 执行子命令
+    bool ok;
+    if (cmd == "add") ok = enrollIdentity(user_id, data_dir, model_path, workers);
+    else if (cmd == "remove") ok = removeIdentity(user_id, model_path);
+    else ok = trainLBPHModel(data_dir, model_path, workers);
+    if (ok) {
+        // 训练成功：打印提示信息，告知用户模型生成路径（运行中的门禁程序会自动热更新）
+        std::cout << "模型更新完成！已生成 " << model_path << "\n";
     } else {
         // 退出程序，返回-1表示训练流程异常
         std::cerr << "模型训练失败！\n";
         return -1;
     }
 
-    // 4. 程序正常退出，返回0表示训练流程无异常
+    // 5. 程序正常退出，返回0表示训练流程无异常
     return 0;
-}
\ No newline at end of file
+}
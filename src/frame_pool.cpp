@@ -0,0 +1,140 @@
+/**
+ * @file frame_pool.cpp
+ * @brief 引用计数帧缓冲池实现
+ */
+#include "frame_pool.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+// ====================== FrameRef ======================
+
+FrameRef::FrameRef(const FrameRef& other) : slot_(other.slot_) {
+    if (slot_) slot_->refs.fetch_add(1, memory_order_relaxed);
+}
+
+FrameRef& FrameRef::operator=(const FrameRef& other) {
+    if (this != &other) {
+        if (other.slot_) other.slot_->refs.fetch_add(1, memory_order_relaxed);
+        reset();
+        slot_ = other.slot_;
+    }
+    return *this;
+}
+
+FrameRef& FrameRef::operator=(FrameRef&& other) noexcept {
+    if (this != &other) {
+        reset();
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+void FrameRef::reset() {
+    if (!slot_) return;
+    // 最后一个引用释放时回收槽位（acq_rel保证其他线程对图像的读写先于回收完成）
+    if (slot_->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+        slot_->owner->release(slot_);
+    }
+    slot_ = nullptr;
+}
+
+// ====================== FramePool ======================
+
+FramePool::FramePool(const string& name, size_t slots, int rows, int cols, int type,
+                     size_t jpeg_reserve)
+    : name_(name) {
+    slots_.reserve(slots);
+    free_.reserve(slots);// 预留容量，运行期间push_back不会再分配
+    for (size_t i = 0; i < slots; i++) {
+        auto slot = make_unique<FrameSlot>();
+        slot->storage.create(rows, cols, type);// 一次性分配缓冲
+        slot->image = slot->storage;
+        slot->jpeg.reserve(jpeg_reserve);
+        slot->owner = this;
+        slot->index = static_cast<int>(i);
+        free_.push_back(static_cast<int>(i));
+        slots_.push_back(move(slot));
+    }
+}
+
+FrameRef FramePool::acquire() {
+    FrameSlot* slot = nullptr;
+    {
+        lock_guard<mutex> lock(mtx_);
+        if (!free_.empty()) {
+            slot = slots_[free_.back()].get();
+            free_.pop_back();
+        }
+    }
+    if (!slot) {
+        exhausted_++;// 所有槽位都在流水线中，调用方应丢弃本帧
+        return FrameRef();
+    }
+    acquires_++;
+    slot->refs.store(1, memory_order_relaxed);
+    slot->image = slot->storage;// 恢复为整块缓冲（只拷贝Mat头）
+    slot->jpeg.clear();         // 清空但保留容量
+    slot->jpeg_capacity = slot->jpeg.capacity();
+    slot->scale = 1;
+    return FrameRef(slot);
+}
+
+void FramePool::commit(const FrameRef& ref) {
+    if (ref.empty()) return;
+    const FrameSlot* slot = ref.slot_;
+    // 图像数据不在槽位缓冲内，说明OpenCV因尺寸/类型不符重新分配了内存
+    if (slot->image.data < slot->storage.datastart || slot->image.data >= slot->storage.dataend) {
+        heap_allocs_++;
+    }
+    // MJPEG数据超出预留容量，vector发生了扩容（扩容后的容量会保留下来）
+    if (slot->jpeg.capacity() != slot->jpeg_capacity) heap_allocs_++;
+}
+
+FrameRef FramePool::copyFrom(const Mat& src, Size size) {
+    FrameRef ref = acquire();
+    if (ref.empty() || src.empty()) return ref;
+
+    FrameSlot* slot = ref.slot_;
+    int max_rows = slot->storage.rows, max_cols = slot->storage.cols;
+    if (size.area() > 0 && size.width <= max_cols && size.height <= max_rows) {
+        // 指定尺寸：直接缩放到槽位左上角ROI
+        slot->image = slot->storage(Rect(0, 0, size.width, size.height));
+        if (src.size() == size) src.copyTo(slot->image);
+        else resize(src, slot->image, size, 0, 0, src.cols > size.width ? INTER_AREA : INTER_LINEAR);
+    } else if (src.rows <= max_rows && src.cols <= max_cols) {
+        // 放得下：拷贝到槽位左上角ROI（尺寸类型一致，copyTo不会分配内存）
+        slot->image = slot->storage(Rect(0, 0, src.cols, src.rows));
+        src.copyTo(slot->image);
+    } else {
+        // 放不下：等比缩小到槽位容量内
+        double scale = min(static_cast<double>(max_cols) / src.cols,
+                           static_cast<double>(max_rows) / src.rows);
+        int w = max(1, static_cast<int>(src.cols * scale));
+        int h = max(1, static_cast<int>(src.rows * scale));
+        slot->image = slot->storage(Rect(0, 0, w, h));
+        resize(src, slot->image, Size(w, h), 0, 0, INTER_AREA);
+    }
+    commit(ref);
+    return ref;
+}
+
+void FramePool::release(FrameSlot* slot) {
+    lock_guard<mutex> lock(mtx_);
+    free_.push_back(slot->index);
+}
+
+size_t FramePool::freeCount() {
+    lock_guard<mutex> lock(mtx_);
+    return free_.size();
+}
+
+string FramePool::summary() {
+    return "[帧池] " + name_ + ": 槽位=" + to_string(slots_.size()) +
+           " 空闲=" + to_string(freeCount()) +
+           " 取槽=" + to_string(acquires_.load()) +
+           " 耗尽=" + to_string(exhausted_.load()) +
+           " 堆分配=" + to_string(heap_allocs_.load());
+}
@@ -0,0 +1,234 @@
+/**
+ * @file frame_source.cpp
+ * @brief 帧源实现：V4L2摄像头、录像文件、图片目录、合成画面
+ */
+#include "frame_source.h"
+#include "config.h"
+#include <algorithm>
+#include <cstdlib>   // atoi/atoll
+#include <filesystem>// C++17文件系统（遍历图片目录）
+#include <fstream>   // 读取JPEG文件原始数据
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace cv;
+using namespace std;
+
+// ====================== V4L2摄像头 ======================
+
+bool V4L2FrameSource::open() {
+    // 打开摄像头（强制V4L2后端）
+    if (!cap_.open(device_, CAP_V4L2)) return false;
+    // 强制使用 MJPG 格式
+    cap_.set(CAP_PROP_FOURCC, VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    // 设置采集分辨率（平衡清晰度和性能）
+    cap_.set(CAP_PROP_FRAME_WIDTH, CAMERA_WIDTH);
+    cap_.set(CAP_PROP_FRAME_HEIGHT, CAMERA_HEIGHT);
+    // 设置帧率
+    cap_.set(CAP_PROP_FPS, CAMERA_FPS);
+    if (raw_mjpeg_) {
+        // 关闭OpenCV内部解码，直接取MJPEG原始数据；驱动未协商成MJPG或不支持时退回BGR模式
+        bool is_mjpg = static_cast<int>(cap_.get(CAP_PROP_FOURCC)) == VideoWriter::fourcc('M', 'J', 'P', 'G');
+        if (!is_mjpg || !cap_.set(CAP_PROP_CONVERT_RGB, 0)) {
+            cap_.set(CAP_PROP_CONVERT_RGB, 1);
+            raw_mjpeg_ = false;
+        }
+    }
+    return true;
+}
+
+bool V4L2FrameSource::read(Mat& frame) {
+    if (raw_mjpeg_) {
+        // 原始模式下按需解码为BGR（供人脸采集工具等需要彩色帧的调用方）
+        if (!readJpeg(jpeg_)) return false;
+        imdecode(Mat(1, static_cast<int>(jpeg_.size()), CV_8UC1, jpeg_.data()), IMREAD_COLOR, &frame);
+        return !frame.empty();
+    }
+    return cap_.read(frame) && !frame.empty();
+}
+
+bool V4L2FrameSource::readJpeg(vector<unsigned char>& jpeg) {
+    if (!raw_mjpeg_ || !cap_.read(raw_) || raw_.empty()) return false;
+    // 拷贝到调用方缓冲（vector::assign不缩减容量，稳态下不重新分配）
+    jpeg.assign(raw_.data, raw_.data + raw_.total() * raw_.elemSize());
+    return true;
+}
+
+// ====================== 回放节拍 ======================
+
+void ReplayFrameSource::pace() {
+    if (index_ == 0) start_ = chrono::steady_clock::now();// 以第一帧为时间原点
+    if (mode_ == ReplayMode::REALTIME && fps_ > 0) {
+        // 第index帧的理论输出时刻 = 原点 + index * 帧间隔（按绝对时刻等待，误差不累积）
+        auto due = start_ + chrono::duration_cast<chrono::steady_clock::duration>(
+                       chrono::duration<double>(index_ / fps_));
+        this_thread::sleep_until(due);
+    }
+    ++index_;
+}
+
+// ====================== 录像文件 ======================
+
+VideoFileFrameSource::VideoFileFrameSource(const string& path, ReplayMode mode)
+    : ReplayFrameSource(REPLAY_DEFAULT_FPS, mode), path_(path) {}
+
+bool VideoFileFrameSource::open() {
+    if (!cap_.open(path_)) return false;
+    double fps = cap_.get(CAP_PROP_FPS);
+    if (fps > 0) fps_ = fps;// 文件未记录帧率时保留默认值
+    return true;
+}
+
+bool VideoFileFrameSource::read(Mat& frame) {
+    if (finished_) return false;
+    if (!cap_.read(frame) || frame.empty()) {
+        finished_ = true;// 读到文件末尾
+        return false;
+    }
+    pace();
+    return true;
+}
+
+bool VideoFileFrameSource::skip() {
+    if (finished_) return false;
+    if (!cap_.grab()) {
+        finished_ = true;
+        return false;
+    }
+    pace();// 跳过的帧同样占用回放时间
+    return true;
+}
+
+// ====================== 图片目录 ======================
+
+ImageDirFrameSource::ImageDirFrameSource(const string& dir, ReplayMode mode)
+    : ReplayFrameSource(REPLAY_DEFAULT_FPS, mode), dir_(dir) {}
+
+bool ImageDirFrameSource::open() {
+    error_code ec;
+    if (!fs::is_directory(dir_, ec)) return false;
+    files_.clear();
+    for (auto& entry : fs::directory_iterator(dir_)) {
+        if (!entry.is_regular_file()) continue;
+        string ext = entry.path().extension().string();
+        transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp") {
+            files_.push_back(entry.path().string());
+        }
+    }
+    // directory_iterator不保证顺序，按文件名排序保证回放可复现
+    sort(files_.begin(), files_.end());
+    next_ = 0;
+    all_jpeg_ = all_of(files_.begin(), files_.end(), [](const string& f) {
+        string ext = fs::path(f).extension().string();
+        transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == ".jpg" || ext == ".jpeg";
+    });
+    return !files_.empty();
+}
+
+bool ImageDirFrameSource::readJpeg(vector<unsigned char>& jpeg) {
+    while (next_ < files_.size()) {
+        ifstream in(files_[next_++], ios::binary | ios::ate);
+        if (!in) continue;
+        streamsize size = in.tellg();
+        if (size <= 0) continue;
+        in.seekg(0);
+        jpeg.resize(static_cast<size_t>(size));// 容量足够时不重新分配
+        if (!in.read(reinterpret_cast<char*>(jpeg.data()), size)) continue;
+        pace();
+        return true;
+    }
+    finished_ = true;
+    return false;
+}
+
+bool ImageDirFrameSource::read(Mat& frame) {
+    // 跳过无法解码的图片，直到读到有效帧或目录播放完毕
+    while (next_ < files_.size()) {
+        Mat img = imread(files_[next_++], IMREAD_COLOR);
+        if (img.empty()) continue;
+        img.copyTo(frame);// 拷贝进调用方缓冲（帧池槽位），尺寸一致时不重新分配
+        pace();
+        return true;
+    }
+    finished_ = true;
+    return false;
+}
+
+bool ImageDirFrameSource::skip() {
+    if (next_ >= files_.size()) {
+        finished_ = true;
+        return false;
+    }
+    next_++;
+    pace();
+    return true;
+}
+
+// ====================== 合成画面 ======================
+
+SyntheticFrameSource::SyntheticFrameSource(long long total_frames, ReplayMode mode)
+    : ReplayFrameSource(REPLAY_DEFAULT_FPS, mode), total_frames_(total_frames) {
+    // 水平灰度渐变背景，只生成一次
+    background_.create(CAMERA_HEIGHT, CAMERA_WIDTH, CV_8UC3);
+    for (int y = 0; y < CAMERA_HEIGHT; y++) {
+        uchar* row = background_.ptr<uchar>(y);
+        for (int x = 0; x < CAMERA_WIDTH; x++) {
+            uchar v = static_cast<uchar>(60 + 120 * x / CAMERA_WIDTH);
+            row[3 * x] = row[3 * x + 1] = row[3 * x + 2] = v;
+        }
+    }
+}
+
+bool SyntheticFrameSource::read(Mat& frame) {
+    if (total_frames_ > 0 && index_ >= total_frames_) {
+        finished_ = true;
+        return false;
+    }
+    background_.copyTo(frame);
+    // “人脸”沿水平方向往返移动，周期100帧
+    long long phase = index_ % 100;
+    int offset = static_cast<int>(phase < 50 ? phase : 100 - phase) * 4;
+    Point center(CAMERA_WIDTH / 2 - 100 + offset, CAMERA_HEIGHT / 2);
+    Size axes(60, 80);
+    ellipse(frame, center, axes, 0, 0, 360, Scalar(170, 190, 220), -1);          // 脸
+    circle(frame, Point(center.x - 22, center.y - 20), 8, Scalar(40, 40, 40), -1);// 左眼
+    circle(frame, Point(center.x + 22, center.y - 20), 8, Scalar(40, 40, 40), -1);// 右眼
+    ellipse(frame, Point(center.x, center.y + 35), Size(25, 8), 0, 0, 180, Scalar(60, 60, 120), 3);// 嘴
+    pace();
+    return true;
+}
+
+bool SyntheticFrameSource::skip() {
+    if (total_frames_ > 0 && index_ >= total_frames_) {
+        finished_ = true;
+        return false;
+    }
+    pace();
+    return true;
+}
+
+// ====================== 工厂函数 ======================
+
+unique_ptr<FrameSource> createFrameSource(const string& spec, ReplayMode mode) {
+    // 拆分 "类型:参数"
+    size_t colon = spec.find(':');
+    string type = spec.substr(0, colon);
+    string arg = (colon == string::npos) ? "" : spec.substr(colon + 1);
+
+    if (type == "v4l2") {
+        return make_unique<V4L2FrameSource>(atoi(arg.c_str()), MJPEG_GRAY_DECODE);
+    }
+    if (type == "file") return make_unique<VideoFileFrameSource>(arg, mode);
+    if (type == "dir") return make_unique<ImageDirFrameSource>(arg, mode);
+    if (type == "synthetic") {
+        return make_unique<SyntheticFrameSource>(atoll(arg.c_str()), mode);
+    }
+
+    // 无前缀：按路径类型自动识别
+    error_code ec;
+    if (fs::is_directory(spec, ec)) return make_unique<ImageDirFrameSource>(spec, mode);
+    if (fs::is_regular_file(spec, ec)) return make_unique<VideoFileFrameSource>(spec, mode);
+    return nullptr;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file gpio_sim.cpp
+ * @brief 模拟GPIO芯片实现（记录电平翻转及时刻）
+ */
+#include "gpio_control.h"
+
+bool SimGpioBackend::init(const std::vector<int>& pins, const std::vector<int>& initial) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    levels_.clear();
+    for (size_t i = 0; i < pins.size(); i++) levels_.emplace_back(pins[i], i < initial.size() ? initial[i] : 0);
+    return true;
+}
+
+bool SimGpioBackend::setValue(int pin_bcm, int value) {
+    auto now = std::chrono::steady_clock::now();
+    value = value != 0;
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& level : levels_) {
+        if (level.first != pin_bcm) continue;
+        if (level.second != value) edges_.push_back({pin_bcm, value, now});
+        level.second = value;
+        return true;
+    }
+    return false;// 未申请的引脚
+}
+
+void SimGpioBackend::cleanup() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    levels_.clear();
+}
+
+std::vector<GpioEdge> SimGpioBackend::takeEdges() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<GpioEdge> edges;
+    edges.swap(edges_);
+    return edges;
+}
+
+int SimGpioBackend::value(int pin_bcm) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& level : levels_) {
+        if (level.first == pin_bcm) return level.second;
+    }
+    return -1;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file identity_cache.cpp
+ * @brief 轨迹身份缓存实现（投票窗口、确认/复核/撤销、节省统计）
+ */
+#include "identity_cache.h"
+#include <algorithm>
+
+using namespace std;
+
+bool IdentityCache::needsPredict(int track_id, Clock::time_point now, int& label) {
+    Entry& e = entries_[track_id];// 新轨迹在此创建
+    e.last_seen = now;
+    if (e.confirmed && now - e.last_verified < chrono::milliseconds(TRACK_REVERIFY_MS)) {
+        label = e.label;
+        skipped_++;
+        return false;
+    }
+    predicts_++;
+    return true;
+}
+
+int IdentityCache::count(const Entry& e, int label) {
+    return static_cast<int>(std::count(e.window.begin(), e.window.begin() + e.filled, label));
+}
+
+TrackVerdict IdentityCache::addResult(int track_id, int label, bool accepted, Clock::time_point now) {
+    Entry& e = entries_[track_id];
+    e.last_seen = now;
+    int vote = accepted ? label : -1;
+    // 1. 已确认轨迹的复核：一致则刷新复核时间，不一致则撤销确认，从这一票开始重新投票
+    bool revoked = false;
+    if (e.confirmed) {
+        reverifies_++;
+        if (vote == e.label) {
+            e.last_verified = now;
+            return TrackVerdict::NONE;
+        }
+        e.confirmed = false;
+        e.filled = e.next = 0;
+        revokes_++;
+        revoked = true;
+    }
+    // 2. 投入窗口（满时覆盖最旧的一票）
+    e.window[e.next] = vote;
+    e.next = (e.next + 1) % VOTE_WINDOW;
+    e.filled = min(e.filled + 1, VOTE_WINDOW);
+    // 3. 判定
+    if (vote != -1 && count(e, vote) >= VOTE_CONFIRM) {
+        e.confirmed = true;
+        e.label = vote;
+        e.last_verified = now;
+        confirms_++;
+        return TrackVerdict::CONFIRMED;
+    }
+    if (revoked) return TrackVerdict::REVOKED;
+    if (!e.alarmed && count(e, -1) >= VOTE_REJECT) {
+        e.alarmed = true;
+        alarms_++;
+        return TrackVerdict::REJECTED;
+    }
+    return TrackVerdict::NONE;
+}
+
+FaceState IdentityCache::state(int track_id) const {
+    auto it = entries_.find(track_id);
+    if (it == entries_.end()) return FaceState::PENDING;
+    if (it->second.confirmed) return FaceState::ACCEPTED;
+    return it->second.alarmed ? FaceState::REJECTED : FaceState::PENDING;
+}
+
+int IdentityCache::label(int track_id) const {
+    auto it = entries_.find(track_id);
+    return it != entries_.end() && it->second.confirmed ? it->second.label : -1;
+}
+
+int IdentityCache::votes(int track_id) const {
+    auto it = entries_.find(track_id);
+    if (it == entries_.end() || it->second.filled == 0) return 0;
+    const Entry& e = it->second;
+    return count(e, e.window[(e.next + VOTE_WINDOW - 1) % VOTE_WINDOW]);
+}
+
+void IdentityCache::expire(Clock::time_point now) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (now - it->second.last_seen > chrono::milliseconds(TRACK_CACHE_TTL_MS)) it = entries_.erase(it);
+        else ++it;
+    }
+}
+
+string IdentityCache::summary(double seconds) const {
+    unsigned long long total = predicts_ + skipped_;
+    return "[识别缓存] 识别 " + to_string(predicts_) + " 次, 缓存跳过 " + to_string(skipped_) + " 次(" +
+           to_string(total > 0 ? 100.0 * skipped_ / total : 0.0) + "%, 每秒节省 " +
+           to_string(seconds > 0 ? skipped_ / seconds : 0.0) + " 次识别), 确认 " + to_string(confirms_) +
+           " 条轨迹, 报警 " + to_string(alarms_) + " 条, 复核 " + to_string(reverifies_) + " 次(撤销 " +
+           to_string(revokes_) + " 次)";
+}
@@ -0,0 +1,75 @@
+/**
+ * @file idle_control.cpp
+ * @brief 运动检测与空闲状态机实现
+ */
+#include "idle_control.h"
+#include "log_util.h"// 状态切换日志
+
+using namespace cv;
+using namespace std;
+
+// ====================== MotionGate ======================
+
+bool MotionGate::update(const Mat& luma) {
+    // INTER_AREA降采样同时起到平滑作用，抑制传感器噪声造成的误报
+    resize(luma, small_, Size(MOTION_GRID_WIDTH, MOTION_GRID_HEIGHT), 0, 0, INTER_AREA);
+    if (prev_.empty()) {
+        small_.copyTo(prev_);
+        return true;
+    }
+    absdiff(small_, prev_, diff_);
+    threshold(diff_, diff_, MOTION_PIXEL_DIFF, 255, THRESH_BINARY);
+    int changed = countNonZero(diff_);
+    // 交换缓冲：本帧成为下一次比较的参考帧（只交换Mat头，不拷贝数据）
+    swap(small_, prev_);
+    return changed > MOTION_AREA_RATIO * MOTION_GRID_WIDTH * MOTION_GRID_HEIGHT;
+}
+
+// ====================== IdleController ======================
+
+IdleController::IdleController(int timeout_ms) : timeout_(timeout_ms) {
+    last_face_ = state_since_ = chrono::steady_clock::now();
+}
+
+bool IdleController::onFrame(bool motion) {
+    if (!isIdle()) return true;// 活跃状态每帧检测
+    if (motion) {
+        // 空闲状态出现运动：立即恢复活跃，并重新计时（给来人一个完整的超时窗口）
+        switchTo(false);
+        last_face_ = chrono::steady_clock::now();
+        return true;
+    }
+    skipped_++;// 画面静止，跳过检测
+    return false;
+}
+
+void IdleController::onDetectResult(bool has_face) {
+    auto now = chrono::steady_clock::now();
+    if (has_face) {
+        last_face_ = now;
+    } else if (!isIdle() && now - last_face_ > timeout_) {
+        switchTo(true);
+    }
+}
+
+void IdleController::switchTo(bool idle) {
+    auto now = chrono::steady_clock::now();
+    double sec = chrono::duration<double>(now - state_since_).count();
+    (isIdle() ? idle_sec_ : active_sec_) += sec;
+    state_since_ = now;
+    idle_.store(idle, memory_order_relaxed);
+    transitions_++;
+    postLog(idle ? "[空闲] 持续无人脸，进入空闲状态(每" + to_string(IDLE_FRAME_SKIP) + "帧处理1帧)"
+                 : string("[空闲] 检测到运动，恢复全速"));
+}
+
+string IdleController::summary() {
+    // 把当前状态持续到现在的时长计入
+    double current = chrono::duration<double>(chrono::steady_clock::now() - state_since_).count();
+    double active = active_sec_ + (isIdle() ? 0.0 : current);
+    double idle = idle_sec_ + (isIdle() ? current : 0.0);
+    double total = active + idle;
+    return "[空闲] 活跃 " + to_string(active) + " s, 空闲 " + to_string(idle) + " s (" +
+           to_string(total > 0 ? 100.0 * idle / total : 0.0) + "%), 切换 " + to_string(transitions_) +
+           " 次, 静止跳过检测 " + to_string(skipped_) + " 帧";
+}
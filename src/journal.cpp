@@ -0,0 +1,388 @@
+/**
+ * @file journal.cpp
+ * @brief 出入记录实现（异步追加写入、段轮转与磁盘预算、索引只读映射与时间二分查询、用户ID索引）
+ */
+#include "journal.h"
+#include <dirent.h>      // opendir/readdir
+#include <fcntl.h>       // open
+#include <sys/mman.h>    // mmap/munmap
+#include <sys/stat.h>    // mkdir/fstat
+#include <unistd.h>      // write/pread/close/unlink/ftruncate
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+//索引文件头（16字节）
+struct JournalHeader {
+    char magic[8];        // "FJOURNAL"
+    uint32_t version;     // 格式版本
+    uint32_t entry_size;  // sizeof(JournalEntry)
+};
+constexpr char kJournalMagic[8] = {'F', 'J', 'O', 'U', 'R', 'N', 'A', 'L'};
+constexpr char kLabelMagic[8] = {'F', 'J', 'L', 'A', 'B', 'E', 'L', 'S'};
+constexpr uint32_t kJournalVersion = 1;
+constexpr int kSegmentNameRetries = 100;// 段名冲突时最多尝试的后缀数
+
+//写满len字节（被信号中断时重试）
+bool writeAll(int fd, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+//写入失败后把文件截回到size并把写位置移回末尾（丢弃写了一半的数据）
+void truncateTo(int fd, off_t size) {
+    lseek(fd, size, SEEK_SET);// 即使截断失败，后续写入也从size处覆盖残留部分
+    while (ftruncate(fd, size) != 0 && errno == EINTR) {}
+}
+
+long fileSize(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<long>(st.st_size) : 0;
+}
+
+//列出目录中的全部段（按首条时间戳升序），返回段名 seg_<时间戳>
+vector<pair<long long, string>> listSegments(const string& dir) {
+    vector<pair<long long, string>> segments;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return segments;
+    while (dirent* ent = readdir(d)) {
+        string name = ent->d_name;
+        if (name.size() <= 8 || name.compare(0, 4, "seg_") != 0 || name.compare(name.size() - 4, 4, ".idx") != 0) {
+            continue;
+        }
+        string seg = name.substr(0, name.size() - 4);
+        segments.emplace_back(atoll(seg.c_str() + 4), seg);
+    }
+    closedir(d);
+    // 同一时间戳的段（seg_<ts>、seg_<ts>_1、seg_<ts>_2…）按后缀数值排序：名字短的在前，等长再按字典序
+    sort(segments.begin(), segments.end(), [](const pair<long long, string>& a, const pair<long long, string>& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (a.second.size() != b.second.size()) return a.second.size() < b.second.size();
+        return a.second < b.second;
+    });
+    return segments;
+}
+
+}  // namespace
+
+// ====================== 写入 ======================
+
+JournalWriter::JournalWriter(const string& dir, size_t queue_size) : dir_(dir), queue_(queue_size) {}
+
+bool JournalWriter::start() {
+    if (started_) return true;
+    if (mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    started_ = true;
+    thread_ = thread(&JournalWriter::run, this);
+    return true;
+}
+
+void JournalWriter::stop() {
+    if (!started_.exchange(false)) return;
+    queue_.stop();// 写入线程取空队列后退出
+    if (thread_.joinable()) thread_.join();
+    closeSegment(true);
+}
+
+bool JournalWriter::append(JournalVerdict verdict, int label, double confidence, int track_id, const Mat& face) {
+    Pending p;
+    memset(&p.entry, 0, sizeof(p.entry));
+    p.entry.ts_ms = chrono::duration_cast<chrono::milliseconds>(
+                        chrono::system_clock::now().time_since_epoch()).count();
+    p.entry.label = label;
+    p.entry.track_id = track_id;
+    p.entry.confidence = static_cast<float>(confidence);
+    p.entry.verdict = static_cast<uint8_t>(verdict);
+    // 缩略图在识别线程中只做一次缩小（约2KB），JPEG编码留给写入线程
+    if (JOURNAL_THUMB_SIZE > 0 && !face.empty()) {
+        resize(face, p.thumb, Size(JOURNAL_THUMB_SIZE, JOURNAL_THUMB_SIZE), 0, 0, INTER_AREA);
+    }
+    if (!started_ || !queue_.push(move(p))) {
+        dropped_++;
+        return false;
+    }
+    return true;
+}
+
+void JournalWriter::closeSegment(bool sync) {
+    if (idx_fd_ < 0) return;
+    if (sync) {
+        fdatasync(dat_fd_);
+        fdatasync(idx_fd_);
+    }
+    close(dat_fd_);
+    close(idx_fd_);
+    idx_fd_ = dat_fd_ = -1;
+    if (label_refs_.empty()) return;
+    // 封段时写出用户ID索引：按(用户ID, 段内序号)排序，先写临时文件再改名；写失败时查询退回逐条扫描
+    stable_sort(label_refs_.begin(), label_refs_.end(),
+                [](const JournalLabelRef& a, const JournalLabelRef& b) { return a.label < b.label; });
+    string base = dir_ + "/" + segment_;
+    int fd = ::open((base + ".lbl.tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    JournalHeader header;
+    memcpy(header.magic, kLabelMagic, sizeof(header.magic));
+    header.version = kJournalVersion;
+    header.entry_size = sizeof(JournalLabelRef);
+    bool ok = fd >= 0 && writeAll(fd, &header, sizeof(header)) &&
+              writeAll(fd, label_refs_.data(), label_refs_.size() * sizeof(JournalLabelRef));
+    if (fd >= 0) {
+        if (ok && sync) fdatasync(fd);
+        close(fd);
+    }
+    if (!ok || rename((base + ".lbl.tmp").c_str(), (base + ".lbl").c_str()) != 0) {
+        unlink((base + ".lbl.tmp").c_str());
+    }
+    label_refs_.clear();
+}
+
+bool JournalWriter::openSegment(int64_t first_ts) {
+    closeSegment(false);
+    // 只新建不覆盖：同名段已存在（同一毫秒内轮转、时钟回拨）时改用 seg_<ts>_<n>
+    string base;
+    for (int suffix = 0; suffix < kSegmentNameRetries && idx_fd_ < 0; suffix++) {
+        base = dir_ + "/seg_" + to_string(first_ts) + (suffix > 0 ? "_" + to_string(suffix) : "");
+        idx_fd_ = ::open((base + ".idx").c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (idx_fd_ < 0) {
+            if (errno != EEXIST) break;
+            continue;
+        }
+        dat_fd_ = ::open((base + ".dat").c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (dat_fd_ < 0) {// 残留的.dat（删除段时中断）同样不覆盖，换下一个名字
+            int err = errno;
+            close(idx_fd_);
+            idx_fd_ = -1;
+            unlink((base + ".idx").c_str());
+            if (err != EEXIST) break;
+        }
+    }
+    JournalHeader header;
+    memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+    header.version = kJournalVersion;
+    header.entry_size = sizeof(JournalEntry);
+    if (idx_fd_ < 0 || dat_fd_ < 0 || !writeAll(idx_fd_, &header, sizeof(header))) {
+        if (idx_fd_ >= 0) {
+            close(idx_fd_);
+            close(dat_fd_);
+            unlink((base + ".idx").c_str());
+            unlink((base + ".dat").c_str());
+        }
+        idx_fd_ = dat_fd_ = -1;
+        return false;
+    }
+    segment_bytes_ = idx_bytes_ = sizeof(header);
+    dat_bytes_ = 0;
+    last_ts_ = INT64_MIN;
+    segment_ = base.substr(dir_.size() + 1);
+    segments_++;
+    return true;
+}
+
+void JournalWriter::enforceBudget() {
+    vector<pair<long long, string>> segments = listSegments(dir_);
+    long total = 0;
+    vector<long> sizes;
+    for (const auto& seg : segments) {
+        string base = dir_ + "/" + seg.second;
+        sizes.push_back(fileSize(base + ".idx") + fileSize(base + ".dat") + fileSize(base + ".lbl"));
+        total += sizes.back();
+    }
+    // 正在写入的一段永不删除（时钟回拨后它不一定排在最后）
+    for (size_t i = 0; i < segments.size() && total > JOURNAL_MAX_BYTES; i++) {
+        if (segments[i].second == segment_) continue;
+        string base = dir_ + "/" + segments[i].second;
+        unlink((base + ".idx").c_str());
+        unlink((base + ".dat").c_str());
+        unlink((base + ".lbl").c_str());
+        total -= sizes[i];
+        evicted_++;
+    }
+}
+
+/**
+ * @brief 写入线程主循环
+ * @details 1. 从队列取记录，编码缩略图
+ *          2. 当前段放不下或墙上时钟大幅回拨时新开一段（段名取本条记录的时间戳），随后检查磁盘预算；
+ *             段内时间戳钳到不小于上一条
+ *          3. 先追加缩略图，再追加索引记录；系统停止时写完队列中剩余的记录
+ */
+void JournalWriter::run() {
+    Pending p;
+    vector<int> params = {IMWRITE_JPEG_QUALITY, JOURNAL_THUMB_QUALITY};
+    while (queue_.pop(p)) {
+        jpeg_.clear();
+        if (!p.thumb.empty()) imencode(".jpg", p.thumb, jpeg_, params);
+        long needed = static_cast<long>(sizeof(JournalEntry) + jpeg_.size());
+        bool clock_stepped = idx_fd_ >= 0 && p.entry.ts_ms + JOURNAL_CLOCK_STEP_MS < last_ts_;
+        if (idx_fd_ < 0 || clock_stepped || segment_bytes_ + needed > JOURNAL_SEGMENT_BYTES) {
+            if (!openSegment(p.entry.ts_ms)) {
+                dropped_++;
+                continue;
+            }
+            enforceBudget();
+        }
+        p.entry.ts_ms = max(p.entry.ts_ms, last_ts_);// 段内时间单调不减（小幅回退或多线程入队乱序）
+        last_ts_ = p.entry.ts_ms;
+        p.entry.thumb_offset = dat_bytes_;
+        p.entry.thumb_size = static_cast<uint32_t>(jpeg_.size());
+        if (!jpeg_.empty() && !writeAll(dat_fd_, jpeg_.data(), jpeg_.size())) {
+            truncateTo(dat_fd_, dat_bytes_);// 缩略图写失败：截掉写了一半的部分，仍保留记录
+            p.entry.thumb_size = 0;
+        }
+        dat_bytes_ += p.entry.thumb_size;
+        segment_bytes_ += p.entry.thumb_size;
+        if (!writeAll(idx_fd_, &p.entry, sizeof(p.entry))) {
+            truncateTo(idx_fd_, idx_bytes_);// 截掉写了一半的记录，后续记录仍按32字节对齐
+            dropped_++;
+            continue;
+        }
+        uint32_t index = static_cast<uint32_t>((idx_bytes_ - sizeof(JournalHeader)) / sizeof(JournalEntry));
+        label_refs_.push_back({p.entry.label, index});
+        idx_bytes_ += static_cast<long>(sizeof(p.entry));
+        segment_bytes_ += static_cast<long>(sizeof(p.entry));
+        written_++;
+    }
+}
+
+string JournalWriter::summary() const {
+    return "[出入记录] 写入 " + to_string(written_.load()) + " 条, 丢弃 " + to_string(dropped_.load()) +
+           " 条, 新开段 " + to_string(segments_.load()) + " 个, 超出预算删除 " + to_string(evicted_.load()) + " 个";
+}
+
+// ====================== 查询 ======================
+
+bool JournalReader::open(const string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return false;
+    closedir(d);
+    dir_ = dir;
+    segments_.clear();
+    bytes_ = 0;
+    for (const auto& seg : listSegments(dir)) {
+        string base = dir + "/" + seg.second;
+        bytes_ += fileSize(base + ".idx") + fileSize(base + ".dat") + fileSize(base + ".lbl");
+        int fd = ::open((base + ".idx").c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(JournalHeader))) {
+            close(fd);
+            continue;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);// 映射建立后即可关闭描述符
+        if (addr == MAP_FAILED) continue;
+        Segment s;
+        s.name = seg.second;
+        s.map = shared_ptr<const void>(addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+        const JournalHeader* header = static_cast<const JournalHeader*>(addr);
+        if (memcmp(header->magic, kJournalMagic, sizeof(kJournalMagic)) != 0 || header->version != kJournalVersion ||
+            header->entry_size != sizeof(JournalEntry)) {
+            continue;
+        }
+        s.entries = reinterpret_cast<const JournalEntry*>(static_cast<const char*>(addr) + sizeof(JournalHeader));
+        s.count = (size - sizeof(JournalHeader)) / sizeof(JournalEntry);// 末尾写了一半的记录不计
+        if (s.count == 0) continue;
+        mapLabels(base + ".lbl", s);
+        segments_.push_back(move(s));
+    }
+    return true;
+}
+
+void JournalReader::mapLabels(const string& path, Segment& s) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;// 未封段（正在写入或写入中断）：没有用户ID索引
+    struct stat st;
+    size_t expected = sizeof(JournalHeader) + s.count * sizeof(JournalLabelRef);
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != expected) {
+        close(fd);
+        return;
+    }
+    void* addr = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return;
+    shared_ptr<const void> map(addr, [expected](const void* p) { munmap(const_cast<void*>(p), expected); });
+    const JournalHeader* header = static_cast<const JournalHeader*>(addr);
+    if (memcmp(header->magic, kLabelMagic, sizeof(kLabelMagic)) != 0 || header->version != kJournalVersion ||
+        header->entry_size != sizeof(JournalLabelRef)) {
+        return;
+    }
+    s.label_map = move(map);
+    s.label_refs = reinterpret_cast<const JournalLabelRef*>(static_cast<const char*>(addr) + sizeof(JournalHeader));
+}
+
+size_t JournalReader::entries() const {
+    size_t total = 0;
+    for (const Segment& s : segments_) total += s.count;
+    return total;
+}
+
+size_t JournalReader::query(const Query& q, const function<bool(const Hit&)>& on_hit) const {
+    size_t hits = 0;
+    Hit hit;
+    for (const Segment& s : segments_) {
+        // 段内记录按时间递增：整段在范围外则跳过，否则二分到起点
+        if (s.entries[s.count - 1].ts_ms < q.from_ms || s.entries[0].ts_ms >= q.to_ms) continue;
+        if (q.label != INT32_MIN && s.label_refs) {
+            // 有用户ID索引：先取该用户的序号区间（序号递增即时间递增），再在区间内二分到起点
+            const JournalLabelRef* refs_end = s.label_refs + s.count;
+            auto range = equal_range(s.label_refs, refs_end, JournalLabelRef{q.label, 0},
+                                     [](const JournalLabelRef& a, const JournalLabelRef& b) { return a.label < b.label; });
+            const JournalLabelRef* ref = lower_bound(range.first, range.second, q.from_ms,
+                                                     [&s](const JournalLabelRef& r, int64_t ts) {
+                                                         return r.index < s.count && s.entries[r.index].ts_ms < ts;
+                                                     });
+            for (; ref != range.second; ref++) {
+                if (ref->index >= s.count) break;// 索引与记录不一致（不应发生）
+                const JournalEntry& e = s.entries[ref->index];
+                if (e.ts_ms >= q.to_ms) break;
+                if (q.verdict != 0 && e.verdict != q.verdict) continue;
+                hits++;
+                hit.segment = s.name;
+                hit.index = ref->index;
+                hit.entry = e;
+                if (!on_hit(hit)) return hits;
+            }
+            continue;
+        }
+        const JournalEntry* begin = lower_bound(s.entries, s.entries + s.count, q.from_ms,
+                                                [](const JournalEntry& e, int64_t ts) { return e.ts_ms < ts; });
+        for (const JournalEntry* e = begin; e != s.entries + s.count && e->ts_ms < q.to_ms; e++) {
+            if (q.label != INT32_MIN && e->label != q.label) continue;
+            if (q.verdict != 0 && e->verdict != q.verdict) continue;
+            hits++;
+            hit.segment = s.name;
+            hit.index = static_cast<uint32_t>(e - s.entries);
+            hit.entry = *e;
+            if (!on_hit(hit)) return hits;
+        }
+    }
+    return hits;
+}
+
+bool JournalReader::thumbnail(const string& segment, uint32_t index, vector<unsigned char>& jpeg) const {
+    for (const Segment& s : segments_) {
+        if (s.name != segment) continue;
+        if (index >= s.count || s.entries[index].thumb_size == 0) return false;
+        const JournalEntry& e = s.entries[index];
+        int fd = ::open((dir_ + "/" + segment + ".dat").c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        jpeg.resize(e.thumb_size);
+        ssize_t n = pread(fd, jpeg.data(), e.thumb_size, e.thumb_offset);
+        close(fd);
+        return n == static_cast<ssize_t>(e.thumb_size);
+    }
+    return false;
+}
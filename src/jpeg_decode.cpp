@@ -0,0 +1,62 @@
+/**
+ * @file jpeg_decode.cpp
+ * @brief 基于libjpeg的MJPEG亮度平面缩放解码
+ */
+#include "jpeg_decode.h"
+#include <csetjmp>  // libjpeg错误处理只能通过longjmp跳出
+#include <cstdio>   // jpeglib.h依赖FILE声明
+#include <jpeglib.h>
+
+using namespace cv;
+
+namespace {
+
+// libjpeg默认遇到错误会exit()，替换为longjmp返回调用方
+struct JpegErrorMgr {
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+void onJpegError(j_common_ptr cinfo) {
+    longjmp(reinterpret_cast<JpegErrorMgr*>(cinfo->err)->jump, 1);
+}
+
+// 摄像头MJPEG常有轻微损坏（如缺少结束标记），屏蔽libjpeg的警告输出
+void onJpegMessage(j_common_ptr) {}
+
+}
+
+bool decodeJpegGray(const unsigned char* data, size_t size, Mat& gray, int scale_denom) {
+    if (!data || size == 0) return false;
+
+    jpeg_decompress_struct cinfo;
+    JpegErrorMgr jerr;
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = onJpegError;
+    jerr.pub.output_message = onJpegMessage;
+    if (setjmp(jerr.jump)) {
+        // 数据损坏：释放解码器，丢弃本帧
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_GRAYSCALE;// 只要亮度：色度分量不做反DCT
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = scale_denom;      // DCT域缩放
+    cinfo.dct_method = JDCT_IFAST;        // 检测对精度不敏感，用快速整数反DCT
+    cinfo.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&cinfo);
+
+    int w = static_cast<int>(cinfo.output_width), h = static_cast<int>(cinfo.output_height);
+    if (gray.rows != h || gray.cols != w || gray.type() != CV_8UC1) gray.create(h, w, CV_8UC1);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = gray.ptr<uchar>(static_cast<int>(cinfo.output_scanline));
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
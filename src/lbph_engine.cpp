@@ -0,0 +1,835 @@
+/**
+ * @file lbph_engine.cpp
+ * @brief 自研LBPH识别引擎实现（编译期特化LBP编码、统一模式查找表、对齐画廊、SIMD卡方距离、
+ *        先粗后精画廊索引、可映射的二进制模型）
+ */
+#include "lbph_engine.h"
+#include <fcntl.h>   // open
+#include <sys/mman.h>// mmap/munmap
+#include <sys/stat.h>// fstat
+#include <unistd.h>  // close
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>   // offsetof
+#include <cstdint>
+#include <cstdio>    // rename/remove
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+constexpr int kMaxNeighbors = 16;// 邻域数上限（每格2^16个模式已远超实用范围）
+
+/**
+ * @brief 统一模式查找表：循环二进制编码中0/1跳变不超过2次的为统一模式
+ * @details N位编码共有N*(N-1)+2个统一模式，按编码从小到大依次编号，
+ *          其余非统一模式全部映射到最后一个编号N*(N-1)+2
+ */
+template <int N>
+struct UniformTable {
+    static constexpr int kPatterns = N * (N - 1) + 3;
+    std::array<uint8_t, (1 << N)> map{};
+    constexpr UniformTable() {
+        int next = 0;
+        for (int code = 0; code < (1 << N); code++) {
+            int transitions = 0;
+            for (int b = 0; b < N; b++) {
+                transitions += ((code >> b) & 1) != ((code >> ((b + 1) % N)) & 1);
+            }
+            map[code] = static_cast<uint8_t>(transitions <= 2 ? next++ : N * (N - 1) + 2);
+        }
+    }
+};
+constexpr UniformTable<8> kUniform8{};
+static_assert(kUniform8.map[0] == 0 && kUniform8.map[255] == 57 && kUniform8.map[0x55] == 58,
+              "统一模式查找表编号错误");
+
+/**
+ * @brief 圆形邻域中一个采样点的双线性插值参数（与OpenCV elbp_的计算方式完全相同）
+ */
+struct NeighborTap {
+    int fy, fx, cy, cx;      // 相对中心像素的四个整数邻点
+    float w1, w2, w3, w4;    // 插值权重
+};
+
+void neighborTaps(int radius, int neighbors, NeighborTap* taps) {
+    for (int n = 0; n < neighbors; n++) {
+        float x = static_cast<float>(radius * cos(2.0 * CV_PI * n / static_cast<float>(neighbors)));
+        float y = static_cast<float>(-radius * sin(2.0 * CV_PI * n / static_cast<float>(neighbors)));
+        NeighborTap& t = taps[n];
+        t.fx = static_cast<int>(floor(x));
+        t.fy = static_cast<int>(floor(y));
+        t.cx = static_cast<int>(ceil(x));
+        t.cy = static_cast<int>(ceil(y));
+        float ty = y - t.fy, tx = x - t.fx;
+        t.w1 = (1 - tx) * (1 - ty);
+        t.w2 = tx * (1 - ty);
+        t.w3 = (1 - tx) * ty;
+        t.w4 = tx * ty;
+    }
+}
+
+/**
+ * @brief 计算LBP编码图（dst为(rows-2R)×(cols-2R)的CV_32S）
+ * @details R/N为编译期常量时邻域循环完全展开；为0时使用运行期参数radius/neighbors（通用实现）。
+ *          每个像素一次算出全部N位（OpenCV按位逐遍扫描整张图），比较规则与OpenCV相同：
+ *          插值结果大于中心值，或与中心值之差小于float精度时该位为1
+ */
+template <int R, int N>
+void lbpImage(const Mat& src, Mat& dst, int radius, int neighbors) {
+    const int r = R ? R : radius;
+    const int nb = N ? N : neighbors;
+    NeighborTap taps[kMaxNeighbors];
+    neighborTaps(r, nb, taps);
+    // 四个邻点相对中心像素的内存偏移
+    const ptrdiff_t step = static_cast<ptrdiff_t>(src.step);
+    ptrdiff_t off[kMaxNeighbors][4];
+    for (int n = 0; n < nb; n++) {
+        off[n][0] = taps[n].fy * step + taps[n].fx;
+        off[n][1] = taps[n].fy * step + taps[n].cx;
+        off[n][2] = taps[n].cy * step + taps[n].fx;
+        off[n][3] = taps[n].cy * step + taps[n].cx;
+    }
+    for (int i = r; i < src.rows - r; i++) {
+        const uchar* row = src.ptr<uchar>(i);
+        int* out = dst.ptr<int>(i - r);
+        for (int j = r; j < src.cols - r; j++) {
+            const uchar* p = row + j;
+            const float c = p[0];
+            int code = 0;
+            for (int n = 0; n < nb; n++) {
+                const NeighborTap& t = taps[n];
+                float v = static_cast<float>(t.w1 * p[off[n][0]] + t.w2 * p[off[n][1]] +
+                                             t.w3 * p[off[n][2]] + t.w4 * p[off[n][3]]);
+                code |= ((v > c) || (std::abs(v - c) < numeric_limits<float>::epsilon())) << n;
+            }
+            out[j - r] = code;
+        }
+    }
+}
+
+size_t alignedStride(int hist_size) {
+    const size_t per_line = LBPH_ALIGN / sizeof(float);
+    return (static_cast<size_t>(hist_size) + per_line - 1) / per_line * per_line;
+}
+
+constexpr size_t kChiBlock = 256;// 单精度累加的块长，块间用双精度累加
+constexpr int kKmeansIters = 4;  // 身份质心聚类的迭代次数（只影响候选召回，不影响精排的正确性）
+
+using Nearest = pair<double, int>;// (距离, 下标)
+
+/**
+ * @brief 二进制模型文件头（本机字节序）
+ * @details 文件布局：文件头 | 标签（int32×samples） | 直方图（samples行，每行stride个float，行尾补0）
+ *          | 索引（identities>0时）：整数段（order[samples]、id_begin[identities+1]、
+ *            cluster_begin[clusters+1]、cluster_ids[identities]） | 身份质心 | 簇中心（行格式同直方图）
+ *          各段起始偏移和文件总长都是LBPH_ALIGN的整数倍，映射基址按页对齐，因此每行直方图都对齐；
+ *          checksum为整个文件（checksum字段按0计）的64位FNV-1a（按8字节字计算）
+ */
+struct BinaryHeader {
+    char magic[8];          // 文件标识 "LBPHBIN\0"
+    uint32_t version;       // 格式版本
+    uint32_t header_size;   // sizeof(BinaryHeader)
+    int32_t radius, neighbors, grid_x, grid_y;// LBP参数
+    uint32_t uniform;       // 是否统一模式
+    uint32_t samples;       // 样本数
+    uint32_t hist_size;     // 直方图有效长度
+    uint32_t stride;        // 行长（float个数）
+    double threshold;       // 距离阈值
+    uint64_t labels_offset; // 标签段偏移
+    uint64_t hists_offset;  // 直方图段偏移
+    uint32_t identities;    // 索引：身份数（0表示未保存索引，加载时重建）
+    uint32_t clusters;      // 索引：簇数
+    uint64_t index_offset;  // 索引整数段偏移
+    uint64_t centroids_offset;// 身份质心段偏移
+    uint64_t clusters_offset; // 簇中心段偏移
+    uint64_t file_size;     // 文件总长
+    uint64_t checksum;      // 校验和
+};
+constexpr char kBinaryMagic[8] = {'L', 'B', 'P', 'H', 'B', 'I', 'N', '\0'};
+constexpr uint32_t kBinaryVersion = 1;
+static_assert(offsetof(BinaryHeader, checksum) % 8 == 0, "校验和字段须按8字节对齐");
+
+uint64_t alignUp(uint64_t value) { return (value + LBPH_ALIGN - 1) / LBPH_ALIGN * LBPH_ALIGN; }
+
+/**
+ * @brief 64位FNV-1a，按8字节字计算（size须为8的整数倍），第skip_word个字按0计
+ * @details 逐字而不是逐字节计算，校验几十MB的画廊只需几十毫秒
+ */
+uint64_t checksumWords(const unsigned char* data, size_t size, size_t skip_word, uint64_t hash = 1469598103934665603ULL) {
+    for (size_t w = 0; w < size / 8; w++) {
+        uint64_t word = 0;
+        if (w != skip_word) memcpy(&word, data + w * 8, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+//前cap名列表（按距离升序，已有filled个）中第cap名的距离，未满时为DBL_MAX；用作提前放弃的界
+double nearestBound(const Nearest* list, int filled, int cap) {
+    return filled < cap ? DBL_MAX : list[cap - 1].first;
+}
+
+//把(dist, index)插入前cap名列表，dist不小于第cap名时不插入
+void insertNearest(Nearest* list, int& filled, int cap, double dist, int index) {
+    if (dist >= nearestBound(list, filled, cap)) return;
+    int pos = filled < cap ? filled++ : cap - 1;
+    for (; pos > 0 && list[pos - 1].first > dist; pos--) list[pos] = list[pos - 1];
+    list[pos] = {dist, index};
+}
+
+}  // namespace
+
+// ====================== 参数与存储 ======================
+
+LbphEngine::LbphEngine(int radius, int neighbors, int grid_x, int grid_y, double threshold, bool uniform)
+    : radius_(radius), neighbors_(neighbors), grid_x_(grid_x), grid_y_(grid_y),
+      threshold_(threshold), uniform_(uniform) {
+    configure();
+}
+
+bool LbphEngine::configure() {
+    if (radius_ < 1 || neighbors_ < 1 || neighbors_ > kMaxNeighbors || grid_x_ < 1 || grid_y_ < 1) return false;
+    if (uniform_ && neighbors_ != 8) return false;// 统一模式查找表只生成了8邻域
+    int patterns = uniform_ ? UniformTable<8>::kPatterns : (1 << neighbors_);
+    hist_size_ = grid_x_ * grid_y_ * patterns;
+    stride_ = alignedStride(hist_size_);
+    probes_ = allocRows(MAX_FACES_PER_FRAME);
+    return true;
+}
+
+LbphEngine::AlignedFloats LbphEngine::allocRows(int count) const {
+    size_t bytes = max<size_t>(1, static_cast<size_t>(count) * stride_) * sizeof(float);
+    bytes = (bytes + LBPH_ALIGN - 1) / LBPH_ALIGN * LBPH_ALIGN;// aligned_alloc要求大小为对齐的整数倍
+    float* p = static_cast<float*>(aligned_alloc(LBPH_ALIGN, bytes));
+    if (p) memset(p, 0, bytes);// 行尾补齐部分保持为0，不影响卡方距离
+    return AlignedFloats(p);
+}
+
+// ====================== 模型读写（与OpenCV lbph_model.yml兼容） ======================
+
+bool LbphEngine::read(const string& path) {
+    FileStorage fs(path, FileStorage::READ);
+    if (!fs.isOpened()) return false;
+    FileNode fn = fs.getFirstTopLevelNode();// OpenCV保存时顶层节点为opencv_lbphfaces
+    if (fn.empty()) return false;
+
+    LbphEngine tmp(static_cast<int>(fn["radius"]), static_cast<int>(fn["neighbors"]),
+                   static_cast<int>(fn["grid_x"]), static_cast<int>(fn["grid_y"]),
+                   static_cast<double>(fn["threshold"]),
+                   !fn["uniform"].empty() && static_cast<int>(fn["uniform"]) != 0);
+    if (!tmp.configure()) return false;
+
+    FileNode hists = fn["histograms"];
+    Mat labels;
+    fn["labels"] >> labels;
+    int count = static_cast<int>(hists.size());
+    if (labels.total() != static_cast<size_t>(count)) return false;
+
+    tmp.storage_ = tmp.allocRows(count);
+    if (!tmp.storage_) return false;
+    int i = 0;
+    for (const FileNode& node : hists) {
+        Mat h;
+        node >> h;
+        if (h.total() != static_cast<size_t>(tmp.hist_size_) || h.type() != CV_32F) return false;
+        Mat row = h.reshape(1, 1);
+        if (!row.isContinuous()) row = row.clone();
+        memcpy(tmp.storage_.get() + i * tmp.stride_, row.ptr<float>(), tmp.hist_size_ * sizeof(float));
+        i++;
+    }
+    Mat labels_32s;
+    labels.convertTo(labels_32s, CV_32S);
+    labels_32s = labels_32s.reshape(1, 1);
+    tmp.labels_.assign(labels_32s.ptr<int>(), labels_32s.ptr<int>() + count);
+    tmp.samples_ = count;
+    tmp.gallery_ = tmp.storage_.get();
+
+    // 全部解析成功后再替换当前模型（索引随之重建）
+    radius_ = tmp.radius_;
+    neighbors_ = tmp.neighbors_;
+    grid_x_ = tmp.grid_x_;
+    grid_y_ = tmp.grid_y_;
+    threshold_ = tmp.threshold_;
+    uniform_ = tmp.uniform_;
+    hist_size_ = tmp.hist_size_;
+    stride_ = tmp.stride_;
+    samples_ = tmp.samples_;
+    storage_ = move(tmp.storage_);
+    gallery_ = tmp.gallery_;
+    labels_ = move(tmp.labels_);
+    probes_ = move(tmp.probes_);
+    mapping_.reset();
+    buildIndex();
+    return true;
+}
+
+bool LbphEngine::write(const string& path) const {
+    FileStorage fs(path, FileStorage::WRITE);
+    if (!fs.isOpened()) return false;
+    // 字段与顺序同OpenCV LBPH::write，OpenCV的read()可直接加载
+    fs << "opencv_lbphfaces" << "{";
+    fs << "format" << 3;
+    fs << "radius" << radius_;
+    fs << "neighbors" << neighbors_;
+    fs << "grid_x" << grid_x_;
+    fs << "grid_y" << grid_y_;
+    fs << "threshold" << threshold_;
+    if (uniform_) fs << "uniform" << 1;// 仅统一模式写出（OpenCV会忽略，但直方图不兼容）
+    fs << "histograms" << "[";
+    for (int i = 0; i < samples_; i++) {
+        fs << Mat(1, hist_size_, CV_32F, const_cast<float*>(histogram(i)));
+    }
+    fs << "]";
+    fs << "labels" << Mat(samples_, 1, CV_32S, const_cast<int*>(labels_.data()));
+    fs << "labelsInfo" << "[" << "]";
+    fs << "}";
+    return true;
+}
+
+bool LbphEngine::train(const vector<Mat>& images, const vector<int>& labels, int workers) {
+    if (images.empty() || images.size() != labels.size() || !configure()) return false;
+    int count = static_cast<int>(images.size());
+    AlignedFloats storage = allocRows(count);
+    if (!storage) return false;
+    // 各线程按原子计数领取样本，直方图直接写入画廊行；computeHistogram复用引擎内的LBP编码缓冲，
+    // 因此除当前线程外每个线程各用一个同参数的引擎计算
+    atomic<int> next{0};
+    auto worker = [&](LbphEngine& engine) {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            engine.computeHistogram(images[i], storage.get() + i * stride_);
+        }
+    };
+    workers = max(1, min(workers, count));
+    vector<thread> pool;
+    for (int t = 1; t < workers; t++) {
+        pool.emplace_back([&]() {
+            LbphEngine engine(radius_, neighbors_, grid_x_, grid_y_, threshold_, uniform_);
+            worker(engine);
+        });
+    }
+    worker(*this);
+    for (thread& t : pool) t.join();
+    storage_ = move(storage);
+    gallery_ = storage_.get();
+    mapping_.reset();
+    labels_ = labels;
+    samples_ = count;
+    buildIndex();
+    return true;
+}
+
+bool LbphEngine::assign(const float* hists, size_t hist_stride, const int* labels, int count) {
+    if (count < 0 || hist_stride < static_cast<size_t>(hist_size_) || !configure()) return false;
+    AlignedFloats storage = allocRows(count);
+    if (!storage) return false;
+    for (int i = 0; i < count; i++) {
+        memcpy(storage.get() + i * stride_, hists + i * hist_stride, hist_size_ * sizeof(float));
+    }
+    storage_ = move(storage);
+    gallery_ = storage_.get();
+    mapping_.reset();
+    labels_.assign(labels, labels + count);
+    samples_ = count;
+    buildIndex();
+    return true;
+}
+
+// ====================== 二进制模型（只读映射） ======================
+
+bool LbphEngine::isBinaryModel(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(kBinaryMagic)] = {};
+    return in.read(magic, sizeof(magic)) && memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+}
+
+bool LbphEngine::load(const string& path) {
+    return isBinaryModel(path) ? readBinary(path) : read(path);
+}
+
+bool LbphEngine::save(const string& path) const {
+    string ext = path.substr(min(path.size(), path.rfind('.')));
+    transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".yml" || ext == ".yaml" || ext == ".xml") return write(path);
+    return writeBinary(path);
+}
+
+bool LbphEngine::readBinary(const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    // 只读私有映射：页面按需从页缓存换入，多个进程共享同一份物理页
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);// 映射建立后文件描述符不再需要
+    if (addr == MAP_FAILED) return false;
+    shared_ptr<const void> mapping(addr, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+
+    // 1. 文件头与各段范围
+    const unsigned char* base = static_cast<const unsigned char*>(addr);
+    BinaryHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 || h.version != kBinaryVersion ||
+        h.header_size != sizeof(BinaryHeader) || h.file_size != size || size % 8 != 0) {
+        return false;
+    }
+    if (h.stride < h.hist_size || h.labels_offset < sizeof(BinaryHeader) ||
+        h.labels_offset + uint64_t(h.samples) * sizeof(int32_t) > h.hists_offset ||
+        h.hists_offset % LBPH_ALIGN != 0 ||
+        h.hists_offset + uint64_t(h.samples) * h.stride * sizeof(float) > size) {
+        return false;
+    }
+    // 2. 校验和（顺带把整个文件读入页缓存）
+    if (checksumWords(base, size, offsetof(BinaryHeader, checksum) / 8) != h.checksum) return false;
+
+    // 3. 参数须与直方图长度一致
+    LbphEngine tmp(h.radius, h.neighbors, h.grid_x, h.grid_y, h.threshold, h.uniform != 0);
+    if (!tmp.configure() || static_cast<uint32_t>(tmp.hist_size_) != h.hist_size) return false;
+
+    // 全部校验通过后再替换当前模型：直方图原地使用，只复制标签
+    radius_ = tmp.radius_;
+    neighbors_ = tmp.neighbors_;
+    grid_x_ = tmp.grid_x_;
+    grid_y_ = tmp.grid_y_;
+    threshold_ = tmp.threshold_;
+    uniform_ = tmp.uniform_;
+    hist_size_ = tmp.hist_size_;
+    stride_ = h.stride;
+    probes_ = allocRows(MAX_FACES_PER_FRAME);// 探针行长与画廊一致
+    samples_ = static_cast<int>(h.samples);
+    const int32_t* labels = reinterpret_cast<const int32_t*>(base + h.labels_offset);
+    labels_.assign(labels, labels + samples_);
+    gallery_ = reinterpret_cast<const float*>(base + h.hists_offset);
+    mapping_ = move(mapping);
+    storage_.reset();
+    if (!adoptIndex(base, &h)) buildIndex();// 旧文件或索引不完整时重新计算
+    return true;
+}
+
+bool LbphEngine::adoptIndex(const unsigned char* base, const void* header) {
+    const BinaryHeader& h = *static_cast<const BinaryHeader*>(header);
+    if (h.identities == 0 || h.clusters == 0 || h.clusters > h.identities || h.identities > h.samples) return false;
+    uint64_t ints = uint64_t(h.samples) + h.identities + 1 + h.clusters + 1 + h.identities;
+    uint64_t row_bytes = uint64_t(stride_) * sizeof(float);
+    if (h.index_offset < h.hists_offset || h.index_offset + ints * sizeof(int32_t) > h.centroids_offset ||
+        h.centroids_offset % LBPH_ALIGN != 0 || h.clusters_offset % LBPH_ALIGN != 0 ||
+        h.centroids_offset + h.identities * row_bytes > h.clusters_offset ||
+        h.clusters_offset + h.clusters * row_bytes > h.file_size) {
+        return false;
+    }
+    const int32_t* p = reinterpret_cast<const int32_t*>(base + h.index_offset);
+    vector<int> order(p, p + h.samples);
+    p += h.samples;
+    vector<int> id_begin(p, p + h.identities + 1);
+    p += h.identities + 1;
+    vector<int> cluster_begin(p, p + h.clusters + 1);
+    p += h.clusters + 1;
+    vector<int> cluster_ids(p, p + h.identities);
+
+    // 下标范围与分组边界须一致（防止越界访问）
+    auto monotonic = [](const vector<int>& v, int last) {
+        if (v.front() != 0 || v.back() != last) return false;
+        return is_sorted(v.begin(), v.end());
+    };
+    if (!monotonic(id_begin, samples_) || !monotonic(cluster_begin, static_cast<int>(h.identities))) return false;
+    for (int s : order) if (s < 0 || s >= samples_) return false;
+    for (int id : cluster_ids) if (id < 0 || id >= static_cast<int>(h.identities)) return false;
+
+    order_ = move(order);
+    id_begin_ = move(id_begin);
+    cluster_begin_ = move(cluster_begin);
+    cluster_ids_ = move(cluster_ids);
+    identities_ = static_cast<int>(h.identities);
+    clusters_count_ = static_cast<int>(h.clusters);
+    centroids_ = reinterpret_cast<const float*>(base + h.centroids_offset);
+    clusters_ = reinterpret_cast<const float*>(base + h.clusters_offset);
+    centroid_storage_.reset();
+    cluster_storage_.reset();
+    near_clusters_.resize(MAX_FACES_PER_FRAME * probe_clusters_);
+    candidates_.resize(MAX_FACES_PER_FRAME * LBPH_INDEX_TOP_K);
+    return true;
+}
+
+bool LbphEngine::writeBinary(const string& path) const {
+    BinaryHeader h{};
+    memcpy(h.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    h.version = kBinaryVersion;
+    h.header_size = sizeof(BinaryHeader);
+    h.radius = radius_;
+    h.neighbors = neighbors_;
+    h.grid_x = grid_x_;
+    h.grid_y = grid_y_;
+    h.uniform = uniform_ ? 1 : 0;
+    h.samples = static_cast<uint32_t>(samples_);
+    h.hist_size = static_cast<uint32_t>(hist_size_);
+    h.stride = static_cast<uint32_t>(stride_);
+    h.threshold = threshold_;
+    h.labels_offset = alignUp(sizeof(BinaryHeader));
+    h.hists_offset = alignUp(h.labels_offset + uint64_t(samples_) * sizeof(int32_t));
+    uint64_t row_bytes = uint64_t(stride_) * sizeof(float);
+    h.file_size = alignUp(h.hists_offset + samples_ * row_bytes);
+    bool with_index = identities_ > 0 && clusters_count_ > 0 && centroids_ && clusters_;
+    if (with_index) {
+        h.identities = static_cast<uint32_t>(identities_);
+        h.clusters = static_cast<uint32_t>(clusters_count_);
+        h.index_offset = h.file_size;
+        uint64_t ints = uint64_t(samples_) + identities_ + 1 + clusters_count_ + 1 + identities_;
+        h.centroids_offset = alignUp(h.index_offset + ints * sizeof(int32_t));
+        h.clusters_offset = alignUp(h.centroids_offset + identities_ * row_bytes);
+        h.file_size = alignUp(h.clusters_offset + clusters_count_ * row_bytes);
+    }
+
+    // 在内存中拼出完整文件（补齐部分为0），计算校验和后一次写出
+    vector<unsigned char> buf(h.file_size, 0);
+    memcpy(buf.data() + h.labels_offset, labels_.data(), samples_ * sizeof(int32_t));
+    if (samples_ > 0) memcpy(buf.data() + h.hists_offset, gallery_, samples_ * row_bytes);
+    if (with_index) {
+        unsigned char* p = buf.data() + h.index_offset;
+        for (const vector<int>* v : {&order_, &id_begin_, &cluster_begin_, &cluster_ids_}) {
+            memcpy(p, v->data(), v->size() * sizeof(int32_t));
+            p += v->size() * sizeof(int32_t);
+        }
+        memcpy(buf.data() + h.centroids_offset, centroids_, identities_ * row_bytes);
+        memcpy(buf.data() + h.clusters_offset, clusters_, clusters_count_ * row_bytes);
+    }
+    memcpy(buf.data(), &h, sizeof(h));
+    h.checksum = checksumWords(buf.data(), buf.size(), offsetof(BinaryHeader, checksum) / 8);
+    memcpy(buf.data(), &h, sizeof(h));
+
+    string tmp_path = path + ".tmp";
+    {
+        ofstream out(tmp_path, ios::binary | ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(buf.data()), buf.size())) {
+            remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// ====================== 画廊索引 ======================
+
+void LbphEngine::buildIndex() {
+    // 1. 样本下标按用户ID稳定排序，同一身份的样本连续存放
+    order_.resize(samples_);
+    for (int i = 0; i < samples_; i++) order_[i] = i;
+    stable_sort(order_.begin(), order_.end(), [this](int a, int b) { return labels_[a] < labels_[b]; });
+    id_begin_.clear();
+    for (int i = 0; i < samples_; i++) {
+        if (i == 0 || labels_[order_[i]] != labels_[order_[i - 1]]) id_begin_.push_back(i);
+    }
+    identities_ = static_cast<int>(id_begin_.size());
+    id_begin_.push_back(samples_);
+
+    // 2. 质心 = 该身份全部样本直方图的均值（每格仍是归一化直方图，与样本可直接比较卡方距离）
+    centroid_storage_ = allocRows(identities_);
+    centroids_ = centroid_storage_.get();
+    for (int id = 0; id < identities_ && centroid_storage_; id++) {
+        float* c = centroid_storage_.get() + id * stride_;
+        int n = id_begin_[id + 1] - id_begin_[id];
+        for (int k = id_begin_[id]; k < id_begin_[id + 1]; k++) {
+            const float* h = histogram(order_[k]);
+            for (int j = 0; j < hist_size_; j++) c[j] += h[j];
+        }
+        float inv = 1.0f / n;
+        for (int j = 0; j < hist_size_; j++) c[j] *= inv;
+    }
+    clusterIdentities();
+    near_clusters_.resize(MAX_FACES_PER_FRAME * probe_clusters_);
+    candidates_.resize(MAX_FACES_PER_FRAME * LBPH_INDEX_TOP_K);
+}
+
+void LbphEngine::clusterIdentities() {
+    clusters_count_ = 0;
+    cluster_begin_.clear();
+    cluster_ids_.clear();
+    if (!centroids_ || identities_ == 0) return;
+    int k = max(1, static_cast<int>(lround(sqrt(static_cast<double>(identities_)))));
+    cluster_storage_ = allocRows(k);
+    clusters_ = cluster_storage_.get();
+    if (!clusters_) return;
+    // 初始簇中心：等间隔取身份质心（确定性，同一模型每次加载的索引相同）
+    for (int c = 0; c < k; c++) {
+        memcpy(cluster_storage_.get() + c * stride_, centroids_ + static_cast<size_t>(c) * identities_ / k * stride_,
+               stride_ * sizeof(float));
+    }
+    vector<int> owner(identities_, 0), members(k);
+    for (int iter = 0; iter < kKmeansIters; iter++) {
+        // 1. 每个身份归入最近的簇中心
+        for (int id = 0; id < identities_; id++) {
+            const float* cen = centroids_ + id * stride_;
+            double best = DBL_MAX;
+            for (int c = 0; c < k; c++) {
+                double dist = chiSquareAlt(clusters_ + c * stride_, cen, stride_, best);
+                if (dist < best) {
+                    best = dist;
+                    owner[id] = c;
+                }
+            }
+        }
+        // 2. 簇中心 = 成员质心的均值（空簇保留原中心）
+        AlignedFloats sums = allocRows(k);
+        if (!sums) break;
+        fill(members.begin(), members.end(), 0);
+        for (int id = 0; id < identities_; id++) {
+            float* sum = sums.get() + owner[id] * stride_;
+            const float* cen = centroids_ + id * stride_;
+            for (int j = 0; j < hist_size_; j++) sum[j] += cen[j];
+            members[owner[id]]++;
+        }
+        for (int c = 0; c < k; c++) {
+            if (members[c] == 0) continue;
+            float inv = 1.0f / members[c];
+            float* dst = cluster_storage_.get() + c * stride_;
+            const float* sum = sums.get() + c * stride_;
+            for (int j = 0; j < hist_size_; j++) dst[j] = sum[j] * inv;
+        }
+    }
+    // 3. 按最后一次分配把身份下标按簇分组（计数排序）
+    cluster_begin_.assign(k + 1, 0);
+    for (int id = 0; id < identities_; id++) cluster_begin_[owner[id] + 1]++;
+    for (int c = 0; c < k; c++) cluster_begin_[c + 1] += cluster_begin_[c];
+    cluster_ids_.resize(identities_);
+    vector<int> next(cluster_begin_.begin(), cluster_begin_.end() - 1);
+    for (int id = 0; id < identities_; id++) cluster_ids_[next[owner[id]]++] = id;
+    clusters_count_ = k;
+}
+
+void LbphEngine::setProbeClusters(int clusters) {
+    probe_clusters_ = max(1, clusters);
+    near_clusters_.resize(MAX_FACES_PER_FRAME * probe_clusters_);
+}
+
+bool LbphEngine::indexed() const {
+    if (!centroids_ || clusters_count_ == 0) return false;
+    if (mode_ == SearchMode::AUTO) return identities_ >= LBPH_INDEX_MIN_IDENTITIES;
+    return mode_ == SearchMode::INDEXED;
+}
+
+// ====================== 直方图 ======================
+
+void LbphEngine::computeHistogram(const Mat& face, float* hist) {
+    fill(hist, hist + hist_size_, 0.0f);
+    Mat gray = face;
+    if (gray.channels() != 1) cvtColor(face, gray, COLOR_BGR2GRAY);
+    int rows = gray.rows - 2 * radius_, cols = gray.cols - 2 * radius_;
+    if (rows <= 0 || cols <= 0) return;
+
+    // 1. LBP编码（常用参数走编译期特化版本）
+    lbp_.create(rows, cols, CV_32S);
+    if (radius_ == 1 && neighbors_ == 8) lbpImage<1, 8>(gray, lbp_, radius_, neighbors_);
+    else if (radius_ == 2 && neighbors_ == 8) lbpImage<2, 8>(gray, lbp_, radius_, neighbors_);
+    else lbpImage<0, 0>(gray, lbp_, radius_, neighbors_);
+
+    // 2. 按grid_x×grid_y网格统计每格的编码直方图，并按格内像素数归一化（同OpenCV spatial_histogram）
+    int patterns = uniform_ ? UniformTable<8>::kPatterns : (1 << neighbors_);
+    int cell_w = cols / grid_x_, cell_h = rows / grid_y_;
+    if (cell_w <= 0 || cell_h <= 0) return;
+    float inv = static_cast<float>(1.0 / (cell_w * cell_h));
+    for (int gy = 0; gy < grid_y_; gy++) {
+        for (int gx = 0; gx < grid_x_; gx++) {
+            float* cell = hist + (gy * grid_x_ + gx) * patterns;
+            for (int i = gy * cell_h; i < (gy + 1) * cell_h; i++) {
+                const int* row = lbp_.ptr<int>(i) + gx * cell_w;
+                if (uniform_) {
+                    for (int j = 0; j < cell_w; j++) cell[kUniform8.map[row[j]]] += 1.0f;
+                } else {
+                    for (int j = 0; j < cell_w; j++) cell[row[j]] += 1.0f;
+                }
+            }
+            for (int k = 0; k < patterns; k++) cell[k] *= inv;
+        }
+    }
+}
+
+// ====================== 卡方距离 ======================
+
+double chiSquareAltScalar(const float* a, const float* b, size_t n) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = a[i] - b[i], s = a[i] + b[i];
+        if (fabs(s) > DBL_EPSILON) result += d * d / s;
+    }
+    return 2.0 * result;
+}
+
+const char* LbphEngine::simdName() {
+#if defined(__AVX__)
+    return "AVX";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "SSE2";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+double chiSquareAlt(const float* a, const float* b, size_t n, double bound) {
+    // 直方图元素非负：a+b>0时累加(a-b)²/(a+b)，a+b=0的项（0/0=NaN）用比较掩码清零
+    // 每一项都非负，部分和单调不减：一块累加后已达到bound即可提前返回
+    const double half_bound = bound / 2.0;
+    double result = 0.0;
+    for (size_t blk = 0; blk < n; blk += kChiBlock) {
+        size_t end = min(n, blk + kChiBlock);
+        size_t i = blk;
+        float partial = 0.0f;
+#if defined(__AVX__)
+        __m256 acc = _mm256_setzero_ps();
+        const __m256 zero = _mm256_setzero_ps();
+        for (; i + 8 <= end; i += 8) {
+            __m256 va = _mm256_loadu_ps(a + i), vb = _mm256_loadu_ps(b + i);
+            __m256 d = _mm256_sub_ps(va, vb), s = _mm256_add_ps(va, vb);
+            __m256 q = _mm256_div_ps(_mm256_mul_ps(d, d), s);
+            acc = _mm256_add_ps(acc, _mm256_and_ps(q, _mm256_cmp_ps(s, zero, _CMP_GT_OQ)));
+        }
+        __m128 v = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        partial = _mm_cvtss_f32(v);
+#elif defined(__SSE2__) || defined(_M_X64)
+        __m128 acc = _mm_setzero_ps();
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= end; i += 4) {
+            __m128 va = _mm_loadu_ps(a + i), vb = _mm_loadu_ps(b + i);
+            __m128 d = _mm_sub_ps(va, vb), s = _mm_add_ps(va, vb);
+            __m128 q = _mm_div_ps(_mm_mul_ps(d, d), s);
+            acc = _mm_add_ps(acc, _mm_and_ps(q, _mm_cmpgt_ps(s, zero)));
+        }
+        __m128 v = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        partial = _mm_cvtss_f32(v);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (; i + 4 <= end; i += 4) {
+            float32x4_t va = vld1q_f32(a + i), vb = vld1q_f32(b + i);
+            float32x4_t d = vsubq_f32(va, vb), s = vaddq_f32(va, vb);
+#if defined(__aarch64__)
+            float32x4_t q = vdivq_f32(vmulq_f32(d, d), s);
+#else
+            // ARMv7没有向量除法：倒数估计+两次牛顿迭代（精度与除法相当）
+            float32x4_t r = vrecpeq_f32(s);
+            r = vmulq_f32(vrecpsq_f32(s, r), r);
+            r = vmulq_f32(vrecpsq_f32(s, r), r);
+            float32x4_t q = vmulq_f32(vmulq_f32(d, d), r);
+#endif
+            uint32x4_t mask = vcgtq_f32(s, zero);
+            acc = vaddq_f32(acc, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(q), mask)));
+        }
+#if defined(__aarch64__)
+        partial = vaddvq_f32(acc);
+#else
+        float32x2_t v = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+        partial = vget_lane_f32(vpadd_f32(v, v), 0);
+#endif
+#endif
+        // 块尾不足一个向量的部分（及无SIMD平台的全部元素）
+        for (; i < end; i++) {
+            float d = a[i] - b[i], s = a[i] + b[i];
+            if (s > 0.0f) partial += d * d / s;
+        }
+        result += partial;
+        if (result >= half_bound) break;
+    }
+    return 2.0 * result;
+}
+
+// ====================== 预测 ======================
+
+void LbphEngine::predictBatch(const Mat* faces, int count, int* labels, double* confs) {
+    float* probes = probes_.get();
+    // 每次最多处理MAX_FACES_PER_FRAME张（直方图缓冲容量）
+    for (int base = 0; base < count; base += MAX_FACES_PER_FRAME) {
+        int n = min(MAX_FACES_PER_FRAME, count - base);
+        for (int k = 0; k < n; k++) computeHistogram(faces[base + k], probes + k * stride_);
+        predictHistograms(probes, n, labels + base, confs + base);
+    }
+}
+
+void LbphEngine::predictHistograms(const float* probes, int count, int* labels, double* confs) {
+    for (int k = 0; k < count; k++) {
+        labels[k] = -1;
+        confs[k] = DBL_MAX;
+    }
+    if (samples_ == 0) return;
+    if (indexed()) scanIndexed(probes, count, labels, confs);
+    else scanExhaustive(probes, count, labels, confs);
+}
+
+void LbphEngine::scanExhaustive(const float* probes, int count, int* labels, double* confs) {
+    // 画廊在外层：每个训练直方图只从内存读一次，与批次内所有人脸比较
+    for (int s = 0; s < samples_; s++) {
+        const float* g = histogram(s);
+        for (int k = 0; k < count; k++) {
+            // 以当前最优值（及阈值）为界提前放弃，结果与完整计算相同
+            double dist = chiSquareAlt(g, probes + k * stride_, stride_, min(confs[k], threshold_));
+            if (dist < confs[k] && dist < threshold_) {
+                confs[k] = dist;
+                labels[k] = labels_[s];
+            }
+        }
+    }
+}
+
+void LbphEngine::scanIndexed(const float* probes, int count, int* labels, double* confs) {
+    const int probe_clusters = min(probe_clusters_, clusters_count_);
+    const int top_k = min(LBPH_INDEX_TOP_K, identities_);
+    int near_filled[MAX_FACES_PER_FRAME] = {}, filled[MAX_FACES_PER_FRAME] = {};
+    // 1. 簇中心在外层（批次共享），每张人脸保留最近的probe_clusters个簇
+    for (int c = 0; c < clusters_count_; c++) {
+        const float* center = clusters_ + c * stride_;
+        for (int k = 0; k < count; k++) {
+            Nearest* near = near_clusters_.data() + k * probe_clusters_;
+            double bound = nearestBound(near, near_filled[k], probe_clusters);
+            insertNearest(near, near_filled[k], probe_clusters,
+                          chiSquareAlt(center, probes + k * stride_, stride_, bound), c);
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        const float* p = probes + k * stride_;
+        // 2. 只比较这几个簇内的身份质心，保留最近的top_k个身份
+        Nearest* cand = candidates_.data() + k * LBPH_INDEX_TOP_K;
+        const Nearest* near = near_clusters_.data() + k * probe_clusters_;
+        for (int n = 0; n < near_filled[k]; n++) {
+            int c = near[n].second;
+            for (int j = cluster_begin_[c]; j < cluster_begin_[c + 1]; j++) {
+                int id = cluster_ids_[j];
+                double bound = nearestBound(cand, filled[k], top_k);
+                insertNearest(cand, filled[k], top_k,
+                              chiSquareAlt(centroids_ + id * stride_, p, stride_, bound), id);
+            }
+        }
+        // 3. 精排：只在候选身份的样本中精确比较，从最近的身份开始，当前最优值作为提前放弃的界
+        for (int n = 0; n < filled[k]; n++) {
+            int id = cand[n].second;
+            for (int j = id_begin_[id]; j < id_begin_[id + 1]; j++) {
+                int s = order_[j];
+                double dist = chiSquareAlt(histogram(s), p, stride_, min(confs[k], threshold_));
+                if (dist < confs[k] && dist < threshold_) {
+                    confs[k] = dist;
+                    labels[k] = labels_[s];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file local_socket.cpp
+ * @brief 本机监听套接字（TCP/Unix）
+ */
+#include "local_socket.h"
+#include <arpa/inet.h>    // inet_pton
+#include <netinet/in.h>   // sockaddr_in
+#include <sys/socket.h>   // socket/bind/listen
+#include <sys/stat.h>     // lstat
+#include <sys/un.h>       // sockaddr_un
+#include <unistd.h>       // close/unlink
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+int openLocalListener(const string& spec, string& unix_path) {
+    unix_path.clear();
+    int fd = -1;
+    if (spec.rfind("tcp:", 0) == 0) {
+        string addr = spec.substr(4);
+        size_t colon = addr.rfind(':');
+        if (colon == string::npos) return -1;
+        sockaddr_in sa = {};
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(static_cast<uint16_t>(atoi(addr.c_str() + colon + 1)));
+        if (inet_pton(AF_INET, addr.substr(0, colon).c_str(), &sa.sin_addr) != 1) return -1;
+        // 指标与预览流都没有认证，只允许绑定回环地址（127.0.0.0/8）
+        if ((ntohl(sa.sin_addr.s_addr) >> 24) != 127) {
+            cerr << "[端点] 只允许监听本机回环地址: " << spec << "\n";
+            return -1;
+        }
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else if (spec.rfind("unix:", 0) == 0) {
+        sockaddr_un sa = {};
+        sa.sun_family = AF_UNIX;
+        string path = spec.substr(5);
+        if (path.empty() || path.size() >= sizeof(sa.sun_path)) return -1;
+        strcpy(sa.sun_path, path.c_str());
+        // 上次异常退出残留的套接字文件：只删除套接字，同名的普通文件/目录不动（绑定会失败）
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                cerr << "[端点] 路径已存在且不是套接字: " << path << "\n";
+                return -1;
+            }
+            unlink(path.c_str());
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        unix_path = path;
+    } else {
+        return -1;
+    }
+    if (listen(fd, 4) != 0) {
+        close(fd);
+        if (!unix_path.empty()) unlink(unix_path.c_str());
+        unix_path.clear();
+        return -1;
+    }
+    return fd;
+}
@@ -1,9 +1,186 @@
+/**
+ * @file log_util.cpp
+ * @brief 异步日志实现（无锁环形缓冲、日志线程延迟格式化、批量写出、按大小轮转）
+ */
 #include "log_util.h"
-#include <iostream>
+#include <cstdio>
+#include <ctime>
+#include <thread>
 
-SafeQueue<std::string> g_log_queue(50);// 定义全局日志队列，容量设为50
+using namespace std;
 
-// 实现日志投递函数：将日志消息入队
-void postLog(const std::string& msg) {
-    g_log_queue.push(msg);
-}
\ No newline at end of file
+static_assert(LOG_RING_SIZE > 0 && (LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE必须是2的幂");
+LogRing g_log_ring(LOG_RING_SIZE, LOG_TEXT_SLOTS);// 定义全局日志环形缓冲
+
+static atomic<bool> g_log_stop{false};// 日志线程退出请求
+
+//各事件的格式串（下标为LogEvent，{}依次替换为参数；程序启动时构造一次）
+static const string kLogFormats[] = {
+    "{}",
+    "[成功] [帧{}] 轨迹{} ID={} 置信度={} ({}/" + to_string(VOTE_WINDOW) + "票) 延迟={}ms",
+    "[失败] [帧{}] 轨迹{} 未知人脸，置信度={} ({}/" + to_string(VOTE_WINDOW) + "票) 延迟={}ms",
+    "[复核] [帧{}] 轨迹{} 复核未通过(ID={} 置信度={})，重新投票",
+    "[门禁] 开门(判定→继电器 {}ms)",
+    "[门禁] 门已关闭",
+    "[报警] 蜂鸣器响(判定→蜂鸣器 {}ms)",
+};
+static_assert(sizeof(kLogFormats) / sizeof(kLogFormats[0]) == static_cast<size_t>(LogEvent::COUNT),
+              "日志格式表与LogEvent不一致");
+
+void postLog(const string& msg) {
+    LogRecord rec;
+    rec.ts_ns = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    rec.event = static_cast<uint16_t>(LogEvent::TEXT);
+    // 每行一条记录（多行摘要逐行带时间前缀）；超过一个文本槽的行在UTF-8字符边界处切开
+    size_t pos = 0;
+    do {
+        size_t end = msg.find('\n', pos);
+        if (end == string::npos) end = msg.size();
+        size_t len = min(end - pos, LOG_TEXT_BYTES);
+        if (len < end - pos) {
+            size_t cut = len;
+            while (cut > 0 && (static_cast<unsigned char>(msg[pos + cut]) & 0xC0) == 0x80) cut--;
+            if (cut > 0) len = cut;
+        }
+        g_log_ring.pushText(rec, msg.data() + pos, len);// 缓冲满或槽用完：丢弃（计入丢弃数）
+        pos += len;
+        if (pos < msg.size() && msg[pos] == '\n') pos++;
+    } while (pos < msg.size());
+}
+
+void stopLog() { g_log_stop.store(true); }
+
+unsigned long long logDropped() { return g_log_ring.dropped(); }
+
+void formatLogRecord(const LogRecord& rec, string& out, const string& text) {
+    // 1. 时间前缀 HH:MM:SS.mmm（同一秒内复用已格式化的时分秒）
+    thread_local time_t cached_sec = -1;
+    thread_local char cached_hms[16];
+    time_t sec = static_cast<time_t>(rec.ts_ns / 1000000000);
+    if (sec != cached_sec) {
+        tm local;
+        localtime_r(&sec, &local);
+        strftime(cached_hms, sizeof(cached_hms), "%H:%M:%S", &local);
+        cached_sec = sec;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s.%03d ", cached_hms, static_cast<int>(rec.ts_ns / 1000000 % 1000));
+    out += buf;
+    // 2. 正文：文本事件直接追加，其余按格式串依次替换参数
+    if (rec.event == static_cast<uint16_t>(LogEvent::TEXT)) {
+        out += text;
+    } else if (rec.event < static_cast<uint16_t>(LogEvent::COUNT)) {
+        const string& fmt = kLogFormats[rec.event];
+        int arg = 0;
+        for (size_t i = 0; i < fmt.size(); i++) {
+            if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '}') {
+                if (arg < rec.argc) {
+                    if (rec.types & (1u << arg)) snprintf(buf, sizeof(buf), "%.1f", rec.args[arg].d);
+                    else snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(rec.args[arg].i));
+                    out += buf;
+                }
+                arg++;
+                i++;
+            } else {
+                out += fmt[i];
+            }
+        }
+    } else {
+        out += "[日志] 未知事件 " + to_string(rec.event);
+    }
+    out += '\n';
+}
+
+/**
+ * @brief 按大小轮转的日志文件：超过LOG_FILE_MAX_BYTES时 path→path.1→path.2…，最多保留LOG_FILE_KEEP个
+ */
+class RotatingLogFile {
+public:
+    RotatingLogFile(const string& path, long max_bytes, int keep) : path_(path), max_bytes_(max_bytes), keep_(keep) {
+        fp_ = fopen(path_.c_str(), "a");
+        if (fp_) size_ = ftell(fp_);
+    }
+    ~RotatingLogFile() {
+        if (fp_) fclose(fp_);
+    }
+    //写入一批文本并刷新到内核（写满时先轮转）
+    void write(const string& data) {
+        if (!fp_) return;
+        if (size_ > 0 && size_ + static_cast<long>(data.size()) > max_bytes_) rotate();
+        if (!fp_) return;
+        fwrite(data.data(), 1, data.size(), fp_);
+        fflush(fp_);
+        size_ += static_cast<long>(data.size());
+    }
+    bool ok() const { return fp_ != nullptr; }
+    int rotations() const { return rotations_; }
+
+private:
+    void rotate() {
+        fclose(fp_);
+        for (int i = keep_; i > 1; i--) {
+            rename((path_ + "." + to_string(i - 1)).c_str(), (path_ + "." + to_string(i)).c_str());
+        }
+        if (keep_ > 0) rename(path_.c_str(), (path_ + ".1").c_str());
+        fp_ = fopen(path_.c_str(), "w");
+        size_ = 0;
+        rotations_++;
+    }
+
+    string path_;        // 当前日志文件
+    long max_bytes_;     // 单个文件上限
+    int keep_;           // 保留的历史文件数
+    FILE* fp_ = nullptr; // 当前文件
+    long size_ = 0;      // 当前文件大小
+    int rotations_ = 0;  // 轮转次数
+};
+
+/**
+ * @details 核心流程：
+ *          1. 取空环形缓冲中的记录，逐条格式化追加到批量缓冲（文本记录取出时即归还文本槽）
+ *          2. 批量缓冲达到LOG_BATCH_BYTES，或距上次写出超过LOG_FLUSH_MS时，一次写入终端和日志文件
+ *          3. 缓冲为空时休眠LOG_POLL_MS（生产者不唤醒日志线程，入队路径上没有系统调用）
+ *          4. 收到退出请求后取空缓冲、写出剩余内容并输出统计
+ */
+void runLogWriter() {
+    RotatingLogFile file(LOG_FILE_PATH, LOG_FILE_MAX_BYTES, LOG_FILE_KEEP);
+    if (!file.ok()) fprintf(stderr, "[日志] 无法打开日志文件 %s，只输出到终端\n", LOG_FILE_PATH);
+    string batch;// 批量缓冲（容量复用）
+    batch.reserve(LOG_BATCH_BYTES * 2);
+    LogRecord rec;
+    string text;// 文本记录的正文（容量复用）
+    unsigned long long written = 0, flushes = 0;
+    auto last_flush = chrono::steady_clock::now();
+    auto flush = [&]() {
+        if (batch.empty()) return;
+        if (LOG_TO_CONSOLE) {
+            fwrite(batch.data(), 1, batch.size(), stdout);
+            fflush(stdout);
+        }
+        file.write(batch);
+        batch.clear();
+        flushes++;
+        last_flush = chrono::steady_clock::now();
+    };
+
+    while (true) {
+        bool stopping = g_log_stop.load();// 先读退出标志再取缓冲：退出前入队的记录一定会被取到
+        bool got = false;
+        while (batch.size() < static_cast<size_t>(LOG_BATCH_BYTES) && g_log_ring.pop(rec, &text)) {
+            formatLogRecord(rec, batch, text);
+            written++;
+            got = true;
+        }
+        if (batch.size() >= static_cast<size_t>(LOG_BATCH_BYTES) ||
+            chrono::steady_clock::now() - last_flush >= chrono::milliseconds(LOG_FLUSH_MS) || (stopping && !got)) {
+            flush();
+        }
+        if (!got) {
+            if (stopping) break;
+            this_thread::sleep_for(chrono::milliseconds(LOG_POLL_MS));
+        }
+    }
+    batch = "[日志] 共输出 " + to_string(written) + " 条, 缓冲满丢弃 " + to_string(logDropped()) + " 条, 批量写出 " +
+            to_string(flushes) + " 次, 文件轮转 " + to_string(file.rotations()) + " 次\n";
+    flush();
+}
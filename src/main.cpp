@@ -1,20 +1,95 @@
 #include "door_core.h"
+#include "face_detector.h"
+#include "pipeline_graph.h"
+#include "preview_sink.h"
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
 
 /**
  * @file main.cpp
  * @brief 人脸识别门禁系统主程序入口
- * @details 1. 创建DoorCore核心类实例（自动调用构造函数初始化资源）
- *          2. 调用startSystem()启动所有业务线程（采集/检测/识别/日志）
- *          3. 程序运行期间阻塞在startSystem()的循环中，直到手动终止
+ * @details 1. 解析命令行参数，创建帧源（默认实时摄像头）
+ *          2. 创建DoorCore核心类实例（自动调用构造函数初始化资源）
+ *          3. 调用startSystem()启动所有业务线程（采集/检测/识别/日志）
+ *          4. 程序运行期间阻塞在startSystem()的循环中，直到手动终止或回放结束
+ * @note 用法：face_door [帧源] [--fast] [--detector=<后端>[:<模型路径>]] [--gpio=<后端>] [--metrics=<端点>]
+ *                 [--pipeline=<配置文件>] [--preview=<输出>] [--headless]
+ *       帧源：v4l2:<设备号> | file:<录像> | dir:<图片目录> | synthetic[:<帧数>]
+ *       --fast：回放源不按帧率节拍，尽可能快地输出（测量吞吐上限）
+ *       --detector：人脸检测后端 haar | lbp | dnn（默认取自config.h的DETECTOR_BACKEND）
+ *       --gpio：GPIO后端 gpiod[:<芯片设备>] | sim（默认取自config.h的GPIO_BACKEND）
+ *       --metrics：指标端点 tcp:<地址>:<端口> | unix:<套接字路径> | off（默认取自config.h的METRICS_ENDPOINT）
+ *       --pipeline：流水线配置（各阶段线程数/绑核/优先级、各边容量/满时策略，示例见pipeline.example.yml）；
+ *                   默认读取config.h的PIPELINE_CONFIG_PATH，该文件不存在时使用内置默认值
+ *       --preview：预览输出 window | mjpeg:<文件> | tcp:<地址>:<端口> | unix:<套接字路径> | off
+ *                  （默认取自config.h的PREVIEW_SINK）
+ *       --headless：无头模式（同--preview=off），不需要图形界面，不取帧绘制；SIGINT/SIGTERM正常退出
  */
-int main() {
+int main(int argc, char** argv) {
+    std::string spec = DEFAULT_FRAME_SOURCE;   // 帧源描述
+    ReplayMode mode = ReplayMode::REALTIME;     // 回放模式
+    std::string detector_spec = DETECTOR_BACKEND;// 人脸检测后端
+    std::string gpio_spec = GPIO_BACKEND;        // GPIO后端
+    std::string metrics_spec = METRICS_ENDPOINT; // 指标端点
+    std::string pipeline_path = PIPELINE_CONFIG_PATH;// 流水线配置文件
+    bool pipeline_given = false;                 // 是否在命令行中指定了配置文件
+    std::string preview_spec = PREVIEW_SINK;     // 预览输出
+    const std::string detector_opt = "--detector=";
+    const std::string gpio_opt = "--gpio=";
+    const std::string metrics_opt = "--metrics=";
+    const std::string pipeline_opt = "--pipeline=";
+    const std::string preview_opt = "--preview=";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fast") mode = ReplayMode::FAST;
+        else if (arg == "--headless") preview_spec = "off";
+        else if (arg.compare(0, preview_opt.size(), preview_opt) == 0) preview_spec = arg.substr(preview_opt.size());
+        else if (arg.compare(0, detector_opt.size(), detector_opt) == 0) detector_spec = arg.substr(detector_opt.size());
+        else if (arg.compare(0, gpio_opt.size(), gpio_opt) == 0) gpio_spec = arg.substr(gpio_opt.size());
+        else if (arg.compare(0, metrics_opt.size(), metrics_opt) == 0) metrics_spec = arg.substr(metrics_opt.size());
+        else if (arg.compare(0, pipeline_opt.size(), pipeline_opt) == 0) {
+            pipeline_path = arg.substr(pipeline_opt.size());
+            pipeline_given = true;
+        }
+        else spec = arg;
+    }
+    if (!createFaceDetector(detector_spec)) {
+        std::cerr << "无法识别的检测后端: " << detector_spec << "\n";
+        return -1;
+    }
+    if (!createGpioBackend(gpio_spec)) {
+        std::cerr << "无法识别的GPIO后端: " << gpio_spec << "\n";
+        return -1;
+    }
+    if (preview_spec != "off" && !createPreviewSink(preview_spec)) {
+        std::cerr << "无法识别的预览输出: " << preview_spec << "\n";
+        return -1;
+    }
+    // 默认配置文件不存在时使用内置默认值；显式指定的文件必须存在且有效
+    PipelineGraph graph = PipelineGraph::defaults();
+    struct stat st;
+    if (pipeline_given || stat(pipeline_path.c_str(), &st) == 0) {
+        std::string error;
+        if (!graph.load(pipeline_path, error)) {
+            std::cerr << "流水线配置无效: " << error << "\n";
+            return -1;
+        }
+    }
+
+    std::unique_ptr<FrameSource> source = createFrameSource(spec, mode);
+    if (!source) {
+        std::cerr << "无法识别的帧源: " << spec << "\n";
+        return -1;
+    }
+
     //完成GPIO初始化、LBPH模型加载、日志初始化
-    DoorCore door;
+    DoorCore door(std::move(source), detector_spec, gpio_spec, metrics_spec, graph, preview_spec);
     // 启动门禁系统核心逻辑：
     // is_running_为true，启动4个业务线程（采集/检测/识别/日志）
-    // 主线程进入阻塞循环（每秒检查is_running_状态），保持程序运行
+    // 主线程进入预览循环（无头模式下等待退出信号），保持程序运行
     door.startSystem();
     // is_running_为false时，startSystem()退出循环，执行到此处
     // 停止所有队列、等待线程结束、释放资源
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,272 @@
+/**
+ * @file metrics.cpp
+ * @brief 运行指标实现（对数-线性分桶直方图、Prometheus文本导出、本地HTTP端点、周期摘要）
+ */
+#include "metrics.h"
+#include "local_socket.h"
+#include <poll.h>         // poll
+#include <sys/eventfd.h>  // eventfd
+#include <sys/socket.h>   // accept/send
+#include <unistd.h>       // read/write/close/unlink
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+// ====================== 直方图 ======================
+
+int LatencyHistogram::bucketIndex(int64_t us) {
+    if (us < SUB_BUCKETS) return us < 0 ? 0 : static_cast<int>(us);
+    int magnitude = 63 - __builtin_clzll(static_cast<unsigned long long>(us));// floor(log2(us))
+    if (magnitude > MAX_MAGNITUDE) return BUCKETS - 1;
+    int sub = static_cast<int>((us >> (magnitude - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return (magnitude - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+int64_t LatencyHistogram::bucketUpper(int i) {
+    if (i < SUB_BUCKETS) return i + 1;
+    int magnitude = i / SUB_BUCKETS + SUB_BITS - 1;
+    int64_t width = int64_t(1) << (magnitude - SUB_BITS);
+    return (SUB_BUCKETS + i % SUB_BUCKETS) * width + width;
+}
+
+void LatencyHistogram::record(int64_t us) {
+    if (us < 0) us = 0;
+    counts_[bucketIndex(us)].fetch_add(1, memory_order_relaxed);
+    count_.fetch_add(1, memory_order_relaxed);
+    sum_.fetch_add(static_cast<uint64_t>(us), memory_order_relaxed);
+    int64_t prev = max_.load(memory_order_relaxed);
+    while (us > prev && !max_.compare_exchange_weak(prev, us, memory_order_relaxed)) {}
+}
+
+int64_t LatencyHistogram::percentile(double p) const {
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKETS; i++) total += bucketCount(i);
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total) + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += bucketCount(i);
+        if (seen >= rank) return min(bucketUpper(i), max(maxUs(), int64_t(1)));
+    }
+    return maxUs();
+}
+
+// ====================== 汇总 ======================
+
+const char* MetricsRegistry::stageName(Stage s) {
+    switch (s) {
+    case Stage::CAPTURE: return "capture";
+    case Stage::DETECT_WAIT: return "detect_wait";
+    case Stage::DETECT: return "detect";
+    case Stage::RECOGNIZE_WAIT: return "recognize_wait";
+    case Stage::RECOGNIZE: return "recognize";
+    case Stage::DECISION: return "decision";
+    case Stage::ACTUATE: return "actuate";
+    case Stage::DOOR: return "door";
+    case Stage::COUNT: break;
+    }
+    return "?";
+}
+
+void MetricsRegistry::addCounter(const string& name, const string& help, const string& labels, Reader read) {
+    lock_guard<mutex> lock(mtx_);
+    metrics_.push_back({name, help, labels, true, move(read)});
+}
+
+void MetricsRegistry::addGauge(const string& name, const string& help, const string& labels, Reader read) {
+    lock_guard<mutex> lock(mtx_);
+    metrics_.push_back({name, help, labels, false, move(read)});
+}
+
+void MetricsRegistry::clearReaders() {
+    lock_guard<mutex> lock(mtx_);
+    metrics_.clear();
+}
+
+void MetricsRegistry::registerThread(const string& name) {
+    ThreadCpu t;
+    t.name = name;
+    t.thread = pthread_self();
+    if (pthread_getcpuclockid(t.thread, &t.clock) != 0) return;
+    lock_guard<mutex> lock(mtx_);
+    threads_.push_back(t);
+}
+
+void MetricsRegistry::finishThread() {
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return;
+    pthread_t self = pthread_self();
+    lock_guard<mutex> lock(mtx_);
+    for (ThreadCpu& t : threads_) {
+        if (t.finished || !pthread_equal(t.thread, self)) continue;
+        t.last_sec = ts.tv_sec + ts.tv_nsec * 1e-9;
+        t.finished = true;
+    }
+}
+
+void MetricsRegistry::refreshThreads() {
+    for (ThreadCpu& t : threads_) {
+        if (t.finished) continue;// 已退出的线程保留最终值
+        timespec ts;
+        if (clock_gettime(t.clock, &ts) == 0) t.last_sec = ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+}
+
+//Prometheus数值格式（整数不带小数点）
+static string promValue(double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+string MetricsRegistry::renderPrometheus() {
+    string out;
+    // 1. 各阶段延迟直方图（同一指标族，stage标签区分）；只在2的幂（微秒）处输出累计桶，精度足够画分位数
+    out += "# HELP face_door_stage_seconds 流水线各阶段耗时\n# TYPE face_door_stage_seconds histogram\n";
+    for (int s = 0; s < static_cast<int>(Stage::COUNT); s++) {
+        const LatencyHistogram& h = stages_[s];
+        string stage = string("stage=\"") + stageName(static_cast<Stage>(s)) + "\"";
+        uint64_t cumulative = 0;
+        for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+            cumulative += h.bucketCount(i);
+            int64_t upper = LatencyHistogram::bucketUpper(i);
+            if (upper < 64 || (upper & (upper - 1)) != 0) continue;// 只输出64us起的2的幂边界
+            out += "face_door_stage_seconds_bucket{" + stage + ",le=\"" + promValue(upper * 1e-6) + "\"} " +
+                   to_string(cumulative) + "\n";
+            if (upper >= (int64_t(1) << 26)) break;// 约67秒以上并入+Inf
+        }
+        out += "face_door_stage_seconds_bucket{" + stage + ",le=\"+Inf\"} " + to_string(h.count()) + "\n";
+        out += "face_door_stage_seconds_sum{" + stage + "} " + promValue(h.sumUs() * 1e-6) + "\n";
+        out += "face_door_stage_seconds_count{" + stage + "} " + to_string(h.count()) + "\n";
+    }
+
+    lock_guard<mutex> lock(mtx_);
+    // 2. 回调指标（同名的只输出一次HELP/TYPE）
+    string last_name;
+    for (const Metric& m : metrics_) {
+        if (m.name != last_name) {
+            out += "# HELP " + m.name + " " + m.help + "\n# TYPE " + m.name + (m.counter ? " counter\n" : " gauge\n");
+            last_name = m.name;
+        }
+        out += m.name + (m.labels.empty() ? "" : "{" + m.labels + "}") + " " + promValue(m.read()) + "\n";
+    }
+    // 3. 各线程CPU时间
+    refreshThreads();
+    out += "# HELP face_door_thread_cpu_seconds 各线程累计CPU时间\n# TYPE face_door_thread_cpu_seconds counter\n";
+    for (const ThreadCpu& t : threads_) {
+        out += "face_door_thread_cpu_seconds{thread=\"" + t.name + "\"} " + promValue(t.last_sec) + "\n";
+    }
+    return out;
+}
+
+string MetricsRegistry::summary() {
+    char buf[96];
+    string out = "[指标]";
+    for (int s = 0; s < static_cast<int>(Stage::COUNT); s++) {
+        const LatencyHistogram& h = stages_[s];
+        if (h.count() == 0) continue;
+        snprintf(buf, sizeof(buf), " %s p50=%.1fms p99=%.1fms max=%.1fms |", stageName(static_cast<Stage>(s)),
+                 h.percentile(0.5) / 1000.0, h.percentile(0.99) / 1000.0, h.maxUs() / 1000.0);
+        out += buf;
+    }
+    lock_guard<mutex> lock(mtx_);
+    refreshThreads();
+    out += " CPU";
+    for (const ThreadCpu& t : threads_) {
+        snprintf(buf, sizeof(buf), " %s=%.1fs", t.name.c_str(), t.last_sec);
+        out += buf;
+    }
+    return out;
+}
+
+// ====================== 端点 ======================
+
+MetricsServer::MetricsServer(MetricsRegistry& registry, const string& spec, function<void(const string&)> summary_log)
+    : registry_(registry), spec_(spec), summary_log_(move(summary_log)) {}
+
+bool MetricsServer::start() {
+    if (running_) return true;
+    // 1. 按端点描述创建监听套接字
+    if (spec_ == "off") {
+        address_ = "off";
+    } else {
+        listen_fd_ = openLocalListener(spec_, unix_path_);
+        if (listen_fd_ < 0) return false;
+        address_ = spec_.rfind("tcp:", 0) == 0 ? "http://" + spec_.substr(4) + "/metrics" : spec_;
+    }
+    // 2. 唤醒描述符与线程
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_ = true;
+    thread_ = thread(&MetricsServer::run, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (running_.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t n = write(wake_fd_, &one, sizeof(one));// 唤醒poll
+        (void)n;
+        if (thread_.joinable()) thread_.join();
+    }
+    if (listen_fd_ >= 0) close(listen_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    listen_fd_ = wake_fd_ = -1;
+    if (!unix_path_.empty()) unlink(unix_path_.c_str());
+    unix_path_.clear();
+}
+
+void MetricsServer::run() {
+    const bool periodic = METRICS_LOG_INTERVAL_S > 0;// 不输出周期摘要时只在有连接或停止时唤醒
+    auto interval = chrono::seconds(METRICS_LOG_INTERVAL_S);
+    auto next_log = chrono::steady_clock::now() + interval;
+    while (running_) {
+        pollfd fds[2] = {{wake_fd_, POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+        int nfds = listen_fd_ >= 0 ? 2 : 1;
+        int timeout_ms = -1;
+        if (periodic) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(next_log - chrono::steady_clock::now());
+            timeout_ms = static_cast<int>(max<long long>(0, left.count()));
+        }
+        int ready = poll(fds, nfds, timeout_ms);
+        if (!running_) break;
+        if (ready > 0 && nfds == 2 && (fds[1].revents & POLLIN)) {
+            int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve(client);
+                close(client);
+            }
+        }
+        if (periodic && chrono::steady_clock::now() >= next_log) {
+            summary_log_(registry_.summary());
+            next_log += interval;
+        }
+    }
+}
+
+void MetricsServer::serve(int client) {
+    // 读请求头（最多等待METRICS_REQUEST_TIMEOUT_MS；内容不解析，任何路径都返回指标）
+    char buf[1024];
+    string request;
+    while (request.find("\r\n\r\n") == string::npos && request.find("\n\n") == string::npos &&
+           request.size() < 8192) {
+        pollfd pfd = {client, POLLIN, 0};
+        if (poll(&pfd, 1, METRICS_REQUEST_TIMEOUT_MS) <= 0) break;
+        ssize_t n = read(client, buf, sizeof(buf));
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+    string body = registry_.renderPrometheus();
+    string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                      "Content-Length: " + to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    const char* p = response.data();
+    size_t len = response.size();
+    while (len > 0) {
+        ssize_t n = send(client, p, len, MSG_NOSIGNAL);// 对方提前关闭时不触发SIGPIPE
+        if (n <= 0) break;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+}
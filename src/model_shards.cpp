@@ -0,0 +1,138 @@
+/**
+ * @file model_shards.cpp
+ * @brief 按身份分片的直方图存储实现（分片读写、合并为运行时画廊）
+ */
+#include "model_shards.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>       // rename/remove
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+using namespace cv;
+using namespace std;
+
+namespace {
+
+/**
+ * @brief 分片文件头（其后紧跟samples×hist_size个float）
+ */
+struct ShardHeader {
+    char magic[8];        // 文件标识 "LBPHSHRD"
+    uint32_t version;     // 格式版本
+    uint32_t header_size; // sizeof(ShardHeader)
+    int32_t radius, neighbors, grid_x, grid_y;// LBP参数
+    uint32_t uniform;     // 是否统一模式
+    int32_t label;        // 用户ID
+    uint32_t samples;     // 样本数
+    uint32_t hist_size;   // 直方图长度
+};
+
+constexpr char kShardMagic[8] = {'L', 'B', 'P', 'H', 'S', 'H', 'R', 'D'};
+constexpr uint32_t kShardVersion = 1;
+
+//分片的LBP参数是否与引擎一致
+bool sameParams(const ShardHeader& h, const LbphEngine& engine) {
+    return h.radius == engine.radius() && h.neighbors == engine.neighbors() && h.grid_x == engine.gridX() &&
+           h.grid_y == engine.gridY() && (h.uniform != 0) == engine.uniform() &&
+           h.hist_size == static_cast<uint32_t>(engine.histSize());
+}
+
+}// namespace
+
+string ShardStore::path(int label) const {
+    return dir_ + "/" + to_string(label) + ".shard";
+}
+
+bool ShardStore::write(int label, const LbphEngine& engine, const vector<int>& rows) const {
+    if (rows.empty()) return false;
+    error_code ec;
+    fs::create_directories(dir_, ec);
+    ShardHeader h{};
+    memcpy(h.magic, kShardMagic, sizeof(kShardMagic));
+    h.version = kShardVersion;
+    h.header_size = sizeof(ShardHeader);
+    h.radius = engine.radius();
+    h.neighbors = engine.neighbors();
+    h.grid_x = engine.gridX();
+    h.grid_y = engine.gridY();
+    h.uniform = engine.uniform() ? 1 : 0;
+    h.label = label;
+    h.samples = static_cast<uint32_t>(rows.size());
+    h.hist_size = static_cast<uint32_t>(engine.histSize());
+
+    // 画廊行按对齐宽度补齐，分片中只存有效长度
+    string final_path = path(label), tmp_path = final_path + ".tmp";
+    {
+        ofstream out(tmp_path, ios::binary | ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        for (int row : rows) {
+            out.write(reinterpret_cast<const char*>(engine.histogram(row)), h.hist_size * sizeof(float));
+        }
+        if (!out.flush()) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return rename(tmp_path.c_str(), final_path.c_str()) == 0;
+}
+
+bool ShardStore::remove(int label) const {
+    return std::remove(path(label).c_str()) == 0;
+}
+
+vector<int> ShardStore::labels() const {
+    vector<int> out;
+    error_code ec;
+    for (auto& entry : fs::directory_iterator(dir_, ec)) {
+        string stem = entry.path().stem().string();
+        if (entry.path().extension() != ".shard" || stem.empty() || stem.size() > 9) continue;
+        if (!all_of(stem.begin(), stem.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+        out.push_back(stoi(stem));
+    }
+    sort(out.begin(), out.end());
+    return out;
+}
+
+bool ShardStore::merge(LbphEngine& model, int& shards, int skip_label) const {
+    shards = 0;
+    vector<int> ids = labels();
+    if (ids.empty()) {
+        cerr << "分片目录中没有分片: " << dir_ << "\n";
+        return false;
+    }
+    ids.erase(std::remove(ids.begin(), ids.end(), skip_label), ids.end());
+    // 1. 逐个读取分片，直方图依次追加（紧密排列，行长即直方图长度）
+    size_t hist = static_cast<size_t>(model.histSize());
+    vector<float> hists;
+    vector<int> sample_labels;
+    for (int id : ids) {
+        ifstream in(path(id), ios::binary | ios::ate);
+        uint64_t file_size = in ? static_cast<uint64_t>(in.tellg()) : 0;
+        in.seekg(0);
+        ShardHeader h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || memcmp(h.magic, kShardMagic, sizeof(h.magic)) != 0 ||
+            h.version != kShardVersion || h.header_size != sizeof(ShardHeader) || h.label != id ||
+            file_size != sizeof(ShardHeader) + uint64_t(h.samples) * h.hist_size * sizeof(float)) {
+            cerr << "分片损坏: " << path(id) << "\n";
+            return false;
+        }
+        if (!sameParams(h, model)) {
+            cerr << "分片的LBP参数与模型不一致（参数修改后需全量重建）: " << path(id) << "\n";
+            return false;
+        }
+        size_t offset = hists.size();
+        hists.resize(offset + size_t(h.samples) * hist);
+        if (!in.read(reinterpret_cast<char*>(hists.data() + offset), size_t(h.samples) * hist * sizeof(float))) {
+            cerr << "分片读取失败: " << path(id) << "\n";
+            return false;
+        }
+        sample_labels.insert(sample_labels.end(), h.samples, id);
+        shards++;
+    }
+    // 2. 设为画廊（拷贝到对齐存储并重建索引）
+    return model.assign(hists.data(), hist, sample_labels.data(), static_cast<int>(sample_labels.size()));
+}
@@ -0,0 +1,146 @@
+/**
+ * @file model_watcher.cpp
+ * @brief 模型文件监视实现（inotify目录监视、SIGHUP、写入事件合并）
+ */
+#include "model_watcher.h"
+#include <poll.h>         // poll
+#include <signal.h>       // sigaction
+#include <sys/eventfd.h>  // eventfd
+#include <sys/inotify.h>  // inotify
+#include <unistd.h>       // read/write/close
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+
+atomic<int> g_sighup_fd{-1};          // SIGHUP处理函数唤醒的eventfd（无监视器时为-1）
+atomic<bool> g_sighup_pending{false}; // 收到SIGHUP尚未处理
+
+//SIGHUP处理函数：只做异步信号安全的操作（置标志、写eventfd）
+void onSighup(int) {
+    g_sighup_pending.store(true);
+    int fd = g_sighup_fd.load();
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(fd, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+//拆分路径为 目录 + 文件名（无目录部分时目录为"."）
+void splitPath(const string& path, string& dir, string& name) {
+    size_t slash = path.rfind('/');
+    if (slash == string::npos) {
+        dir = ".";
+        name = path;
+    } else {
+        dir = slash == 0 ? "/" : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+}  // namespace
+
+ModelWatcher::ModelWatcher(const vector<string>& paths, Callback on_change, int debounce_ms)
+    : paths_(paths), on_change_(move(on_change)), debounce_(debounce_ms) {}
+
+bool ModelWatcher::start() {
+    if (running_) return true;
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) return false;
+
+    // 1. 监视各模型文件所在目录（写入完成、rename替换）；inotify失败时只响应SIGHUP
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ >= 0) {
+        for (const string& path : paths_) {
+            string dir, name;
+            splitPath(path, dir, name);
+            int wd = inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd >= 0) watched_[wd].insert(name);// 同一目录重复添加时返回同一个wd
+        }
+        if (watched_.empty()) {
+            close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+    }
+
+    // 2. SIGHUP：写eventfd唤醒监视线程
+    g_sighup_fd.store(wake_fd_);
+    struct sigaction sa = {};
+    sa.sa_handler = onSighup;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGHUP, &sa, nullptr);
+
+    running_ = true;
+    thread_ = thread(&ModelWatcher::run, this);
+    return true;
+}
+
+void ModelWatcher::stop() {
+    if (!running_.exchange(false)) return;
+    uint64_t one = 1;
+    ssize_t n = write(wake_fd_, &one, sizeof(one));// 唤醒poll
+    (void)n;
+    if (thread_.joinable()) thread_.join();
+    // 恢复SIGHUP默认行为前先摘除eventfd，处理函数不会写已关闭的描述符
+    g_sighup_fd.store(-1);
+    signal(SIGHUP, SIG_DFL);
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    close(wake_fd_);
+    inotify_fd_ = wake_fd_ = -1;
+    watched_.clear();
+}
+
+void ModelWatcher::run() {
+    bool pending = false;                        // 有尚未回调的文件变更
+    chrono::steady_clock::time_point first_event;// 本轮第一次变更的时刻（热更新延迟的起点）
+    chrono::steady_clock::time_point deadline;   // 最后一次变更 + debounce_
+    alignas(inotify_event) char buf[4096];
+
+    while (running_) {
+        pollfd fds[2] = {{wake_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+        int nfds = inotify_fd_ >= 0 ? 2 : 1;
+        int timeout = -1;
+        if (pending) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            timeout = static_cast<int>(max<long long>(0, left.count()));
+        }
+        int ready = poll(fds, nfds, timeout);
+        if (!running_) break;
+
+        // 1. eventfd：SIGHUP立即回调（stop()已在上面处理）
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            uint64_t count;
+            ssize_t n = read(wake_fd_, &count, sizeof(count));
+            (void)n;
+            if (g_sighup_pending.exchange(false)) {
+                pending = false;
+                on_change_("SIGHUP", chrono::steady_clock::now());
+                continue;
+            }
+        }
+        // 2. inotify：只关心被监视的文件名，合并连续写入
+        if (ready > 0 && nfds == 2 && (fds[1].revents & POLLIN)) {
+            ssize_t len;
+            while ((len = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + len;) {
+                    const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                    p += sizeof(inotify_event) + ev->len;
+                    auto it = watched_.find(ev->wd);
+                    if (ev->len == 0 || it == watched_.end() || !it->second.count(ev->name)) continue;
+                    auto now = chrono::steady_clock::now();
+                    if (!pending) first_event = now;
+                    pending = true;
+                    deadline = now + debounce_;
+                }
+            }
+        }
+        // 3. 合并时间已到：回调
+        if (pending && chrono::steady_clock::now() >= deadline) {
+            pending = false;
+            on_change_("文件变更", first_event);
+        }
+    }
+}
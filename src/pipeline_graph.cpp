@@ -0,0 +1,235 @@
+/**
+ * @file pipeline_graph.cpp
+ * @brief 流水线阶段-边描述实现（默认拓扑、YAML配置读取与校验、线程绑核与优先级）
+ */
+#include "pipeline_graph.h"
+#include <opencv2/opencv.hpp>
+#include <pthread.h>        // pthread_setaffinity_np/pthread_setschedparam
+#include <sched.h>          // cpu_set_t
+#include <sys/resource.h>   // setpriority
+#include <sys/syscall.h>    // SYS_gettid
+#include <unistd.h>         // syscall/sysconf
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+PipelineGraph PipelineGraph::defaults() {
+    PipelineGraph g;
+    StageConfig s;
+    for (const char* name : {"capture", "detect", "recognize", "display", "log"}) {
+        s.name = name;
+        s.workers = (s.name == "detect") ? DETECT_WORKERS : 1;
+        g.stages.push_back(s);
+    }
+    EdgeConfig e;
+    e.name = "frames";// 广播通道：每个消费者独立游标，满时必然覆盖最旧帧
+    e.from = "capture";
+    e.to = "display,detect";
+    e.capacity = FRAME_CHANNEL_SIZE;
+    e.policy = QueueFullPolicy::OVERWRITE_OLDEST;
+    e.allowed = {QueueFullPolicy::OVERWRITE_OLDEST};
+    g.edges.push_back(e);
+    e.name = "faces";// 单生产者无锁环形缓冲：满时丢弃新批次、覆盖最旧批次，或让检测线程池等待识别线程
+    e.from = "detect";
+    e.to = "recognize";
+    e.capacity = FACE_QUEUE_SIZE;
+    e.policy = QueueFullPolicy::REJECT;
+    e.allowed = {QueueFullPolicy::REJECT, QueueFullPolicy::OVERWRITE_OLDEST, QueueFullPolicy::BLOCK};
+    g.edges.push_back(e);
+    e.name = "journal";// 识别线程永不等待磁盘
+    e.from = "recognize";
+    e.to = "journal";
+    e.capacity = JOURNAL_QUEUE_SIZE;
+    e.policy = QueueFullPolicy::REJECT;
+    e.allowed = {QueueFullPolicy::REJECT};
+    g.edges.push_back(e);
+    return g;
+}
+
+const char* policyName(QueueFullPolicy policy) {
+    switch (policy) {
+    case QueueFullPolicy::REJECT: return "reject";
+    case QueueFullPolicy::OVERWRITE_OLDEST: return "overwrite_oldest";
+    case QueueFullPolicy::BLOCK: return "block";
+    }
+    return "?";
+}
+
+//解析优先级描述，返回是否合法
+static bool parsePriority(const string& text, string& kind, int& value) {
+    if (text.empty()) return true;
+    size_t colon = text.find(':');
+    if (colon == string::npos) return false;
+    kind = text.substr(0, colon);
+    char* end = nullptr;
+    value = static_cast<int>(strtol(text.c_str() + colon + 1, &end, 10));
+    if (end == text.c_str() + colon + 1 || *end != '\0') return false;
+    if (kind == "nice") return value >= -20 && value <= 19;
+    if (kind == "fifo" || kind == "rr") return value >= 1 && value <= 99;
+    return false;
+}
+
+bool PipelineGraph::load(const string& path, string& error) {
+    FileStorage fs;
+    try {
+        if (!fs.open(path, FileStorage::READ)) {
+            error = "无法打开 " + path;
+            return false;
+        }
+    } catch (const cv::Exception& e) {// 语法错误时OpenCV抛出异常
+        error = path + " 格式错误: " + e.what();
+        return false;
+    }
+    PipelineGraph next = *this;
+    long cores = sysconf(_SC_NPROCESSORS_CONF);
+
+    // 1. 阶段
+    FileNode stages_node = fs["stages"];
+    if (!stages_node.empty()) {
+        for (const FileNode& node : stages_node) {
+            string name = node.name();
+            auto it = find_if(next.stages.begin(), next.stages.end(), [&](const StageConfig& s) { return s.name == name; });
+            if (it == next.stages.end()) {
+                error = "未知的阶段: " + name;
+                return false;
+            }
+            for (const FileNode& field : node) {
+                string key = field.name();
+                if (key == "workers") {
+                    it->workers = static_cast<int>(field);
+                    if (it->workers < 1 || (name != "detect" && it->workers != 1) || it->workers > MAX_DETECT_WORKERS) {
+                        error = "阶段 " + name + " 的workers无效（只有detect可大于1，上限" + to_string(MAX_DETECT_WORKERS) + "）";
+                        return false;
+                    }
+                } else if (key == "cpus") {
+                    it->cpus.clear();
+                    for (const FileNode& cpu : field) {
+                        int c = static_cast<int>(cpu);
+                        if (c < 0 || c >= cores || c >= CPU_SETSIZE) {
+                            error = "阶段 " + name + " 的CPU编号超出范围: " + to_string(c);
+                            return false;
+                        }
+                        it->cpus.push_back(c);
+                    }
+                } else if (key == "priority") {
+                    it->priority = static_cast<string>(field);
+                    string kind;
+                    int value = 0;
+                    if (!parsePriority(it->priority, kind, value)) {
+                        error = "阶段 " + name + " 的priority无效: " + it->priority + "（nice:<-20~19> | fifo:<1~99> | rr:<1~99>）";
+                        return false;
+                    }
+                } else {
+                    error = "阶段 " + name + " 的未知字段: " + key;
+                    return false;
+                }
+            }
+        }
+    }
+
+    // 2. 边
+    FileNode edges_node = fs["edges"];
+    if (!edges_node.empty()) {
+        for (const FileNode& node : edges_node) {
+            string name = node.name();
+            auto it = find_if(next.edges.begin(), next.edges.end(), [&](const EdgeConfig& e) { return e.name == name; });
+            if (it == next.edges.end()) {
+                error = "未知的边: " + name;
+                return false;
+            }
+            for (const FileNode& field : node) {
+                string key = field.name();
+                if (key == "capacity") {
+                    it->capacity = static_cast<int>(field);
+                    if (it->capacity < 1 || it->capacity > 4096) {
+                        error = "边 " + name + " 的capacity无效（1~4096）";
+                        return false;
+                    }
+                } else if (key == "policy") {
+                    string value = static_cast<string>(field);
+                    bool ok = false;
+                    for (QueueFullPolicy p : it->allowed) {
+                        if (value == policyName(p)) {
+                            it->policy = p;
+                            ok = true;
+                        }
+                    }
+                    if (!ok) {
+                        string allowed;
+                        for (QueueFullPolicy p : it->allowed) allowed += string(allowed.empty() ? "" : " | ") + policyName(p);
+                        error = "边 " + name + " 不支持策略 " + value + "（可选：" + allowed + "）";
+                        return false;
+                    }
+                } else {
+                    error = "边 " + name + " 的未知字段: " + key;
+                    return false;
+                }
+            }
+        }
+    }
+    *this = move(next);
+    return true;
+}
+
+const StageConfig& PipelineGraph::stage(const string& name) const {
+    for (const StageConfig& s : stages) {
+        if (s.name == name) return s;
+    }
+    return stages.front();// 名称由代码给出，不会走到这里
+}
+
+const EdgeConfig& PipelineGraph::edge(const string& name) const {
+    for (const EdgeConfig& e : edges) {
+        if (e.name == name) return e;
+    }
+    return edges.front();
+}
+
+string PipelineGraph::describe() const {
+    string out = "[流水线]";
+    for (const StageConfig& s : stages) {
+        out += " " + s.name + "×" + to_string(s.workers);
+        if (!s.cpus.empty()) {
+            out += "@cpu";
+            for (size_t i = 0; i < s.cpus.size(); i++) out += (i ? "," : "") + to_string(s.cpus[i]);
+        }
+        if (!s.priority.empty()) out += "(" + s.priority + ")";
+    }
+    out += " |";
+    for (const EdgeConfig& e : edges) {
+        out += " " + e.from + "→" + e.to + "[" + e.name + " " + to_string(e.capacity) + " " + policyName(e.policy) + "]";
+    }
+    return out;
+}
+
+string applyThreadPolicy(const StageConfig& stage) {
+    string problems;
+    // 1. CPU亲和性
+    if (!stage.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : stage.cpus) CPU_SET(c, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) problems += string(" 绑核失败(") + strerror(rc) + ")";
+    }
+    // 2. 优先级：nice为每个线程独立的值（Linux按线程ID设置）；fifo/rr为实时调度
+    string kind;
+    int value = 0;
+    if (!stage.priority.empty() && parsePriority(stage.priority, kind, value)) {
+        if (kind == "nice") {
+            pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+            if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), value) != 0) {
+                problems += " nice:" + to_string(value) + "失败(" + strerror(errno) + ")";
+            }
+        } else {
+            sched_param param = {};
+            param.sched_priority = value;
+            int rc = pthread_setschedparam(pthread_self(), kind == "fifo" ? SCHED_FIFO : SCHED_RR, &param);
+            if (rc != 0) problems += " " + stage.priority + "失败(" + strerror(rc) + ")";
+        }
+    }
+    return problems;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file preview_sink.cpp
+ * @brief 预览输出实现（OpenCV窗口、MJPEG录像文件、本机套接字MJPEG流）
+ */
+#include "preview_sink.h"
+#include "local_socket.h"
+#include <fcntl.h>        // fcntl（监听套接字非阻塞）
+#include <poll.h>         // poll
+#include <sys/socket.h>   // accept4/send
+#include <unistd.h>       // close/unlink
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>        // setenv
+#include <thread>
+
+using namespace cv;
+using namespace std;
+
+bool PreviewSink::poll(int wait_ms) {
+    if (wait_ms > 0) this_thread::sleep_for(chrono::milliseconds(wait_ms));
+    return false;
+}
+
+// ====================== 窗口 ======================
+
+WindowPreviewSink::~WindowPreviewSink() {
+    if (opened_) destroyAllWindows();
+}
+
+bool WindowPreviewSink::open() {
+    // 未指定显示设备时使用本机X11显示（树莓派屏幕）
+    setenv("DISPLAY", ":0", 0);
+    try {
+        namedWindow("人脸识别门禁系统", WINDOW_NORMAL);
+        resizeWindow("人脸识别门禁系统", 640, 480);
+    } catch (const cv::Exception&) {// 没有图形界面时OpenCV抛出异常
+        return false;
+    }
+    opened_ = true;
+    return true;
+}
+
+bool WindowPreviewSink::write(const Mat& frame) {
+    imshow("人脸识别门禁系统", frame);
+    return true;
+}
+
+bool WindowPreviewSink::poll(int wait_ms) {
+    return waitKey(max(1, wait_ms)) == 27;// ESC
+}
+
+// ====================== MJPEG录像文件 ======================
+
+bool MjpegFilePreviewSink::open() {
+    return !path_.empty();// 画面尺寸要等第一帧才知道，文件在第一次写入时创建
+}
+
+bool MjpegFilePreviewSink::write(const Mat& frame) {
+    if (!writer_.isOpened() &&
+        !writer_.open(path_, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), PREVIEW_FPS, frame.size())) {
+        return false;
+    }
+    writer_.write(frame);
+    return true;
+}
+
+// ====================== 套接字MJPEG流 ======================
+
+StreamPreviewSink::~StreamPreviewSink() {
+    for (Client& c : clients_) close(c.fd);
+    if (listen_fd_ >= 0) close(listen_fd_);
+    if (!unix_path_.empty()) unlink(unix_path_.c_str());
+}
+
+bool StreamPreviewSink::open() {
+    listen_fd_ = openLocalListener(spec_, unix_path_);
+    if (listen_fd_ < 0) return false;
+    fcntl(listen_fd_, F_SETFL, fcntl(listen_fd_, F_GETFL) | O_NONBLOCK);// acceptClients()取完等待中的连接即返回
+    return true;
+}
+
+void StreamPreviewSink::acceptClients() {
+    for (;;) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (static_cast<int>(clients_.size()) >= PREVIEW_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+        // 请求内容不解析，任何路径都返回预览流
+        Client c{fd, "HTTP/1.0 200 OK\r\nContent-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                     "Cache-Control: no-cache\r\nConnection: close\r\n\r\n" + last_part_};
+        if (flush(c)) clients_.push_back(move(c));
+        else close(fd);
+    }
+}
+
+bool StreamPreviewSink::flush(Client& client) {
+    while (client.sent < client.pending.size()) {
+        ssize_t n = send(client.fd, client.pending.data() + client.sent, client.pending.size() - client.sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);// 对方关闭时不触发SIGPIPE
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;// 发送缓冲已满，下次再发
+        if (n <= 0) return false;
+        client.sent += static_cast<size_t>(n);
+    }
+    client.pending.clear();
+    client.sent = 0;
+    return true;
+}
+
+void StreamPreviewSink::broadcast(const string& part) {
+    for (size_t i = 0; i < clients_.size();) {
+        Client& c = clients_[i];
+        bool ok = flush(c);
+        if (ok && c.pending.empty()) {// 上一帧已发完才发新帧，来不及接收的观看者跳帧
+            c.pending = part;
+            ok = flush(c);
+        }
+        if (ok) {
+            i++;
+        } else {
+            close(c.fd);
+            clients_.erase(clients_.begin() + static_cast<long>(i));
+        }
+    }
+}
+
+bool StreamPreviewSink::write(const Mat& frame) {
+    acceptClients();
+    if (clients_.empty()) {
+        last_part_.clear();// 没有观看者时不编码；新观看者等下一帧
+        return true;
+    }
+    if (!imencode(".jpg", frame, jpeg_, {IMWRITE_JPEG_QUALITY, PREVIEW_JPEG_QUALITY})) return false;
+    last_part_ = "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " + to_string(jpeg_.size()) + "\r\n\r\n";
+    last_part_.append(reinterpret_cast<const char*>(jpeg_.data()), jpeg_.size());
+    last_part_ += "\r\n";
+    broadcast(last_part_);
+    return true;
+}
+
+bool StreamPreviewSink::poll(int wait_ms) {
+    // 等待新连接或观看者可写（继续发送未发完的帧），最多wait_ms
+    vector<pollfd> fds;
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const Client& c : clients_) {
+        if (!c.pending.empty()) fds.push_back({c.fd, POLLOUT, 0});
+    }
+    if (::poll(fds.data(), fds.size(), max(0, wait_ms)) > 0) {
+        if (fds[0].revents & POLLIN) acceptClients();
+        broadcast(string());// 只续发未发完的数据（空分段不会被排入）
+    }
+    return false;
+}
+
+unique_ptr<PreviewSink> createPreviewSink(const string& spec) {
+    if (spec == "window") return make_unique<WindowPreviewSink>();
+    if (spec.rfind("mjpeg:", 0) == 0) return make_unique<MjpegFilePreviewSink>(spec.substr(6));
+    if (spec.rfind("tcp:", 0) == 0 || spec.rfind("unix:", 0) == 0) return make_unique<StreamPreviewSink>(spec);
+    return nullptr;
+}